@@ -734,6 +734,11 @@ class PEBinary : public PExpr {
                                      unsigned flags) const;
       virtual verinum* eval_const(Design*des, NetScope*sc) const;
 
+    public:
+      inline char get_op() const { return op_; }
+      inline PExpr*get_left() const { return left_; }
+      inline PExpr*get_right() const { return right_; }
+
     protected:
       char op_;
       PExpr*left_;
@@ -908,6 +913,11 @@ class PECallFunction : public PExpr {
       virtual unsigned test_width(Design*des, NetScope*scope,
 				  width_mode_t&mode);
 
+    public:
+      inline PPackage*package() const { return package_; }
+      inline const pform_name_t&path() const { return path_; }
+      inline const std::vector<PExpr*>&parms() const { return parms_; }
+
     private:
       PPackage*package_;
       pform_name_t path_;
@@ -34,6 +34,7 @@ class ostream;
 class PExpr;
 class Design;
 class netdarray_t;
+class netvector_t;
 
 /*
  * The different type of PWire::set_range() calls.
@@ -124,6 +125,20 @@ class PWire : public LineInfo {
 
       ivl_discipline_t discipline_;
 
+	// The packed dimensions that elaborate_sig evaluated for
+	// module instances, by the parameter signature of the
+	// instances, and the vector type made for them. Instances
+	// with the same parameter values share these.
+      struct elab_ranges_t {
+	    elab_ranges_t() : is_implicit_scalar(false), vec(0) { }
+	    std::vector<netrange_t> dims;
+	    bool is_implicit_scalar;
+	    netvector_t*vec;
+      };
+      mutable std::map<const std::string*,elab_ranges_t> elab_ranges_;
+
+      bool ranges_are_local_() const;
+
     private: // not implemented
       PWire(const PWire&);
       PWire& operator= (const PWire&);
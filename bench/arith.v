@@ -0,0 +1,55 @@
+/*
+ * Microbenchmark for the vector arithmetic of the vthread interpreter.
+ *
+ * Each width has a thread that runs a loop of add, subtract, multiply,
+ * divide and compare instructions on vectors of that width, LOOPS
+ * times. The widths are 8, 32, 64, 128 and 1024 bits. The divisor is
+ * kept close to the dividend, since a wide divide with a large
+ * quotient would take all the time. Time one width alone by defining
+ * WIDTH:
+ *
+ *    bench/run.sh bench/arith.v
+ *    bench/run.sh -DWIDTH=1024 bench/arith.v
+ *    bench/run.sh -DWIDTH=8 -DLOOPS=400000 bench/arith.v
+ *
+ * The checksums printed at the end must not change between builds.
+ */
+`ifndef LOOPS
+`define LOOPS 100000
+`endif
+
+module arith #(parameter WID = 32) ();
+      reg [WID-1:0] a, b, c, d, sum;
+      reg [31:0]    fold;
+      integer i;
+
+      initial begin
+	 a = 1;
+	 b = 3;
+	 sum = 0;
+	 for (i = 0 ; i < `LOOPS ; i = i + 1) begin
+	    c = a * b + i;
+	    d = c / ((c >> 4) | 1);
+	    a = c - d;
+	    if (a < b)
+	       b = b + c;
+	    else
+	       b = b - d;
+	    sum = sum + (a ^ b);
+	 end
+	 fold = sum;
+	 $display("arith: width=%0d loops=%0d sum=%h", WID, `LOOPS, fold);
+      end
+endmodule
+
+module main;
+`ifdef WIDTH
+      arith #(`WIDTH) w ();
+`else
+      arith #(8)    w8 ();
+      arith #(32)   w32 ();
+      arith #(64)   w64 ();
+      arith #(128)  w128 ();
+      arith #(1024) w1024 ();
+`endif
+endmodule
@@ -0,0 +1,51 @@
+/*
+ * Benchmark for forking many short threads.
+ *
+ * The testbench runs FORKS fork/join blocks of two children, and each
+ * child does a little vector arithmetic of WIDTH bits and ends, so
+ * nearly all the run time is making, starting and reaping the child
+ * threads. (A fork of a single statement is run in the parent, so
+ * every fork here has two.) Before the loop, the children work on
+ * vectors of WIDE bits, to check that a few wide threads do not make
+ * the narrow forks after them slower.
+ *
+ *    bench/run.sh bench/fork.v
+ *    bench/run.sh -DWIDTH=200 bench/fork.v
+ *    bench/run.sh -DWIDE=65536 bench/fork.v
+ *
+ * The checksum printed at the end must not change between builds.
+ */
+`ifndef FORKS
+`define FORKS 1000000
+`endif
+`ifndef WIDTH
+`define WIDTH 32
+`endif
+`ifndef WIDE
+`define WIDE 8192
+`endif
+
+module main;
+      reg [`WIDTH-1:0] a = 1, b = 0, sum = 0;
+      reg [`WIDE-1:0]  big = 1;
+      integer i;
+
+      initial begin
+	 fork
+	    big = (big << (`WIDE/2)) + big * 3;
+	    b = a + 1;
+	 join
+
+	 for (i = 0 ; i < `FORKS ; i = i + 1) begin
+	    fork
+	       b = a * 5 + i;
+	       sum = sum ^ (a + (a >> 1));
+	    join
+	    a = a + 1;
+	 end
+
+	 $display("fork: forks=%0d width=%0d sum=%h big=%h", `FORKS, `WIDTH,
+		  sum, {big[`WIDE/2 +: 4], big[3:0]});
+	 $finish;
+      end
+endmodule
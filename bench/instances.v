@@ -0,0 +1,50 @@
+/*
+ * Elaboration benchmark with many instances of a parameterized module.
+ *
+ * There are INSTANCES instances of a small module, with only a few
+ * different parameter sets, and the ranges of its wires are computed
+ * from the parameters with $clog2 and arithmetic. All the instances
+ * take the same input through continuous assignments. This is meant
+ * to time the compiler, so compile it with:
+ *
+ *    bench/run.sh bench/instances.v
+ *    bench/run.sh -DINSTANCES=20000 -pPASS_REPORT=inst.json bench/instances.v
+ *
+ * and compare the compile times, or the elaborate phase of the pass
+ * report. The checksum printed by the simulation must not change
+ * between builds. (The instances have no clocked processes, since the
+ * events of a clock shared by every instance take quadratic time in
+ * the nodangle functor, which would hide the elaboration time.)
+ */
+`ifndef INSTANCES
+`define INSTANCES 100000
+`endif
+
+module stage #(parameter DEPTH = 16, parameter STEP = 1)
+      (input wire [7:0] in, output wire [7:0] out);
+      localparam WID = $clog2(DEPTH);
+      wire [WID-1:0]   low = in[WID-1:0];
+      wire [WID:0]     next = low + STEP;
+      wire [2*WID-1:0] wide = {low, next[WID-1:0]};
+
+      assign out = {in[7:WID] ^ wide[2*WID-1:WID], wide[WID-1:0]};
+endmodule
+
+module main;
+      reg  [7:0] seed = 8'h5a;
+
+      genvar k;
+      for (k = 0 ; k < `INSTANCES ; k = k + 1) begin : inst
+	 wire [7:0] out;
+	 stage #(.DEPTH(4 << (k%4)), .STEP(1 + k%3)) u (seed, out);
+      end
+
+      initial begin
+	 #1 $display("instances: n=%0d out=%h %h %h", `INSTANCES,
+		     inst[0].out, inst[`INSTANCES/2+1].out, inst[`INSTANCES-1].out);
+	 seed = 8'hc3;
+	 #1 $display("instances: n=%0d out=%h %h %h", `INSTANCES,
+		     inst[0].out, inst[`INSTANCES/2+1].out, inst[`INSTANCES-1].out);
+	 $finish;
+      end
+endmodule
@@ -0,0 +1,44 @@
+/*
+ * Memory benchmark for a large net array.
+ *
+ * This is an array of WORDS nets of WIDTH bits, each driven by its own
+ * continuous assignment, and read back by variable index. The run time
+ * is small, and the number of interest is the memory that vvp -v
+ * reports at the end of the compile:
+ *
+ *    bench/run.sh bench/netarray.v -v
+ *    bench/run.sh -DWIDTH=128 bench/netarray.v -v
+ *
+ * The checksum printed at the end must not change between builds.
+ */
+`ifndef WORDS
+`define WORDS 100000
+`endif
+`ifndef WIDTH
+`define WIDTH 32
+`endif
+
+module main;
+      wire [`WIDTH-1:0] mem [0:`WORDS-1];
+      reg  [`WIDTH-1:0] base = 1;
+      reg  [`WIDTH-1:0] sum;
+      integer i;
+
+      genvar k;
+      for (k = 0 ; k < `WORDS ; k = k + 1) begin : drv
+	 assign mem[k] = base * (k + 1);
+      end
+
+      initial begin
+	 #1 sum = 0;
+	 for (i = 0 ; i < `WORDS ; i = i + 1)
+	    sum = sum ^ mem[i];
+	 $display("netarray: words=%0d width=%0d sum=%h", `WORDS, `WIDTH, sum);
+	 base = 3;
+	 #1 sum = 0;
+	 for (i = 0 ; i < `WORDS ; i = i + 1)
+	    sum = sum ^ mem[i];
+	 $display("netarray: words=%0d width=%0d sum=%h", `WORDS, `WIDTH, sum);
+	 $finish;
+      end
+endmodule
@@ -0,0 +1,48 @@
+/*
+ * Procedural benchmark for the vthread interpreter.
+ *
+ * A single thread fills an array from a linear congruential generator,
+ * bubble sorts it and folds it into a checksum, PASSES times over. The
+ * inner loops are the load/compare/branch, load/add/store and indexed
+ * array load sequences that tgt-vvp emits for ordinary behavioral code,
+ * so nearly all the run time is instruction dispatch and the vector
+ * opcodes, with no nets and almost no scheduler work.
+ *
+ *    bench/run.sh bench/proc.v
+ *    bench/run.sh -DPASSES=8 bench/proc.v
+ *
+ * The checksum printed at the end must not change between builds.
+ */
+`ifndef PASSES
+`define PASSES 4
+`endif
+
+module main;
+      reg [31:0] mem [0:1023];
+      reg [31:0] tmp, seed, sum;
+      integer i, j, pass;
+
+      initial begin
+	 sum = 0;
+	 seed = 1;
+	 for (pass = 0 ; pass < `PASSES ; pass = pass + 1) begin
+	    for (i = 0 ; i < 1024 ; i = i + 1) begin
+	       seed = seed * 1103515245 + 12345;
+	       mem[i] = seed;
+	    end
+
+	    for (i = 0 ; i < 1023 ; i = i + 1)
+	      for (j = 0 ; j < 1023 - i ; j = j + 1)
+		if (mem[j] > mem[j+1]) begin
+		   tmp = mem[j];
+		   mem[j] = mem[j+1];
+		   mem[j+1] = tmp;
+		end
+
+	    for (i = 0 ; i < 1024 ; i = i + 1)
+	      sum = sum + (mem[i] ^ i);
+	 end
+	 $display("proc: passes=%0d sum=%h", `PASSES, sum);
+      end
+
+endmodule
@@ -0,0 +1,75 @@
+/*
+ * Many independent clock domains, for the parallel region scheduler.
+ *
+ * Each domain is a 32-bit register that is clocked through a cone of
+ * gates computed from its own outputs and a counter. The domains share
+ * no nets, so vvp partitions them into separate regions, and their
+ * gate events within a time step can be run in parallel:
+ *
+ *    bench/run.sh bench/regions.v
+ *    bench/run.sh bench/regions.v -j 4
+ *    bench/run.sh -DDOMAINS=256 -DCYCLES=500 bench/regions.v -v -j 4
+ *
+ * Under -v, vvp reports how many regions it found and how many of
+ * them must be run serially. The checksum printed at the end must be
+ * the same for every thread count. With -DDUMP the first domain is
+ * also dumped to regions.vcd, which must not depend on the thread
+ * count either. (Dumping makes the region of that domain serial.)
+ */
+`ifndef DOMAINS
+`define DOMAINS 64
+`endif
+`ifndef CYCLES
+`define CYCLES 2000
+`endif
+
+module domain #(parameter SEED = 1) (input wire clk);
+      reg  [31:0] q = SEED;
+      reg  [31:0] cnt = 0;
+      wire [31:0] t1, t2, t3, t4, d;
+
+      genvar i;
+      for (i = 0 ; i < 32 ; i = i + 1) begin : cone
+	 xor  g1 (t1[i], q[i], q[(i+7)%32]);
+	 and  g2 (t2[i], q[(i+3)%32], cnt[i%8]);
+	 or   g3 (t3[i], q[(i+11)%32], t2[i]);
+	 nand g4 (t4[i], t1[i], t3[i]);
+	 xor  g5 (d[i], t4[i], q[(i+19)%32], cnt[(i+5)%8]);
+      end
+
+      always @(posedge clk) begin
+	 q <= d;
+	 cnt <= cnt + 1;
+      end
+
+	// Fold the final state into the checksum of the testbench.
+      initial begin
+	 #(`CYCLES*10 + 1);
+	 main.sum = main.sum ^ q;
+      end
+endmodule
+
+module main;
+      reg [31:0] sum = 0;
+
+      genvar k;
+      for (k = 0 ; k < `DOMAINS ; k = k + 1) begin : dom
+	 reg clk = 0;
+	 always #5 clk = ~clk;
+	 domain #(.SEED(k*2654435761 + 1)) u (clk);
+      end
+
+`ifdef DUMP
+      initial begin
+	 $dumpfile("regions.vcd");
+	 $dumpvars(0, dom[0]);
+      end
+`endif
+
+      initial begin
+	 #(`CYCLES*10 + 2);
+	 $display("regions: domains=%0d cycles=%0d sum=%h",
+		  `DOMAINS, `CYCLES, sum);
+	 $finish;
+      end
+endmodule
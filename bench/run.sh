@@ -0,0 +1,56 @@
+#!/bin/bash
+#
+# Compile and run one of the benchmarks in this directory, and report
+# the time taken by each step. Arguments that start with -D, -I, -g, -p
+# or -W are passed to iverilog, the first other argument is the source
+# file, and anything after that is passed to vvp. For example:
+#
+#    bench/run.sh -DPASSES=8 bench/proc.v
+#    bench/run.sh -pfuse=0 bench/proc.v
+#    bench/run.sh bench/regions.v -w
+#
+# The IVERILOG and VVP environment variables select the programs to
+# run, with any options of their own, so two builds can be timed
+# against each other:
+#
+#    VVP=/path/to/old/vvp bench/run.sh bench/proc.v
+#    VVP=/path/to/new/vvp bench/run.sh bench/proc.v
+#
+# Set REPEAT to run the simulation more than once. The output of the
+# design is shown so the checksums can be compared.
+#
+# NOTE: DO NOT INSTALL THIS FILE.
+
+IVERILOG=${IVERILOG:-iverilog}
+VVP=${VVP:-vvp}
+REPEAT=${REPEAT:-1}
+
+ivflags=()
+while [ $# -gt 0 ]; do
+    case "$1" in
+      -D*|-I*|-g*|-p*|-W*) ivflags+=("$1"); shift ;;
+      *) break ;;
+    esac
+done
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 [iverilog flags] file.v [vvp flags]" >&2
+    exit 1
+fi
+
+src=$1
+shift
+out=${TMPDIR:-/tmp}/bench.$$.vvp
+trap 'rm -f "$out"' EXIT
+
+TIMEFORMAT="%R real %U user %S sys"
+
+echo "*** compile $src ${ivflags[*]}"
+time $IVERILOG "${ivflags[@]}" -o "$out" "$src" || exit 1
+
+n=0
+while [ $n -lt $REPEAT ]; do
+    echo "*** run $VVP $*"
+    time $VVP "$@" "$out" || exit 1
+    n=$((n+1))
+done
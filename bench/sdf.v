@@ -0,0 +1,78 @@
+/*
+ * SDF annotation benchmark for a large gate level netlist.
+ *
+ * The netlist is an array of CELLS instances of a cell with three
+ * module paths. The testbench first writes an SDF file with an
+ * IOPATH entry for every cell to sdf_bench.sdf, then annotates it.
+ * Every tenth cell is also listed with a TIMINGCHECK and no IOPATH,
+ * and one cell has a module path with a part select. Run it with:
+ *
+ *    bench/run.sh -gspecify bench/sdf.v
+ *    bench/run.sh -gspecify -DCELLS=20000 bench/sdf.v
+ *
+ * Nearly all the run time is the annotation. The output times, which
+ * show the annotated delays of a few cells, must not change between
+ * builds.
+ */
+`ifndef CELLS
+`define CELLS 100000
+`endif
+
+`timescale 1ns/1ps
+
+module bcell (input wire a, input wire b, output wire y, output wire z);
+      and g1 (y, a, b);
+      xor g2 (z, a, b);
+      specify
+	 (a => y) = (1, 1);
+	 (b => y) = (1, 1);
+	 (a => z) = (1, 1);
+      endspecify
+endmodule
+
+module pcell (input wire [1:0] a, output wire [1:0] y);
+      buf g1 [1:0] (y, a);
+      specify
+	 (a[0] => y[0]) = (1, 1);
+      endspecify
+endmodule
+
+module main;
+      reg  a = 0, b = 0;
+      wire [1:0] py;
+      integer fd, i;
+
+	// The outputs are not connected to one wide vector, since each
+	// change of a bit would then propagate the whole vector.
+      bcell c [`CELLS-1:0] (.a(a), .b(b), .y(), .z());
+      pcell p (.a({a,b}), .y(py));
+
+      initial begin
+	 fd = $fopen("sdf_bench.sdf", "w");
+	 $fdisplay(fd, "(DELAYFILE (SDFVERSION \"3.0\") (DESIGN \"main\")");
+	 $fdisplay(fd, "  (TIMESCALE 1ns)");
+	 for (i = 0 ; i < `CELLS ; i = i + 1) begin
+	    $fdisplay(fd, "  (CELL (CELLTYPE \"bcell\") (INSTANCE c\\[%0d\\])", i);
+	    $fdisplay(fd, "    (DELAY (ABSOLUTE (IOPATH a y (%0d) (%0d)) (IOPATH b y (2) (2)) (IOPATH a z (3) (3)))))",
+		      1 + i%7, 2 + i%7);
+	    if (i % 10 == 0)
+	       $fdisplay(fd, "  (CELL (CELLTYPE \"bcell\") (INSTANCE c\\[%0d\\]) (TIMINGCHECK (WIDTH a (1))))", i);
+	 end
+	 $fdisplay(fd, "  (CELL (CELLTYPE \"pcell\") (INSTANCE p) (DELAY (ABSOLUTE (IOPATH a y (4) (4)))))");
+	 $fdisplay(fd, ")");
+	 $fclose(fd);
+
+	 $sdf_annotate("sdf_bench.sdf", main);
+
+	 #100 a = 1; b = 1;
+	 #100 $display("sdf: cells=%0d z=%b%b%b", `CELLS, c[0].z,
+		       c[`CELLS/2].z, c[`CELLS-1].z);
+	 $finish;
+      end
+
+	// Sample the delay of a few cells, as the time from the change
+	// of the inputs to the change of the outputs.
+      always @(c[0].y or c[`CELLS/2].y or c[`CELLS-1].y)
+	 $display("%t c[0].y=%b c[%0d].y=%b c[%0d].y=%b", $realtime, c[0].y,
+		  `CELLS/2, c[`CELLS/2].y, `CELLS-1, c[`CELLS-1].y);
+endmodule
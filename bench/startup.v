@@ -0,0 +1,50 @@
+/*
+ * Start up benchmark, for the load time of a large design.
+ *
+ * The design is CELLS instances of a small module of gates, registers
+ * and continuous assignments, and the simulation stops at once, so
+ * nearly all the vvp time is the scanning, parsing and compiling of
+ * the design. Time the text against a design image of it with:
+ *
+ *    iverilog -o startup.vvp bench/startup.v
+ *    vvp -c startup.img startup.vvp
+ *    time vvp startup.vvp
+ *    time vvp startup.img
+ *
+ * Use -DCELLS=n to change the size. The image only replaces the
+ * scanner, so the difference between the two times is the scanning
+ * time; the parse and compile take the same time for both.
+ */
+`ifndef CELLS
+`define CELLS 20000
+`endif
+
+module unit #(parameter SEED = 1) (input wire clk, input wire [7:0] in,
+				   output wire [7:0] out);
+      reg  [7:0] q = SEED;
+      wire [7:0] t1, t2;
+
+      xor  g1 [7:0] (t1, q, in);
+      nand g2 [7:0] (t2, t1, {q[3:0], q[7:4]});
+      assign out = t2 + q;
+
+      always @(posedge clk)
+	 q <= out ^ in;
+endmodule
+
+module main;
+      reg clk = 0;
+      wire [7:0] link [0:`CELLS];
+
+      assign link[0] = 8'h5a;
+
+      genvar k;
+      for (k = 0 ; k < `CELLS ; k = k + 1) begin : c
+	 unit #(.SEED(k)) u (clk, link[k], link[k+1]);
+      end
+
+      initial begin
+	 #1 $display("startup: cells=%0d out=%h", `CELLS, link[`CELLS]);
+	 $finish;
+      end
+endmodule
@@ -0,0 +1,55 @@
+/*
+ * Benchmark for vector gates and compares on 2-state values.
+ *
+ * The netlist is STAGES stages of continuous assignments, each an AND
+ * and an OR of WIDTH bit vectors, and a testbench that drives new 0/1
+ * values into the first stage CYCLES times and compares the result
+ * with === each time. No value ever has an X or Z bit after the
+ * start, so this times the vector gate functors and the propagation
+ * of fully known vectors.
+ *
+ *    bench/run.sh bench/twostate.v
+ *    bench/run.sh -DWIDTH=256 -DCYCLES=2000 bench/twostate.v
+ *
+ * The checksum printed at the end must not change between builds.
+ */
+`ifndef STAGES
+`define STAGES 2000
+`endif
+`ifndef WIDTH
+`define WIDTH 64
+`endif
+`ifndef CYCLES
+`define CYCLES 5000
+`endif
+
+module main;
+      reg  [`WIDTH-1:0] in = 0, mask = 0, last = 0;
+      reg  [31:0] lfsr = 1, sum = 0;
+      integer i;
+
+      genvar k;
+      for (k = 0 ; k < `STAGES ; k = k + 1) begin : s
+	 wire [`WIDTH-1:0] y;
+	 if (k == 0) begin : first
+	    assign y = in;
+	 end else begin : next
+	    assign y = (s[k-1].y & ~mask) | (s[k-1].y & {`WIDTH/2{2'b10}}) | (mask & in);
+	 end
+      end
+
+      initial begin
+	 for (i = 0 ; i < `CYCLES ; i = i + 1) begin
+	    lfsr = {lfsr[30:0], lfsr[31] ^ lfsr[21] ^ lfsr[1] ^ lfsr[0]};
+	    in = {`WIDTH/32+1{lfsr}};
+	    mask = {`WIDTH/16+1{lfsr[15:0]}} << (i % 7);
+	    #1 if (s[`STAGES-1].y !== last)
+	       sum = sum + 1;
+	    last = s[`STAGES-1].y;
+	    sum = sum ^ last[31:0];
+	 end
+	 $display("twostate: stages=%0d width=%0d cycles=%0d sum=%h",
+		  `STAGES, `WIDTH, `CYCLES, sum);
+	 $finish;
+      end
+endmodule
@@ -0,0 +1,111 @@
+/*
+ * Gate level benchmark for user defined primitives.
+ *
+ * The netlist is CELLS cells, each made of two combinational UDPs, a
+ * multiplexer UDP and an edge sensitive flip-flop UDP. The cells feed
+ * each other around a ring, and the testbench clocks them CYCLES times
+ * with a pseudo random input, so nearly all the run time is the
+ * evaluation of the UDP instances.
+ *
+ *    bench/run.sh bench/udp.v
+ *    bench/run.sh -DCELLS=50000 -DCYCLES=100 bench/udp.v
+ *
+ * The checksum printed at the end must not change between builds.
+ */
+`ifndef CELLS
+`define CELLS 20000
+`endif
+`ifndef CYCLES
+`define CYCLES 400
+`endif
+
+primitive u_maj3 (y, a, b, c);
+      output y;
+      input  a, b, c;
+      table
+	 0 0 ? : 0;
+	 0 ? 0 : 0;
+	 ? 0 0 : 0;
+	 1 1 ? : 1;
+	 1 ? 1 : 1;
+	 ? 1 1 : 1;
+      endtable
+endprimitive
+
+primitive u_xor3 (y, a, b, c);
+      output y;
+      input  a, b, c;
+      table
+	 0 0 0 : 0;
+	 0 0 1 : 1;
+	 0 1 0 : 1;
+	 0 1 1 : 0;
+	 1 0 0 : 1;
+	 1 0 1 : 0;
+	 1 1 0 : 0;
+	 1 1 1 : 1;
+      endtable
+endprimitive
+
+primitive u_mux2 (y, s, a, b);
+      output y;
+      input  s, a, b;
+      table
+	 0 0 ? : 0;
+	 0 1 ? : 1;
+	 1 ? 0 : 0;
+	 1 ? 1 : 1;
+	 x 0 0 : 0;
+	 x 1 1 : 1;
+      endtable
+endprimitive
+
+primitive u_dff (q, r, clk, d);
+      output q;
+      reg    q;
+      input  r, clk, d;
+      initial q = 0;
+      table
+      // r  clk  d : q : q+
+	 1   ?   ? : ? : 0;
+	 0  (01) 0 : ? : 0;
+	 0  (01) 1 : ? : 1;
+	 0  (0x) ? : ? : x;
+	 0  (?0) ? : ? : -;
+	 0  (1x) ? : ? : -;
+	 0   ?  (??) : ? : -;
+	 (??) ?  ? : ? : -;
+      endtable
+endprimitive
+
+module main;
+      reg clk = 0, rst = 1, in = 0, sel = 0;
+      reg [31:0] lfsr = 32'h1, sum = 0;
+      integer i;
+
+      genvar k;
+      for (k = 0 ; k < `CELLS ; k = k + 1) begin : c
+	 wire q, j, x, m;
+	 wire a = (k == 0) ? in : c[(k+`CELLS-1) % `CELLS].q;
+	 wire b = c[(k+`CELLS-7) % `CELLS].q;
+	 wire s = c[(k+`CELLS-13) % `CELLS].q;
+	 u_maj3 g1 (j, a, b, s);
+	 u_xor3 g2 (x, a, b, in);
+	 u_mux2 g3 (m, sel, j, x);
+	 u_dff  g4 (q, rst, clk, m);
+      end
+
+      initial begin
+	 #1 rst = 0;
+	 for (i = 0 ; i < `CYCLES ; i = i + 1) begin
+	    lfsr = {lfsr[30:0], lfsr[31] ^ lfsr[21] ^ lfsr[1] ^ lfsr[0]};
+	    in = lfsr[0];
+	    sel = lfsr[5] & lfsr[9];
+	    #5 clk = 1;
+	    #5 clk = 0;
+	    sum = {sum[28:0], sum[31:29]} ^ {c[0].q, c[`CELLS/2].q, c[`CELLS-1].q};
+	 end
+	 $display("udp: cells=%0d cycles=%0d sum=%h", `CELLS, `CYCLES, sum);
+	 $finish;
+      end
+endmodule
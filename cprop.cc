@@ -22,6 +22,7 @@
 # include  <algorithm>
 # include  <vector>
 # include  <cstdlib>
+# include  <ctime>
 # include  "netlist.h"
 # include  "netmisc.h"
 # include  "functor.h"
@@ -34,6 +35,11 @@
  * possible. The elaboration generates NetConst objects. I can remove
  * these and replace the gates connected to it with simpler ones. I
  * may even be able to replace nets with a new constant.
+ *
+ * The first pass looks at all the nodes of the design. After that,
+ * only the nodes connected to something that was changed can find
+ * anything new to do, so each change marks the nodes on the nexus
+ * that it changed, and later passes only look at the marked nodes.
  */
 
 struct cprop_functor  : public functor_t {
@@ -52,6 +58,20 @@ struct cprop_functor  : public functor_t {
       void lpm_compare_eq_(Design*des, NetCompare*obj);
  };
 
+/*
+ * Mark the nodes that are connected to the nexus of the pin, so that
+ * the next pass looks at them again.
+ */
+static void mark_nexus(Design*des, Link&pin)
+{
+      Nexus*nex = pin.nexus();
+      for (Link*cur = nex->first_nlink() ; cur ; cur = cur->next_nlink()) {
+	    NetNode*node = dynamic_cast<NetNode*> (cur->get_obj());
+	    if (node)
+		  des->mark_for_functor(node);
+      }
+}
+
 void cprop_functor::signal(Design*, NetNet*)
 {
 }
@@ -119,10 +139,11 @@ void cprop_functor::lpm_concat(Design*des, NetConcat*obj)
 	// will be reaped by other passes of cprop_functor.
       delete obj;
 
+      mark_nexus(des, result_obj->pin(0));
       count += 1;
 }
 
-void cprop_functor::lpm_ff(Design*, NetFF*obj)
+void cprop_functor::lpm_ff(Design*des, NetFF*obj)
 {
 	// Look for and count unlinked FF outputs. Note that if the
 	// Data and Q pins are connected together, they can be removed
@@ -133,6 +154,7 @@ void cprop_functor::lpm_ff(Design*, NetFF*obj)
 	  && (! obj->pin_Sset().is_linked())
 	  && (! obj->pin_Aclr().is_linked())
 	  && (! obj->pin_Aset().is_linked())) {
+	    mark_nexus(des, obj->pin_Q());
 	    obj->pin_Data().unlink();
 	    obj->pin_Q().unlink();
 	    delete obj;
@@ -190,6 +212,7 @@ void cprop_functor::lpm_mux(Design*des, NetMux*obj)
 	    connect(tmp->pin(1), obj->pin_Data(0));
       delete obj;
       des->add_node(tmp);
+      mark_nexus(des, tmp->pin(0));
       count += 1;
 }
 
@@ -326,6 +349,7 @@ void cprop_functor::lpm_part_select(Design*des, NetPartSelect*obj)
 	    delete obj_set[idx];
       }
 
+      mark_nexus(des, concat->pin(0));
       count += 1;
 }
 
@@ -426,19 +450,35 @@ void cprop_dc_functor::lpm_const(Design*, NetConst*obj)
 }
 
 
+static void report_pass(unsigned count, unsigned visited, clock_t start)
+{
+      cout << " ... Iteration detected " << count << " optimizations";
+      if (visited > 0)
+	    cout << " in " << visited << " nodes";
+      cout << ", " << (double)(clock() - start) / CLOCKS_PER_SEC
+	   << " seconds." << endl << flush;
+}
+
 void cprop(Design*des)
 {
-	// Continually propagate constants until a scan finds nothing
-	// to do.
+	// The first pass looks at all the nodes, then continually
+	// propagate constants until there are no marked nodes left.
       cprop_functor prop;
-      do {
+      clock_t start = clock();
+      prop.count = 0;
+      des->functor(&prop);
+      if (verbose_flag)
+	    report_pass(prop.count, 0, start);
+
+      for (;;) {
+	    start = clock();
 	    prop.count = 0;
-	    des->functor(&prop);
-	    if (verbose_flag) {
-		  cout << " ... Iteration detected "
-		       << prop.count << " optimizations." << endl << flush;
-	    }
-      } while (prop.count > 0);
+	    unsigned visited = des->functor_marked(&prop);
+	    if (visited == 0)
+		  break;
+	    if (verbose_flag)
+		  report_pass(prop.count, visited, start);
+      }
 
       if (verbose_flag) {
 	    cout << " ... Look for dangling constants" << endl << flush;
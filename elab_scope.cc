@@ -49,6 +49,7 @@
 # include  "netclass.h"
 # include  "netenum.h"
 # include  "parse_api.h"
+# include  "pass_report.h"
 # include  "util.h"
 # include  <typeinfo>
 # include  <cassert>
@@ -695,6 +696,8 @@ bool PPackage::elaborate_scope(Design*des, NetScope*scope)
 bool Module::elaborate_scope(Design*des, NetScope*scope,
 			     const replace_t&replacements)
 {
+      pass_report_t report (mod_name());
+
       if (debug_scopes) {
 	    cerr << get_fileline() << ": debug: Elaborate scope "
 		 << scope_path(scope) << "." << endl;
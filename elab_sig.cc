@@ -41,6 +41,7 @@
 # include  "netvector.h"
 # include  "netdarray.h"
 # include  "netparray.h"
+# include  "pass_report.h"
 # include  "util.h"
 # include  "ivl_assert.h"
 
@@ -220,6 +221,7 @@ bool PPackage::elaborate_sig(Design*des, NetScope*scope) const
 
 bool Module::elaborate_sig(Design*des, NetScope*scope) const
 {
+      pass_report_t report (mod_name());
       bool flag = true;
 
 	// Scan all the ports of the module, and make sure that each
@@ -923,6 +925,84 @@ bool test_ranges_eeq(const vector<netrange_t>&lef, const vector<netrange_t>&rig)
       return true;
 }
 
+/*
+ * These are the system functions that are constant functions of
+ * their arguments, so may be used in a local range expression.
+ */
+static bool range_sys_func_is_local(perm_string name)
+{
+      static const char*const names[] = {
+	    "$acos", "$acosh", "$asin", "$asinh", "$atan", "$atan2",
+	    "$atanh", "$ceil", "$clog2", "$cos", "$cosh", "$exp",
+	    "$floor", "$hypot", "$itor", "$ln", "$log10", "$pow",
+	    "$rtoi", "$signed", "$sin", "$sinh", "$sqrt", "$tan",
+	    "$tanh", "$unsigned", 0
+      };
+
+      for (unsigned idx = 0 ; names[idx] ; idx += 1)
+	    if (name == names[idx]) return true;
+
+      return false;
+}
+
+/*
+ * A range expression is local if its value only depends on the
+ * parameters of the scope that it is in: it is made of numbers and
+ * simple names, with unary and binary operators and calls to the
+ * constant system functions.
+ */
+static bool range_expr_is_local(const PExpr*expr)
+{
+      if (dynamic_cast<const PENumber*>(expr))
+	    return true;
+
+      if (const PEIdent*ident = dynamic_cast<const PEIdent*>(expr)) {
+	    const pform_name_t&path = ident->path();
+	    return path.size() == 1 && path.back().index.empty();
+      }
+
+      if (const PEUnary*unary = dynamic_cast<const PEUnary*>(expr))
+	    return range_expr_is_local(unary->get_expr());
+
+      if (const PEBinary*binary = dynamic_cast<const PEBinary*>(expr))
+	    return range_expr_is_local(binary->get_left())
+		  && range_expr_is_local(binary->get_right());
+
+      if (const PECallFunction*call = dynamic_cast<const PECallFunction*>(expr)) {
+	    const pform_name_t&path = call->path();
+	    if (call->package() || path.size() != 1
+		|| ! path.back().index.empty()
+		|| ! range_sys_func_is_local(path.back().name))
+		  return false;
+
+	    const vector<PExpr*>&parms = call->parms();
+	    for (size_t idx = 0 ; idx < parms.size() ; idx += 1)
+		  if (parms[idx] == 0 || ! range_expr_is_local(parms[idx]))
+			return false;
+
+	    return true;
+      }
+
+      return false;
+}
+
+bool PWire::ranges_are_local_() const
+{
+      for (list<pform_range_t>::const_iterator cur = port_.begin()
+		 ; cur != port_.end() ; ++ cur ) {
+	    if (! range_expr_is_local(cur->first)) return false;
+	    if (! range_expr_is_local(cur->second)) return false;
+      }
+
+      for (list<pform_range_t>::const_iterator cur = net_.begin()
+		 ; cur != net_.end() ; ++ cur ) {
+	    if (! range_expr_is_local(cur->first)) return false;
+	    if (! range_expr_is_local(cur->second)) return false;
+      }
+
+      return true;
+}
+
 /*
  * Elaborate a source wire. The "wire" is the declaration of wires,
  * registers, ports and memories. The parser has already merged the
@@ -986,7 +1066,35 @@ NetNet* PWire::elaborate_sig(Design*des, NetScope*scope) const
 	    des->errors += 1;
       }
 
-      if (port_set_ || net_set_) {
+	// The packed dimensions of a wire in a module instance only
+	// depend on the parameters of the instance if the range
+	// expressions are local, so instances with the same
+	// parameter values can share them. Nested modules can see the
+	// parameters of the enclosing scope, so are left out. The
+	// dimensions are only kept once a second instance with the
+	// same parameter values turns up, so that modules that are
+	// instantiated once do not pay for it.
+      const string*param_sig = 0;
+      elab_ranges_t*cached = 0;
+      if ((port_set_ || net_set_) && scope->type() == NetScope::MODULE
+	  && ! scope->nested_module() && ranges_are_local_()) {
+	    param_sig = scope->parameter_signature();
+	    if (param_sig) {
+		  map<const string*,elab_ranges_t>::iterator cur
+			= elab_ranges_.find(param_sig);
+		  if (cur != elab_ranges_.end())
+			cached = &cur->second;
+		  else if (! scope->parameter_signature_shared())
+			param_sig = 0;
+	    }
+      }
+
+      if (cached) {
+	    packed_dimensions = cached->dims;
+	    wid = netrange_width(packed_dimensions);
+	    is_implicit_scalar = cached->is_implicit_scalar;
+
+      } else if (port_set_ || net_set_) {
 	    bool bad_range = false;
 	    vector<netrange_t> plist, nlist;
 	    /* If they exist get the port definition MSB and LSB */
@@ -1070,6 +1178,11 @@ NetNet* PWire::elaborate_sig(Design*des, NetScope*scope) const
 	    packed_dimensions = nlist;
 	    wid = netrange_width(packed_dimensions);
 
+	    if (param_sig) {
+		  cached = &elab_ranges_[param_sig];
+		  cached->dims = packed_dimensions;
+		  cached->is_implicit_scalar = is_implicit_scalar;
+	    }
       }
 
       unsigned nattrib = 0;
@@ -1295,11 +1408,18 @@ NetNet* PWire::elaborate_sig(Design*des, NetScope*scope) const
 		  }
 	    }
 
-	    netvector_t*vec = new netvector_t(packed_dimensions, use_data_type);
-	    vec->set_signed(get_signed());
-	    vec->set_isint(get_isint());
-	    if (is_implicit_scalar) vec->set_scalar(true);
-	    else vec->set_scalar(get_scalar());
+	      // The vector type only depends on the packed dimensions
+	      // and the declaration, so instances with the same
+	      // dimensions share it.
+	    netvector_t*vec = cached? cached->vec : 0;
+	    if (vec == 0) {
+		  vec = new netvector_t(packed_dimensions, use_data_type);
+		  vec->set_signed(get_signed());
+		  vec->set_isint(get_isint());
+		  if (is_implicit_scalar) vec->set_scalar(true);
+		  else vec->set_scalar(get_scalar());
+		  if (cached) cached->vec = vec;
+	    }
 	    packed_dimensions.clear();
 	    sig = new NetNet(scope, name_, wtype, unpacked_dimensions, vec);
 
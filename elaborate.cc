@@ -44,6 +44,7 @@
 # include  "netmisc.h"
 # include  "util.h"
 # include  "parse_api.h"
+# include  "pass_report.h"
 # include  "compiler.h"
 # include  "ivl_assert.h"
 
@@ -5274,6 +5275,7 @@ bool PPackage::elaborate(Design*des, NetScope*scope) const
 
 bool Module::elaborate(Design*des, NetScope*scope) const
 {
+      pass_report_t report (mod_name());
       bool result_flag = true;
 
 	// Elaborate within the generate blocks.
@@ -5719,6 +5721,9 @@ Design* elaborate(list<perm_string>roots)
 	// module and elaborate what I find.
       Design*des = new Design;
 
+	// The scopes, parameters and defparams are elaborated first.
+      if (pass_report_flag) pass_report_enter("scope");
+
 	// Elaborate enum sets in $root scope.
       elaborate_rootscope_enumerations(des);
 
@@ -5823,6 +5828,8 @@ Design* elaborate(list<perm_string>roots)
 	// scope) and clean them out.
       des->residual_defparams();
 
+      if (pass_report_flag) pass_report_leave();
+
 	// Errors already? Probably missing root modules. Just give up
 	// now and return nothing.
       if (des->errors > 0)
@@ -5832,6 +5839,7 @@ Design* elaborate(list<perm_string>roots)
 	// what we need to elaborate signals and memories. This pass
 	// creates all the NetNet and NetMemory objects for declared
 	// objects.
+      if (pass_report_flag) pass_report_enter("signals");
       for (i = 0; i < pack_elems.size(); i += 1) {
 	    PPackage*pack = pack_elems[i].pack;
 	    NetScope*scope= pack_elems[i].scope;
@@ -5841,6 +5849,7 @@ Design* elaborate(list<perm_string>roots)
 			cerr << "<toplevel>" << ": debug: " << pack->pscope_name()
 			     << ": elaborate_sig failed!!!" << endl;
 		  }
+		  if (pass_report_flag) pass_report_leave();
 		  delete des;
 		  return 0;
 	    }
@@ -5862,6 +5871,7 @@ Design* elaborate(list<perm_string>roots)
 			cerr << "<toplevel>" << ": debug: " << rmod->mod_name()
 			     << ": elaborate_sig failed!!!" << endl;
 		  }
+		  if (pass_report_flag) pass_report_leave();
 		  delete des;
 		  return 0;
 	    }
@@ -5892,10 +5902,12 @@ Design* elaborate(list<perm_string>roots)
 		  scope->add_module_port_info(idx, rmod->get_port_name(idx), ptype, prt_vector_width );
 	    }
       }
+      if (pass_report_flag) pass_report_leave();
 
 	// Now that the structure and parameters are taken care of,
 	// run through the pform again and generate the full netlist.
 
+      if (pass_report_flag) pass_report_enter("netlist");
       for (i = 0; i < pack_elems.size(); i += 1) {
 	    PPackage*pkg = pack_elems[i].pack;
 	    NetScope*scope = pack_elems[i].scope;
@@ -5907,6 +5919,7 @@ Design* elaborate(list<perm_string>roots)
 	    NetScope *scope = root_elems[i].scope;
 	    rc &= rmod->elaborate(des, scope);
       }
+      if (pass_report_flag) pass_report_leave();
 
       if (rc == false) {
 	    delete des;
@@ -175,6 +175,34 @@ void Design::functor(functor_t*fun)
       }
 }
 
+void Design::mark_for_functor(NetNode*node)
+{
+      if (functor_marked_.insert(node).second)
+	    functor_marked_list_.push_back(node);
+}
+
+unsigned Design::functor_marked(functor_t*fun)
+{
+      assert(functor_visit_.empty());
+      functor_visit_.swap(functor_marked_);
+      list<NetNode*> visit_list;
+      visit_list.swap(functor_marked_list_);
+
+	/* A node that is deleted removes itself from the
+	   functor_visit_ set (see Design::del_node) so skip the list
+	   entries that are no longer in the set. */
+      unsigned count = 0;
+      for (list<NetNode*>::iterator cur = visit_list.begin()
+		 ; cur != visit_list.end() ; ++ cur ) {
+	    if (functor_visit_.erase(*cur) == 0)
+		  continue;
+	    (*cur)->functor_node(this, fun);
+	    count += 1;
+      }
+
+      assert(functor_visit_.empty());
+      return count;
+}
 
 void NetNode::functor_node(Design*, functor_t*)
 {
@@ -60,6 +60,7 @@ const char NOTICE[] =
 # include  "target.h"
 # include  "compiler.h"
 # include  "discipline.h"
+# include  "pass_report.h"
 # include  "t-dll.h"
 
 #if defined(__MINGW32__) && !defined(HAVE_GETOPT_H)
@@ -1003,9 +1004,14 @@ int main(int argc, char*argv[])
       flag_tmp = flags["DISABLE_CONCATZ_GENERATION"];
       if (flag_tmp) disable_concatz_generation = strcmp(flag_tmp,"true")==0;
 
+      flag_tmp = flags["PASS_REPORT"];
+      if (flag_tmp) pass_report_init(flag_tmp);
+
 	/* Parse the input. Make the pform. */
+      if (pass_report_flag) pass_report_enter("parse");
       pform_set_timescale(def_ts_units, def_ts_prec, 0, 0);
       int rc = pform_parse(argv[optind]);
+      if (pass_report_flag) pass_report_leave();
 
       if (pf_path) {
 	    ofstream out (pf_path);
@@ -1101,7 +1107,9 @@ int main(int argc, char*argv[])
       }
 
 	/* On with the process of elaborating the module. */
+      if (pass_report_flag) pass_report_enter("elaborate");
       Design*des = elaborate(roots);
+      if (pass_report_flag) pass_report_leave();
 
       if ((des == 0) || (des->errors > 0)) {
 	    if (des != 0) {
@@ -1151,18 +1159,24 @@ int main(int argc, char*argv[])
 	    cout << "RUNNING FUNCTORS" << endl;
       }
 
+      if (pass_report_flag) pass_report_enter("functors");
       while (!net_func_queue.empty()) {
 	    net_func func = net_func_queue.front();
 	    net_func_queue.pop();
 	    if (verbose_flag)
 		  cerr<<" -F "<<net_func_to_name(func)<< " ..." <<endl;
+	    if (pass_report_flag) pass_report_enter(net_func_to_name(func));
 	    func(des);
+	    if (pass_report_flag) pass_report_leave();
       }
+      if (pass_report_flag) pass_report_leave();
 
       if (verbose_flag) {
 	    cout << "CALCULATING ISLANDS" << endl;
       }
+      if (pass_report_flag) pass_report_enter("islands");
       des->join_islands();
+      if (pass_report_flag) pass_report_leave();
 
       if (net_path) {
 	    if (verbose_flag)
@@ -1191,6 +1205,7 @@ int main(int argc, char*argv[])
 	    cout << "CODE GENERATION" << endl;
       }
 
+      if (pass_report_flag) pass_report_enter("emit");
       if (int emit_rc = des->emit(&dll_target_obj)) {
 	    if (emit_rc > 0) {
 		  cerr << "error: Code generation had "
@@ -1205,6 +1220,11 @@ int main(int argc, char*argv[])
 	    assert(emit_rc);
       }
 
+      if (pass_report_flag) {
+	    pass_report_leave();
+	    pass_report_write();
+      }
+
       if (verbose_flag) {
 	    if (times_flag) {
 		  times(cycles+4);
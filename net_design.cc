@@ -32,6 +32,7 @@
 # include  "util.h"
 # include  "compiler.h"
 # include  "netmisc.h"
+# include  "pass_report.h"
 # include  "PExpr.h"
 # include  "PTask.h"
 # include  <sstream>
@@ -712,11 +713,18 @@ void NetScope::evaluate_parameters(Design*des)
 	    cerr << "debug: "
 		 << "Evaluating parameters in " << scope_path(this) << endl;
 
+	// The parameters of a module instance are part of the cost
+	// of its module.
+      bool report_flag = pass_report_flag && type_ == MODULE;
+      if (report_flag) pass_report_enter_module(module_name());
+
       for (param_ref_t cur = parameters.begin()
 		 ; cur != parameters.end() ;  ++ cur) {
 
             evaluate_parameter_(des, cur);
       }
+
+      if (report_flag) pass_report_leave();
 }
 
 void Design::residual_defparams()
@@ -847,6 +855,9 @@ void Design::del_node(NetNode*net)
       if (net == nodes_functor_cur_)
 	    nodes_functor_cur_ = 0;
 
+      functor_marked_.erase(net);
+      functor_visit_.erase(net);
+
 	/* Now perform the actual delete. */
       if (nodes_ == net)
 	    nodes_ = net->node_prev_;
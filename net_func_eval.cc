@@ -20,7 +20,9 @@
 # include  "netlist.h"
 # include  "netmisc.h"
 # include  "compiler.h"
+# include  "pass_report.h"
 # include  <typeinfo>
+# include  <sstream>
 # include  "ivl_assert.h"
 
 using namespace std;
@@ -53,51 +55,115 @@ static NetExpr* fix_assign_value(const NetNet*lhs, NetExpr*rhs)
       return rhs;
 }
 
+/*
+ * Find the slot of a variable in the context, or return nil if the
+ * variable is not one of the function (for example if it is a
+ * hierarchical reference to somewhere else).
+ */
+static LocalVar* find_local_var(vector<LocalVar>&context, const NetNet*net)
+{
+      unsigned slot = net->func_slot();
+      if (slot >= context.size() || context[slot].net != net)
+	    return 0;
+
+      return &context[slot];
+}
+
+static void clear_local_var(LocalVar&var)
+{
+      if (var.nwords > 0) {
+	    for (int idx = 0 ; idx < var.nwords ; idx += 1)
+		  delete var.array[idx];
+	    delete [] var.array;
+      } else {
+	    delete var.value;
+      }
+
+      var.nwords = 0;
+      var.value = 0;
+}
+
 NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<NetExpr*>&args) const
 {
-	// Make the context map.
-      map<perm_string,LocalVar>::iterator ptr;
-      map<perm_string,LocalVar>context_map;
+      pass_report_t report ("functions");
 
       if (debug_eval_tree) {
 	    cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
 		 << "Evaluate function " << scope()->basename() << endl;
       }
 
-	// Put the return value into the map...
-      LocalVar&return_var = context_map[scope()->basename()];
-      return_var.nwords = 0;
-      return_var.value  = 0;
-
-	// Load the input ports into the map...
+	// Fit the arguments to the input ports...
       ivl_assert(loc, port_count() == args.size());
+      vector<NetExpr*> inputs (port_count());
       for (size_t idx = 0 ; idx < port_count() ; idx += 1) {
-	    const NetNet*pnet = port(idx);
-	    perm_string aname = pnet->name();
-	    LocalVar&input_var = context_map[aname];
-	    input_var.nwords = 0;
-	    input_var.value  = fix_assign_value(pnet, args[idx]);
+	    inputs[idx] = fix_assign_value(port(idx), args[idx]);
 
 	    if (debug_eval_tree) {
 		  cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
-		       << "   input " << aname << " = " << *args[idx] << endl;
+		       << "   input " << port(idx)->name() << " = ";
+		  if (inputs[idx]) cerr << *inputs[idx];
+		  else cerr << "<nil>";
+		  cerr << endl;
 	    }
       }
 
-	// Ask the scope to collect definitions for local values. This
-	// fills in the context_map with local variables held by the scope.
-      scope()->evaluate_function_find_locals(loc, context_map);
+	// ... and use them to look for the result of an earlier call
+	// with the same arguments.
+      ostringstream key;
+      bool memo_flag = true;
+      for (size_t idx = 0 ; idx < inputs.size() && memo_flag ; idx += 1) {
+	    memo_flag = inputs[idx] && const_value_signature(key, inputs[idx]);
+	    key << ";";
+      }
+
+      if (memo_flag) {
+	    map<string,NetExpr*>::const_iterator cur = results_.find(key.str());
+	    if (cur != results_.end()) {
+		  for (size_t idx = 0 ; idx < inputs.size() ; idx += 1)
+			delete inputs[idx];
 
-      if (debug_eval_tree && proc_==0) {
-	    cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
-		 << "Function " << scope_path(scope())
-		 << " has no statement?" << endl;
+		  if (debug_eval_tree) {
+			cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
+			     << "Reuse result " << *cur->second << endl;
+		  }
+		  return cur->second->dup_expr();
+	    }
+      }
+
+      if (proc_ == 0) {
+	    if (debug_eval_tree) {
+		  cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
+		       << "Function " << scope_path(scope())
+		       << " has no statement?" << endl;
+	    }
+	    for (size_t idx = 0 ; idx < inputs.size() ; idx += 1)
+		  delete inputs[idx];
+	    return 0;
       }
 
-	// Perform the evaluation. Note that if there were errors
-	// when compiling the function definition, we may not have
-	// a valid statement.
-      bool flag = proc_ && proc_->evaluate_function(loc, context_map);
+	// Make the context. Each variable of the function has a slot
+	// in it, and the input ports get the arguments.
+      if (locals_.empty())
+	    scope()->evaluate_function_number_locals(locals_);
+
+      vector<LocalVar> context (locals_.size());
+      for (size_t idx = 0 ; idx < locals_.size() ; idx += 1) {
+	    context[idx].net = locals_[idx];
+	    context[idx].nwords = 0;
+	    context[idx].value = 0;
+      }
+
+      for (size_t idx = 0 ; idx < port_count() ; idx += 1) {
+	    LocalVar*input_var = find_local_var(context, port(idx));
+	    ivl_assert(loc, input_var);
+	    input_var->value = inputs[idx];
+      }
+
+	// Ask the scope to set up its local variables in the context.
+      scope()->evaluate_function_find_locals(loc, context);
+
+	// Perform the evaluation.
+      bool flag = proc_->evaluate_function(loc, context);
 
       if (debug_eval_tree && !flag) {
 	    cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
@@ -105,24 +171,15 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
       }
 
 	// Extract the result...
-      ptr = context_map.find(scope()->basename());
-      NetExpr*res = ptr->second.value;
-      context_map.erase(ptr);
+      NetExpr*res = 0;
+      if (LocalVar*return_var = result_sig_? find_local_var(context, result_sig_) : 0) {
+	    res = return_var->value;
+	    return_var->value = 0;
+      }
 
 	// Cleanup the rest of the context.
-      for (ptr = context_map.begin() ; ptr != context_map.end() ; ++ptr) {
-
-	    unsigned nwords = ptr->second.nwords;
-	    if (nwords > 0) {
-		  NetExpr**array = ptr->second.array;
-		  for (unsigned idx = 0 ; idx < nwords ; idx += 1) {
-			delete array[idx];
-		  }
-		  delete [] ptr->second.array;
-	    } else {
-		  delete ptr->second.value;
-	    }
-      }
+      for (size_t idx = 0 ; idx < context.size() ; idx += 1)
+	    clear_local_var(context[idx]);
 
       if (disable) {
 	    if (debug_eval_tree)
@@ -143,6 +200,8 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
 		  else cerr << "<nil>";
 		  cerr << endl;
 	    }
+	    if (memo_flag && res)
+		  results_[key.str()] = res->dup_expr();
 	    return res;
       }
 
@@ -155,8 +214,21 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
       return 0;
 }
 
+void NetScope::evaluate_function_number_locals(vector<NetNet*>&locals) const
+{
+      for (map<perm_string,NetNet*>::const_iterator cur = signals_map_.begin()
+		 ; cur != signals_map_.end() ; ++cur) {
+	    cur->second->func_slot(locals.size());
+	    locals.push_back(cur->second);
+      }
+
+      for (map<hname_t,NetScope*>::const_iterator cur = children_.begin()
+		 ; cur != children_.end() ; ++cur)
+	    cur->second->evaluate_function_number_locals(locals);
+}
+
 void NetScope::evaluate_function_find_locals(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
       for (map<perm_string,NetNet*>::const_iterator cur = signals_map_.begin()
 		 ; cur != signals_map_.end() ; ++cur) {
@@ -170,17 +242,19 @@ void NetScope::evaluate_function_find_locals(const LineInfo&loc,
 	    if (tmp->unpacked_dimensions() > 0)
 		  nwords = tmp->unpacked_count();
 
-	    LocalVar&local_var = context_map[tmp->name()];
-	    local_var.nwords = nwords;
+	      // A block may be run more than once, and each time its
+	      // variables start out fresh.
+	    LocalVar*local_var = find_local_var(context, tmp);
+	    ivl_assert(loc, local_var);
+	    clear_local_var(*local_var);
+	    local_var->nwords = nwords;
 
 	    if (nwords > 0) {
 		  NetExpr**array = new NetExpr*[nwords];
 		  for (unsigned idx = 0 ; idx < nwords ; idx += 1) {
 			array[idx] = 0;
 		  }
-		  local_var.array = array;
-	    } else {
-		  local_var.value = 0;
+		  local_var->array = array;
 	    }
 
 	    if (debug_eval_tree) {
@@ -192,7 +266,7 @@ void NetScope::evaluate_function_find_locals(const LineInfo&loc,
 }
 
 NetExpr* NetExpr::evaluate_function(const LineInfo&,
-				    map<perm_string,LocalVar>&) const
+				    vector<LocalVar>&) const
 {
       cerr << get_fileline() << ": sorry: I don't know how to evaluate this expression at compile time." << endl;
       cerr << get_fileline() << ":      : Expression type:" << typeid(*this).name() << endl;
@@ -201,7 +275,7 @@ NetExpr* NetExpr::evaluate_function(const LineInfo&,
 }
 
 bool NetProc::evaluate_function(const LineInfo&,
-				map<perm_string,LocalVar>&) const
+				vector<LocalVar>&) const
 {
       cerr << get_fileline() << ": sorry: I don't know how to evaluate this statement at compile time." << endl;
       cerr << get_fileline() << ":      : Statement type:" << typeid(*this).name() << endl;
@@ -210,22 +284,16 @@ bool NetProc::evaluate_function(const LineInfo&,
 }
 
 bool NetAssign::eval_func_lval_(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map,
+				vector<LocalVar>&context,
 				const NetAssign_*lval, NetExpr*rval_result) const
 {
-      map<perm_string,LocalVar>::iterator ptr = context_map.find(lval->name());
-      ivl_assert(*this, ptr != context_map.end());
-
-      LocalVar*var = & ptr->second;
-      while (var->nwords == -1) {
-	    assert(var->ref);
-	    var = var->ref;
-      }
+      LocalVar*var = find_local_var(context, lval->sig());
+      ivl_assert(*this, var);
 
       NetExpr*old_lval;
       int word = 0;
       if (var->nwords > 0) {
-	    NetExpr*word_result = lval->word()->evaluate_function(loc, context_map);
+	    NetExpr*word_result = lval->word()->evaluate_function(loc, context);
 	    if (word_result == 0) {
 		  delete rval_result;
 		  return false;
@@ -249,7 +317,7 @@ bool NetAssign::eval_func_lval_(const LineInfo&loc,
       }
 
       if (const NetExpr*base_expr = lval->get_base()) {
-	    NetExpr*base_result = base_expr->evaluate_function(loc, context_map);
+	    NetExpr*base_result = base_expr->evaluate_function(loc, context);
 	    if (base_result == 0) {
 		  delete rval_result;
 		  return false;
@@ -302,16 +370,16 @@ bool NetAssign::eval_func_lval_(const LineInfo&loc,
 }
 
 bool NetAssign::evaluate_function(const LineInfo&loc,
-				  map<perm_string,LocalVar>&context_map) const
+				  vector<LocalVar>&context) const
 {
 	// Evaluate the r-value expression.
-      NetExpr*rval_result = rval()->evaluate_function(loc, context_map);
+      NetExpr*rval_result = rval()->evaluate_function(loc, context);
       if (rval_result == 0)
 	    return false;
 
 	// Handle the easy case of a single variable on the LHS.
       if (l_val_count() == 1)
-	    return eval_func_lval_(loc, context_map, l_val(0), rval_result);
+	    return eval_func_lval_(loc, context, l_val(0), rval_result);
 
 	// If we get here, the LHS must be a concatenation, so we
 	// expect the RHS to be a vector value.
@@ -329,7 +397,7 @@ bool NetAssign::evaluate_function(const LineInfo&loc,
 	    for (unsigned idx = 0 ; idx < rval_part.len() ; idx += 1)
 		  rval_part.set(idx, rval_full[base+idx]);
 
-	    bool flag = eval_func_lval_(loc, context_map, lval,
+	    bool flag = eval_func_lval_(loc, context, lval,
 					new NetEConst(rval_part));
 	    if (!flag) return false;
 
@@ -344,36 +412,14 @@ bool NetAssign::evaluate_function(const LineInfo&loc,
  * evaluating the statements in order.
  */
 bool NetBlock::evaluate_function(const LineInfo&loc,
-				 map<perm_string,LocalVar>&context_map) const
+				 vector<LocalVar>&context) const
 {
       if (last_ == 0) return true;
 
-	// If we need to make a local scope, then this context map
-	// will be filled in and used for statements within this block.
-      map<perm_string,LocalVar>local_context_map;
-      bool use_local_context_map = false;
-
-      if (subscope_!=0) {
-	      // First, copy the containing scope symbols into the new
-	      // scope as references.
-	    for (map<perm_string,LocalVar>::iterator cur = context_map.begin()
-		       ; cur != context_map.end() ; ++cur) {
-		  LocalVar&cur_var = local_context_map[cur->first];
-		  cur_var.nwords = -1;
-		  if (cur->second.nwords == -1)
-			cur_var.ref = cur->second.ref;
-		  else
-			cur_var.ref = &cur->second;
-	    }
-
-	      // Now collect the new locals.
-	    subscope_->evaluate_function_find_locals(loc, local_context_map);
-	    use_local_context_map = true;
-      }
-
-	// Now use the local context map if there is any local
-	// context, or the containing context map.
-      map<perm_string,LocalVar>&use_context_map = use_local_context_map? local_context_map : context_map;
+	// The variables of the block scope have their own slots in
+	// the context, so they only need to be made fresh.
+      if (subscope_ != 0)
+	    subscope_->evaluate_function_find_locals(loc, context);
 
       bool flag = true;
       NetProc*cur = last_;
@@ -385,7 +431,7 @@ bool NetBlock::evaluate_function(const LineInfo&loc,
 		       << ") at " << cur->get_fileline() << "." << endl;
 	    }
 
-	    bool cur_flag = cur->evaluate_function(loc, use_context_map);
+	    bool cur_flag = cur->evaluate_function(loc, context);
 	    flag = flag && cur_flag;
       } while (cur != last_ && !disable);
 
@@ -402,9 +448,9 @@ bool NetBlock::evaluate_function(const LineInfo&loc,
 }
 
 bool NetCase::evaluate_function_vect_(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
-      NetExpr*case_expr = expr_->evaluate_function(loc, context_map);
+      NetExpr*case_expr = expr_->evaluate_function(loc, context);
       if (case_expr == 0)
 	    return false;
 
@@ -424,7 +470,7 @@ bool NetCase::evaluate_function_vect_(const LineInfo&loc,
                   continue;
             }
 
-            NetExpr*item_expr = item->guard->evaluate_function(loc, context_map);
+            NetExpr*item_expr = item->guard->evaluate_function(loc, context);
             if (item_expr == 0)
                   return false;
 
@@ -454,19 +500,19 @@ bool NetCase::evaluate_function_vect_(const LineInfo&loc,
             }
             if (!match) continue;
 
-            return item->statement->evaluate_function(loc, context_map);
+            return item->statement->evaluate_function(loc, context);
       }
 
       if (default_statement)
-            return default_statement->evaluate_function(loc, context_map);
+            return default_statement->evaluate_function(loc, context);
 
       return true;
 }
 
 bool NetCase::evaluate_function_real_(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
-      NetExpr*case_expr = expr_->evaluate_function(loc, context_map);
+      NetExpr*case_expr = expr_->evaluate_function(loc, context);
       if (case_expr == 0)
 	    return false;
 
@@ -486,7 +532,7 @@ bool NetCase::evaluate_function_real_(const LineInfo&loc,
                   continue;
             }
 
-            NetExpr*item_expr = item->guard->evaluate_function(loc, context_map);
+            NetExpr*item_expr = item->guard->evaluate_function(loc, context);
             if (item_expr == 0)
                   return false;
 
@@ -498,28 +544,28 @@ bool NetCase::evaluate_function_real_(const LineInfo&loc,
 
             if (item_val != case_val) continue;
 
-            return item->statement->evaluate_function(loc, context_map);
+            return item->statement->evaluate_function(loc, context);
       }
 
       if (default_statement)
-            return default_statement->evaluate_function(loc, context_map);
+            return default_statement->evaluate_function(loc, context);
 
       return true;
 }
 
 bool NetCase::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
       if (expr_->expr_type() == IVL_VT_REAL)
-	    return evaluate_function_real_(loc, context_map);
+	    return evaluate_function_real_(loc, context);
       else
-	    return evaluate_function_vect_(loc, context_map);
+	    return evaluate_function_vect_(loc, context);
 }
 
 bool NetCondit::evaluate_function(const LineInfo&loc,
-				  map<perm_string,LocalVar>&context_map) const
+				  vector<LocalVar>&context) const
 {
-      NetExpr*cond = expr_->evaluate_function(loc, context_map);
+      NetExpr*cond = expr_->evaluate_function(loc, context);
       if (cond == 0) {
 	    if (debug_eval_tree) {
 		  cerr << get_fileline() << ": NetCondit::evaluate_function: "
@@ -538,10 +584,10 @@ bool NetCondit::evaluate_function(const LineInfo&loc,
 
       if (val)
 	      // The condition is true, so evaluate the if clause
-	    flag = (if_ == 0) || if_->evaluate_function(loc, context_map);
+	    flag = (if_ == 0) || if_->evaluate_function(loc, context);
       else
 	      // The condition is false, so evaluate the else clause
-	    flag = (else_ == 0) || else_->evaluate_function(loc, context_map);
+	    flag = (else_ == 0) || else_->evaluate_function(loc, context);
 
       if (debug_eval_tree) {
 	    cerr << get_fileline() << ": NetCondit::evaluate_function: "
@@ -551,7 +597,7 @@ bool NetCondit::evaluate_function(const LineInfo&loc,
 }
 
 bool NetDisable::evaluate_function(const LineInfo&,
-				   map<perm_string,LocalVar>&) const
+				   vector<LocalVar>&) const
 {
       disable = target_;
 
@@ -564,7 +610,7 @@ bool NetDisable::evaluate_function(const LineInfo&,
 }
 
 bool NetDoWhile::evaluate_function(const LineInfo&loc,
-				   map<perm_string,LocalVar>&context_map) const
+				   vector<LocalVar>&context) const
 {
       bool flag = true;
 
@@ -575,13 +621,13 @@ bool NetDoWhile::evaluate_function(const LineInfo&loc,
 
       while (!disable) {
 	      // Evaluate the statement.
-	    flag = proc_->evaluate_function(loc, context_map);
+	    flag = proc_->evaluate_function(loc, context);
 	    if (! flag)
 		   break;
 
 	      // Evaluate the condition expression to try and get the
 	      // condition for the loop.
-	    NetExpr*cond = cond_->evaluate_function(loc, context_map);
+	    NetExpr*cond = cond_->evaluate_function(loc, context);
 	    if (cond == 0) {
 		  flag = false;
 		  break;
@@ -607,7 +653,7 @@ bool NetDoWhile::evaluate_function(const LineInfo&loc,
 }
 
 bool NetForever::evaluate_function(const LineInfo&loc,
-				   map<perm_string,LocalVar>&context_map) const
+				   vector<LocalVar>&context) const
 {
       bool flag = true;
 
@@ -617,7 +663,7 @@ bool NetForever::evaluate_function(const LineInfo&loc,
       }
 
       while (flag && !disable) {
-	    flag = flag && statement_->evaluate_function(loc, context_map);
+	    flag = flag && statement_->evaluate_function(loc, context);
       }
 
       if (debug_eval_tree) {
@@ -629,13 +675,13 @@ bool NetForever::evaluate_function(const LineInfo&loc,
 }
 
 bool NetRepeat::evaluate_function(const LineInfo&loc,
-				  map<perm_string,LocalVar>&context_map) const
+				  vector<LocalVar>&context) const
 {
       bool flag = true;
 
 	// Evaluate the condition expression to try and get the
 	// condition for the loop.
-      NetExpr*count_expr = expr_->evaluate_function(loc, context_map);
+      NetExpr*count_expr = expr_->evaluate_function(loc, context);
       if (count_expr == 0) return false;
 
       NetEConst*count_const = dynamic_cast<NetEConst*> (count_expr);
@@ -650,7 +696,7 @@ bool NetRepeat::evaluate_function(const LineInfo&loc,
       }
 
       while ((count > 0) && flag && !disable) {
-	    flag = flag && statement_->evaluate_function(loc, context_map);
+	    flag = flag && statement_->evaluate_function(loc, context);
 	    count -= 1;
       }
 
@@ -663,14 +709,14 @@ bool NetRepeat::evaluate_function(const LineInfo&loc,
 }
 
 bool NetSTask::evaluate_function(const LineInfo&,
-				 map<perm_string,LocalVar>&) const
+				 vector<LocalVar>&) const
 {
 	// system tasks within a constant function are ignored
       return true;
 }
 
 bool NetWhile::evaluate_function(const LineInfo&loc,
-				 map<perm_string,LocalVar>&context_map) const
+				 vector<LocalVar>&context) const
 {
       bool flag = true;
 
@@ -682,7 +728,7 @@ bool NetWhile::evaluate_function(const LineInfo&loc,
       while (flag && !disable) {
 	      // Evaluate the condition expression to try and get the
 	      // condition for the loop.
-	    NetExpr*cond = cond_->evaluate_function(loc, context_map);
+	    NetExpr*cond = cond_->evaluate_function(loc, context);
 	    if (cond == 0) {
 		  flag = false;
 		  break;
@@ -700,7 +746,7 @@ bool NetWhile::evaluate_function(const LineInfo&loc,
 
 	      // The condition is true, so evaluate the statement
 	      // another time.
-	    bool tmp_flag = proc_->evaluate_function(loc, context_map);
+	    bool tmp_flag = proc_->evaluate_function(loc, context);
 	    if (! tmp_flag)
 		  flag = false;
       }
@@ -714,10 +760,10 @@ bool NetWhile::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEBinary::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
-      NetExpr*lval = left_->evaluate_function(loc, context_map);
-      NetExpr*rval = right_->evaluate_function(loc, context_map);
+      NetExpr*lval = left_->evaluate_function(loc, context);
+      NetExpr*rval = right_->evaluate_function(loc, context);
 
       if (lval == 0 || rval == 0) {
 	    delete lval;
@@ -732,7 +778,7 @@ NetExpr* NetEBinary::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEConcat::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
       vector<NetExpr*>vals(parms_.size());
       unsigned gap = 0;
@@ -740,7 +786,7 @@ NetExpr* NetEConcat::evaluate_function(const LineInfo&loc,
       unsigned valid_vals = 0;
       for (unsigned idx = 0 ;  idx < parms_.size() ;  idx += 1) {
             ivl_assert(*this, parms_[idx]);
-            vals[idx] = parms_[idx]->evaluate_function(loc, context_map);
+            vals[idx] = parms_[idx]->evaluate_function(loc, context);
             if (vals[idx] == 0) continue;
 
             gap += vals[idx]->expr_width();
@@ -759,7 +805,7 @@ NetExpr* NetEConcat::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEConst::evaluate_function(const LineInfo&,
-				      map<perm_string,LocalVar>&) const
+				      vector<LocalVar>&) const
 {
       NetEConst*res = new NetEConst(value_);
       res->set_line(*this);
@@ -767,7 +813,7 @@ NetExpr* NetEConst::evaluate_function(const LineInfo&,
 }
 
 NetExpr* NetECReal::evaluate_function(const LineInfo&,
-				      map<perm_string,LocalVar>&) const
+				      vector<LocalVar>&) const
 {
       NetECReal*res = new NetECReal(value_);
       res->set_line(*this);
@@ -775,9 +821,9 @@ NetExpr* NetECReal::evaluate_function(const LineInfo&,
 }
 
 NetExpr* NetESelect::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
-      NetExpr*sub_exp = expr_->evaluate_function(loc, context_map);
+      NetExpr*sub_exp = expr_->evaluate_function(loc, context);
       ivl_assert(loc, sub_exp);
 
       NetEConst*sub_const = dynamic_cast<NetEConst*> (sub_exp);
@@ -788,7 +834,7 @@ NetExpr* NetESelect::evaluate_function(const LineInfo&loc,
 
       long base = 0;
       if (base_) {
-	    NetExpr*base_val = base_->evaluate_function(loc, context_map);
+	    NetExpr*base_val = base_->evaluate_function(loc, context);
 	    ivl_assert(loc, base_val);
 
 	    NetEConst*base_const = dynamic_cast<NetEConst*>(base_val);
@@ -810,26 +856,19 @@ NetExpr* NetESelect::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetESignal::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
-      map<perm_string,LocalVar>::iterator ptr = context_map.find(name());
-      if (ptr == context_map.end()) {
+      LocalVar*var = find_local_var(context, sig());
+      if (var == 0) {
 	    cerr << get_fileline() << ": error: Cannot evaluate " << name()
 		 << " in this context." << endl;
 	    return 0;
       }
 
-	// Follow indirect references to the actual variable.
-      LocalVar*var = & ptr->second;
-      while (var->nwords == -1) {
-	    assert(var->ref);
-	    var = var->ref;
-      }
-
       NetExpr*value = 0;
       if (var->nwords > 0) {
 	    ivl_assert(loc, word_);
-	    NetExpr*word_result = word_->evaluate_function(loc, context_map);
+	    NetExpr*word_result = word_->evaluate_function(loc, context);
 	    if (word_result == 0)
 		  return 0;
 
@@ -862,16 +901,16 @@ NetExpr* NetESignal::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetETernary::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
-      auto_ptr<NetExpr> cval (cond_->evaluate_function(loc, context_map));
+      auto_ptr<NetExpr> cval (cond_->evaluate_function(loc, context));
 
       switch (const_logical(cval.get())) {
 
 	  case C_0:
-	    return false_val_->evaluate_function(loc, context_map);
+	    return false_val_->evaluate_function(loc, context);
 	  case C_1:
-	    return true_val_->evaluate_function(loc, context_map);
+	    return true_val_->evaluate_function(loc, context);
 	  case C_X:
 	    break;
 	  default:
@@ -879,8 +918,8 @@ NetExpr* NetETernary::evaluate_function(const LineInfo&loc,
 	    return 0;
       }
 
-      NetExpr*tval = true_val_->evaluate_function(loc, context_map);
-      NetExpr*fval = false_val_->evaluate_function(loc, context_map);
+      NetExpr*tval = true_val_->evaluate_function(loc, context);
+      NetExpr*fval = false_val_->evaluate_function(loc, context);
 
       NetExpr*res = blended_arguments_(tval, fval);
       delete tval;
@@ -889,9 +928,9 @@ NetExpr* NetETernary::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEUnary::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
-      NetExpr*val = expr_->evaluate_function(loc, context_map);
+      NetExpr*val = expr_->evaluate_function(loc, context);
       if (val == 0) return 0;
 
       NetExpr*res = eval_arguments_(val);
@@ -900,7 +939,7 @@ NetExpr* NetEUnary::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetESFunc::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
       ID id = built_in_id_();
       ivl_assert(*this, id != NOT_BUILT_IN);
@@ -910,13 +949,13 @@ NetExpr* NetESFunc::evaluate_function(const LineInfo&loc,
       NetExpr*res = 0;
       switch (parms_.size()) {
 	  case 1:
-	    val0 = parms_[0]->evaluate_function(loc, context_map);
+	    val0 = parms_[0]->evaluate_function(loc, context);
 	    if (val0 == 0) break;
 	    res = evaluate_one_arg_(id, val0);
 	    break;
 	  case 2:
-	    val0 = parms_[0]->evaluate_function(loc, context_map);
-	    val1 = parms_[1]->evaluate_function(loc, context_map);
+	    val0 = parms_[0]->evaluate_function(loc, context);
+	    val1 = parms_[1]->evaluate_function(loc, context);
 	    if (val0 == 0 || val1 == 0) break;
 	    res = evaluate_two_arg_(id, val0, val1);
 	    break;
@@ -930,14 +969,14 @@ NetExpr* NetESFunc::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEUFunc::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				vector<LocalVar>&context) const
 {
       NetFuncDef*def = func_->func_def();
       ivl_assert(*this, def);
 
       vector<NetExpr*>args(parms_.size());
       for (unsigned idx = 0 ;  idx < parms_.size() ;  idx += 1)
-	    args[idx] = parms_[idx]->evaluate_function(loc, context_map);
+	    args[idx] = parms_[idx]->evaluate_function(loc, context);
 
       NetExpr*res = def->evaluate_function(*this, args);
       return res;
@@ -23,8 +23,10 @@
 # include  "netlist.h"
 # include  "netclass.h"
 # include  "netenum.h"
+# include  "netmisc.h"
 # include  <cstring>
 # include  <cstdlib>
+# include  <set>
 # include  <sstream>
 # include  "ivl_assert.h"
 
@@ -114,6 +116,9 @@ NetScope::NetScope(NetScope*up, const hname_t&n, NetScope::TYPE t, bool nest, bo
       is_cell_ = false;
       calls_stask_ = false;
       in_final_ = false;
+      parameter_signature_ = 0;
+      parameter_signature_done_ = false;
+      parameter_signature_shared_ = false;
 
       if (up) {
 	    assert(t!=CLASS);
@@ -459,6 +464,47 @@ perm_string NetScope::module_name() const
       return module_name_;
 }
 
+/*
+ * The signatures are kept here, so that each is only stored once, and
+ * scopes with the same signature get the same pointer.
+ */
+static set<string> parameter_signature_table;
+
+const string* NetScope::parameter_signature()
+{
+      if (parameter_signature_done_)
+	    return parameter_signature_;
+
+      parameter_signature_done_ = true;
+
+      ostringstream out;
+      out << module_name_ << ":";
+      for (map<perm_string,param_expr_t>::const_iterator cur = parameters.begin()
+		 ; cur != parameters.end() ; ++ cur ) {
+	    out << cur->first << "=";
+	    if (! const_value_signature(out, cur->second.val))
+		  return parameter_signature_;
+	    out << "[";
+	    if (! const_value_signature(out, cur->second.msb))
+		  return parameter_signature_;
+	    out << ":";
+	    if (! const_value_signature(out, cur->second.lsb))
+		  return parameter_signature_;
+	    out << "];";
+      }
+
+      pair<set<string>::iterator,bool> res
+	    = parameter_signature_table.insert(out.str());
+      parameter_signature_ = &*res.first;
+      parameter_signature_shared_ = ! res.second;
+      return parameter_signature_;
+}
+
+bool NetScope::parameter_signature_shared() const
+{
+      return parameter_signature_shared_;
+}
+
 void NetScope::set_num_ports(unsigned int num_ports)
 {
     assert(type_ == MODULE);
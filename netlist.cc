@@ -561,7 +561,7 @@ NetNet::NetNet(NetScope*s, perm_string n, Type t,
 	       const list<netrange_t>&unpacked, ivl_type_t use_net_type)
 : NetObj(s, n, calculate_count(unpacked)),
     type_(t), port_type_(NOT_A_PORT),
-    local_flag_(false), net_type_(use_net_type),
+    local_flag_(false), func_slot_(0), net_type_(use_net_type),
     discipline_(0), unpacked_dims_(unpacked.size()),
     eref_count_(0), lref_count_(0)
 {
@@ -592,7 +592,7 @@ NetNet::NetNet(NetScope*s, perm_string n, Type t,
 NetNet::NetNet(NetScope*s, perm_string n, Type t, netstruct_t*ty)
 : NetObj(s, n, 1),
     type_(t), port_type_(NOT_A_PORT),
-    local_flag_(false), net_type_(ty),
+    local_flag_(false), func_slot_(0), net_type_(ty),
     discipline_(0),
     eref_count_(0), lref_count_(0)
 {
@@ -607,7 +607,7 @@ NetNet::NetNet(NetScope*s, perm_string n, Type t, netstruct_t*ty)
 NetNet::NetNet(NetScope*s, perm_string n, Type t, netdarray_t*ty)
 : NetObj(s, n, 1),
     type_(t), port_type_(NOT_A_PORT),
-    local_flag_(false), net_type_(ty),
+    local_flag_(false), func_slot_(0), net_type_(ty),
     discipline_(0),
     eref_count_(0), lref_count_(0)
 {
@@ -619,7 +619,7 @@ NetNet::NetNet(NetScope*s, perm_string n, Type t, netdarray_t*ty)
 NetNet::NetNet(NetScope*s, perm_string n, Type t, netvector_t*ty)
 : NetObj(s, n, 1),
     type_(t), port_type_(NOT_A_PORT),
-    local_flag_(false), net_type_(ty),
+    local_flag_(false), func_slot_(0), net_type_(ty),
     discipline_(0),
     eref_count_(0), lref_count_(0)
 {
@@ -2038,6 +2038,9 @@ NetFuncDef::NetFuncDef(NetScope*s, NetNet*result, const vector<NetNet*>&po,
 
 NetFuncDef::~NetFuncDef()
 {
+      for (map<string,NetExpr*>::iterator cur = results_.begin()
+		 ; cur != results_.end() ; ++ cur )
+	    delete cur->second;
 }
 
 const NetNet* NetFuncDef::return_sig() const
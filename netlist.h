@@ -736,6 +736,12 @@ class NetNet  : public NetObj, public PortType {
       bool local_flag() const { return local_flag_; }
       void local_flag(bool f) { local_flag_ = f; }
 
+	// The slot of this variable in the context of a constant
+	// function evaluation. This is only meaningful for the
+	// variables of a function. (See LocalVar.)
+      unsigned func_slot() const { return func_slot_; }
+      void func_slot(unsigned slot) { func_slot_ = slot; }
+
 	// NetESignal objects may reference this object. Keep a
 	// reference count so that I keep track of them.
       void incr_eref();
@@ -771,6 +777,7 @@ class NetNet  : public NetObj, public PortType {
       Type   type_    : 5;
       PortType port_type_ : 3;
       bool local_flag_: 1;
+      unsigned func_slot_;
       ivl_type_t net_type_;
       ivl_discipline_t discipline_;
 
@@ -799,14 +806,17 @@ class NetNet  : public NetObj, public PortType {
 
 /*
  * This object type is used for holding local variable values when
- * evaluating constant user functions.
+ * evaluating constant user functions. The context of an evaluation
+ * is a vector of these, with a slot for each variable of the function
+ * and of the named blocks within it. The func_slot() of the NetNet
+ * is its index in the vector.
  */
 struct LocalVar {
-      int nwords;  // zero for a simple variable, -1 for reference
+      const NetNet*net; // The variable that has this slot
+      int nwords;  // zero for a simple variable
       union {
 	    NetExpr*  value;  // a simple variable
 	    NetExpr** array;  // an array variable
-	    LocalVar* ref;    // A reference to a previous scope
       };
 };
 
@@ -987,10 +997,13 @@ class NetScope : public Definitions, public Attrib {
       NetTaskDef* task_def();
       NetFuncDef* func_def();
 
-	// This is used by the evaluate_function setup to collect
-	// local variables from the scope.
+	// These are used by the evaluate_function setup. The first
+	// gives a context slot to each variable of this scope and
+	// of the scopes within it, and the second makes fresh the
+	// local (not port) variables of this scope in the context.
+      void evaluate_function_number_locals(vector<NetNet*>&locals) const;
       void evaluate_function_find_locals(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 vector<LocalVar>&ctx) const;
 
       void set_line(perm_string file, perm_string def_file,
                     unsigned lineno, unsigned def_lineno);
@@ -1048,6 +1061,17 @@ class NetScope : public Definitions, public Attrib {
 	/* If the scope represents a module instance, the module_name
 	   is the name of the module itself. */
       perm_string module_name() const;
+	/* The parameter_signature is a string of the values of the
+	   parameters of the scope. Scopes with the same parameter
+	   values have the same (pointer to the) signature, so things
+	   that only depend on the parameters can be elaborated once
+	   for all of them. It is nil if some parameter is not a
+	   simple constant. It is made the first time it is asked
+	   for, so only ask after the parameters are evaluated. The
+	   parameter_signature_shared method returns true if another
+	   scope asked for the same signature before this one. */
+      const std::string* parameter_signature();
+      bool parameter_signature_shared() const;
 	/* If the scope is a module then it may have ports that we need
 	 * to keep track of. */
 
@@ -1201,6 +1225,9 @@ class NetScope : public Definitions, public Attrib {
       typedef std::map<perm_string,NetNet*>::const_iterator signals_map_iter_t;
       std::map <perm_string,NetNet*> signals_map_;
       perm_string module_name_;
+      const std::string*parameter_signature_;
+      bool parameter_signature_done_;
+      bool parameter_signature_shared_;
       vector<NetNet*> port_nets;
 
       vector<PortInfo> ports_;
@@ -1933,7 +1960,7 @@ class NetExpr  : public LineInfo {
 	// allocated constant, or nil if the expression cannot be
 	// evaluated for any reason.
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					vector<LocalVar>&ctx) const;
 
 	// Get the Nexus that are the input to this
 	// expression. Normally this descends down to the reference to
@@ -2017,7 +2044,7 @@ class NetEConst  : public NetExpr {
       virtual NexusSet* nex_input(bool rem_out = true);
 
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					vector<LocalVar>&ctx) const;
 
     private:
       verinum value_;
@@ -2089,7 +2116,7 @@ class NetECReal  : public NetExpr {
       virtual NexusSet* nex_input(bool rem_out = true);
 
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					vector<LocalVar>&ctx) const;
 
     private:
       verireal value_;
@@ -2497,7 +2524,7 @@ class NetProc : public virtual LineInfo {
 	// identifiers to values. The function returns true if the
 	// processing succeeds, or false otherwise.
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
 	// This method is called by functors that want to scan a
 	// process in search of matchable patterns.
@@ -2746,10 +2773,10 @@ class NetAssign : public NetAssignBase {
       virtual int match_proc(struct proc_match_t*);
       virtual void dump(ostream&, unsigned ind) const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
-      bool eval_func_lval_(const LineInfo&loc, map<perm_string,LocalVar>&ctx,
+      bool eval_func_lval_(const LineInfo&loc, vector<LocalVar>&ctx,
 			   const NetAssign_*lval, NetExpr*rval_result) const;
 
       char op_;
@@ -2800,7 +2827,7 @@ class NetBlock  : public NetProc {
       const NetProc*proc_next(const NetProc*cur) const;
 
       bool evaluate_function(const LineInfo&loc,
-			     map<perm_string,LocalVar>&ctx) const;
+			     vector<LocalVar>&ctx) const;
 
 	// synthesize as asynchronous logic, and return true.
       bool synth_async(Design*des, NetScope*scope,
@@ -2869,13 +2896,13 @@ class NetCase  : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
       bool evaluate_function_vect_(const LineInfo&loc,
-				   map<perm_string,LocalVar>&ctx) const;
+				   vector<LocalVar>&ctx) const;
       bool evaluate_function_real_(const LineInfo&loc,
-				   map<perm_string,LocalVar>&ctx) const;
+				   vector<LocalVar>&ctx) const;
 
       TYPE type_;
 
@@ -2951,7 +2978,7 @@ class NetCondit  : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
       NetExpr* expr_;
@@ -3021,7 +3048,7 @@ class NetDisable  : public NetProc {
       virtual bool emit_proc(struct target_t*) const;
       virtual void dump(ostream&, unsigned ind) const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
       NetScope*target_;
@@ -3052,7 +3079,7 @@ class NetDoWhile  : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
       NetExpr* cond_;
@@ -3297,7 +3324,7 @@ class NetForever : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
       NetProc*statement_;
@@ -3350,6 +3377,14 @@ class NetFuncDef : public NetBaseDef {
 
     private:
       NetNet*result_sig_;
+
+	// The variables of the function, by context slot. This is
+	// filled in the first time that the function is evaluated.
+      mutable std::vector<NetNet*> locals_;
+	// The results of earlier evaluations, by the signature of the
+	// argument values. The function has no other inputs, so the
+	// same arguments always give the same result.
+      mutable std::map<std::string,NetExpr*> results_;
 };
 
 /*
@@ -3408,7 +3443,7 @@ class NetRepeat : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
       NetExpr*expr_;
@@ -3459,7 +3494,7 @@ class NetSTask  : public NetProc {
       virtual bool emit_proc(struct target_t*) const;
       virtual void dump(ostream&, unsigned ind) const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
       const char* name_;
@@ -3520,7 +3555,7 @@ class NetEUFunc  : public NetExpr {
       virtual NexusSet* nex_input(bool rem_out = true);
       virtual NetExpr* eval_tree();
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					vector<LocalVar>&ctx) const;
 
       virtual NetNet* synthesize(Design*des, NetScope*scope, NetExpr*root);
 
@@ -3606,7 +3641,7 @@ class NetWhile  : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     vector<LocalVar>&ctx) const;
 
     private:
       NetExpr* cond_;
@@ -3736,7 +3771,7 @@ class NetEBinary  : public NetExpr {
       virtual NetEBinary* dup_expr() const;
       virtual NetExpr* eval_tree();
       virtual NetExpr* evaluate_function(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 vector<LocalVar>&ctx) const;
       virtual NexusSet* nex_input(bool rem_out = true);
 
       virtual void expr_scan(struct expr_scan_t*) const;
@@ -3995,7 +4030,7 @@ class NetEConcat  : public NetExpr {
       virtual NetEConcat* dup_expr() const;
       virtual NetEConst*  eval_tree();
       virtual NetExpr* evaluate_function(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 vector<LocalVar>&ctx) const;
       virtual NetNet*synthesize(Design*, NetScope*scope, NetExpr*root);
       virtual void expr_scan(struct expr_scan_t*) const;
       virtual void dump(ostream&) const;
@@ -4043,7 +4078,7 @@ class NetESelect  : public NetExpr {
       virtual void expr_scan(struct expr_scan_t*) const;
       virtual NetEConst* eval_tree();
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					vector<LocalVar>&ctx) const;
       virtual NetESelect* dup_expr() const;
       virtual NetNet*synthesize(Design*des, NetScope*scope, NetExpr*root);
       virtual void dump(ostream&) const;
@@ -4213,7 +4248,7 @@ class NetESFunc  : public NetExpr {
 
       virtual NetExpr* eval_tree();
       virtual NetExpr* evaluate_function(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 vector<LocalVar>&ctx) const;
 
       virtual ivl_variable_type_t expr_type() const;
       virtual NexusSet* nex_input(bool rem_out = true);
@@ -4381,7 +4416,7 @@ class NetETernary  : public NetExpr {
       virtual NetETernary* dup_expr() const;
       virtual NetExpr* eval_tree();
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					vector<LocalVar>&ctx) const;
       virtual ivl_variable_type_t expr_type() const;
       virtual NexusSet* nex_input(bool rem_out = true);
       virtual void expr_scan(struct expr_scan_t*) const;
@@ -4434,7 +4469,7 @@ class NetEUnary  : public NetExpr {
       virtual NetEUnary* dup_expr() const;
       virtual NetExpr* eval_tree();
       virtual NetExpr* evaluate_function(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 vector<LocalVar>&ctx) const;
       virtual NetNet* synthesize(Design*, NetScope*scope, NetExpr*root);
 
       virtual ivl_variable_type_t expr_type() const;
@@ -4517,7 +4552,7 @@ class NetESignal  : public NetExpr {
       const netenum_t*enumeration() const;
 
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					vector<LocalVar>&ctx) const;
 
 	// This is the expression for selecting an array word, if this
 	// signal refers to an array.
@@ -4668,6 +4703,13 @@ class Design : public Definitions {
 	// Iterate over the design...
       void dump(ostream&) const;
       void functor(struct functor_t*);
+	// Mark a node so that the next functor_marked call applies
+	// the functor to it. Only the nodes that were marked before
+	// the call are visited, and nodes that are deleted before
+	// they are visited are skipped. The functor_marked method
+	// returns the number of nodes that it visited.
+      void mark_for_functor(NetNode*);
+      unsigned functor_marked(struct functor_t*);
       void join_islands(void);
       int emit(struct target_t*) const;
 
@@ -4689,6 +4731,11 @@ class Design : public Definitions {
 	// These are in support of the node functor iterator.
       NetNode*nodes_functor_cur_;
       NetNode*nodes_functor_nxt_;
+	// These are the nodes marked for the next functor_marked
+	// call, and the nodes that the current call has yet to visit.
+      std::list<NetNode*> functor_marked_list_;
+      std::set<NetNode*> functor_marked_;
+      std::set<NetNode*> functor_visit_;
 
 	// List the branches in the design.
       NetBranch*branches_;
@@ -25,6 +25,7 @@
 # include  "netmisc.h"
 # include  "PExpr.h"
 # include  "pform_types.h"
+# include  "pass_report.h"
 # include  "compiler.h"
 # include  "ivl_assert.h"
 
@@ -734,6 +735,7 @@ NetExpr* elab_and_eval(Design*des, NetScope*scope, PExpr*pe,
                        int context_width, bool need_const, bool annotatable,
                        ivl_variable_type_t cast_type)
 {
+      pass_report_t report ("expressions");
       PExpr::width_mode_t mode = PExpr::SIZED;
       if ((context_width == -2) && !gn_strict_expr_width_flag)
             mode = PExpr::EXPAND;
@@ -821,6 +823,7 @@ NetExpr* elab_and_eval(Design*des, NetScope*scope, PExpr*pe,
 NetExpr* elab_and_eval(Design*des, NetScope*scope, PExpr*pe,
 		       ivl_type_t lv_net_type, bool need_const)
 {
+      pass_report_t report ("expressions");
       if (debug_elaborate) {
 	    cerr << pe->get_fileline() << ": elab_and_eval: "
 		 << "pe=" << *pe
@@ -841,6 +844,7 @@ NetExpr* elab_and_eval(Design*des, NetScope*scope, PExpr*pe,
 NetExpr* elab_sys_task_arg(Design*des, NetScope*scope, perm_string name,
                            unsigned arg_idx, PExpr*pe, bool need_const)
 {
+      pass_report_t report ("expressions");
       PExpr::width_mode_t mode = PExpr::SIZED;
       pe->test_width(des, scope, mode);
 
@@ -1354,3 +1358,42 @@ void assign_unpacked_with_bufz(Design*des, NetScope*scope,
       }
 }
 
+bool const_value_signature(ostream&out, const NetExpr*expr)
+{
+      if (expr == 0) {
+	    out << "-";
+	    return true;
+      }
+
+      if (const NetEConst*val = dynamic_cast<const NetEConst*>(expr)) {
+	    const verinum&bits = val->value();
+	    out << bits.len() << (bits.has_sign()? "s" : "u")
+		<< (bits.is_string()? "t" : "");
+	    if (! bits.is_defined()) {
+		  out << "'";
+		  for (unsigned idx = bits.len() ; idx > 0 ; idx -= 1)
+			out << "01xz"[bits.get(idx-1)];
+		  return true;
+	    }
+
+	      // Defined values are written in hex, which keeps the
+	      // signatures short.
+	    out << "'h";
+	    for (unsigned idx = 0 ; idx < bits.len() ; idx += 4) {
+		  unsigned nibble = 0;
+		  for (unsigned bit = 0 ; bit < 4 && idx+bit < bits.len() ; bit += 1)
+			if (bits.get(idx+bit) == verinum::V1)
+			      nibble |= 1 << bit;
+		  out << "0123456789abcdef"[nibble];
+	    }
+	    return true;
+      }
+
+      if (const NetECReal*val = dynamic_cast<const NetECReal*>(expr)) {
+	    out.precision(17);
+	    out << "r'" << val->value().as_double();
+	    return true;
+      }
+
+      return false;
+}
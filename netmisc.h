@@ -353,4 +353,12 @@ extern void assign_unpacked_with_bufz(Design*des, NetScope*scope,
 				      const LineInfo*loc,
 				      NetNet*lval, NetNet*rval);
 
+/*
+ * Write a signature of the value of a constant expression (a NetEConst
+ * or NetECReal) to the stream. Constants with the same signature have
+ * the same value, width and type. A nil expression is written as
+ * "-". Return false if the expression is not a constant.
+ */
+extern bool const_value_signature(ostream&out, const NetExpr*expr);
+
 #endif
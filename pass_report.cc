@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2014 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include "config.h"
+
+# include  "pass_report.h"
+# include  <algorithm>
+# include  <list>
+# include  <map>
+# include  <string>
+# include  <vector>
+# include  <cstdio>
+# include  <cstring>
+# include  <ctime>
+# include  <sys/time.h>
+#if defined(HAVE_SYS_RESOURCE_H)
+# include  <sys/resource.h>
+#endif
+
+using namespace std;
+
+bool pass_report_flag = false;
+
+static string report_path;
+
+/*
+ * The phases form a tree. The root is the whole compile, and the
+ * children of each phase are kept in the order that they were first
+ * entered. The self time is exclusive of the nested phases and
+ * modules, and the total time is inclusive.
+ */
+struct phase_s {
+      const char*name;
+      phase_s*parent;
+      vector<phase_s*> children;
+      unsigned long calls;
+      unsigned long long self_ns;
+      unsigned long long total_ns;
+	// Number of times this phase is on the stack.
+      unsigned active;
+	// Peak resident set size (in KBytes) when the phase was last
+	// left, or -1 if it is not sampled.
+      long peak_rss;
+};
+
+/*
+ * The time of a module is kept apart for each of the phases (by name)
+ * that it was charged in.
+ */
+struct module_cost_s {
+      const char*phase;
+      unsigned long calls;
+      unsigned long long ns;
+};
+
+struct module_s {
+      perm_string name;
+      list<module_cost_s> costs;
+      unsigned long long total_ns;
+};
+
+struct report_frame_s {
+      phase_s*phase;
+      module_s*module;
+      module_cost_s*cost;
+      unsigned long long start;
+      unsigned long long enter;
+      bool phase_flag;
+};
+
+static phase_s root_phase;
+static map<perm_string,module_s> modules;
+static vector<report_frame_s> report_stack;
+static unsigned long long report_start;
+
+static unsigned long long report_clock(void)
+{
+#ifdef CLOCK_MONOTONIC
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      return tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#endif
+}
+
+static long report_peak_rss(void)
+{
+#if defined(HAVE_SYS_RESOURCE_H)
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) != 0)
+	    return -1;
+#  if defined(__APPLE__)
+	// Darwin reports the maximum resident set size in bytes.
+      return usage.ru_maxrss / 1024;
+#  else
+      return usage.ru_maxrss;
+#  endif
+#else
+      return -1;
+#endif
+}
+
+void pass_report_init(const char*path)
+{
+      report_path = path;
+      pass_report_flag = true;
+
+      root_phase.name = "compile";
+      root_phase.parent = 0;
+      root_phase.calls = 1;
+      root_phase.self_ns = 0;
+      root_phase.total_ns = 0;
+      root_phase.active = 1;
+      root_phase.peak_rss = -1;
+
+      report_start = report_clock();
+}
+
+/*
+ * Charge the time since the frame last started (or was charged) to it.
+ */
+static void charge_frame(report_frame_s&frame, unsigned long long now)
+{
+      unsigned long long delta = now - frame.start;
+      frame.phase->self_ns += delta;
+      if (frame.cost) {
+	    frame.cost->ns += delta;
+	    frame.module->total_ns += delta;
+      }
+      frame.start = now;
+}
+
+static module_cost_s* module_cost(module_s*module, const char*phase)
+{
+      for (list<module_cost_s>::iterator cur = module->costs.begin()
+		 ; cur != module->costs.end() ; ++ cur ) {
+	    if (cur->phase == phase || strcmp(cur->phase, phase) == 0)
+		  return &*cur;
+      }
+
+      module_cost_s tmp;
+      tmp.phase = phase;
+      tmp.calls = 0;
+      tmp.ns = 0;
+      module->costs.push_back(tmp);
+      return &module->costs.back();
+}
+
+static void push_frame(phase_s*phase, module_s*module, bool phase_flag,
+		       bool count_flag, unsigned long long now)
+{
+      report_frame_s frame;
+      frame.phase = phase;
+      frame.module = module;
+      frame.cost = module? module_cost(module, phase->name) : 0;
+      frame.start = now;
+      frame.enter = now;
+      frame.phase_flag = phase_flag;
+
+      if (frame.cost && count_flag)
+	    frame.cost->calls += 1;
+
+      report_stack.push_back(frame);
+}
+
+void pass_report_enter(const char*name)
+{
+      unsigned long long now = report_clock();
+
+      phase_s*parent = &root_phase;
+      module_s*module = 0;
+      if (! report_stack.empty()) {
+	    charge_frame(report_stack.back(), now);
+	    parent = report_stack.back().phase;
+	    module = report_stack.back().module;
+      }
+
+	// A phase that is entered again from within itself (for
+	// example an expression within an expression) stays the same
+	// phase, and is not counted again.
+      phase_s*phase = 0;
+      if (parent->name == name || strcmp(parent->name, name) == 0) {
+	    phase = parent;
+      } else {
+	    for (unsigned idx = 0 ; idx < parent->children.size() ; idx += 1) {
+		  phase_s*cur = parent->children[idx];
+		  if (cur->name == name || strcmp(cur->name, name) == 0) {
+			phase = cur;
+			break;
+		  }
+	    }
+      }
+
+      if (phase == 0) {
+	    phase = new phase_s;
+	    phase->name = name;
+	    phase->parent = parent;
+	    phase->calls = 0;
+	    phase->self_ns = 0;
+	    phase->total_ns = 0;
+	    phase->active = 0;
+	    phase->peak_rss = -1;
+	    parent->children.push_back(phase);
+      }
+
+      if (phase->active == 0)
+	    phase->calls += 1;
+      phase->active += 1;
+
+      push_frame(phase, module, true, phase != parent, now);
+}
+
+void pass_report_enter_module(perm_string name)
+{
+      unsigned long long now = report_clock();
+
+      phase_s*phase = &root_phase;
+      if (! report_stack.empty()) {
+	    charge_frame(report_stack.back(), now);
+	    phase = report_stack.back().phase;
+      }
+
+      module_s*module = &modules[name];
+      if (module->name.nil()) {
+	    module->name = name;
+	    module->total_ns = 0;
+      }
+
+      push_frame(phase, module, false, true, now);
+}
+
+void pass_report_leave(void)
+{
+      unsigned long long now = report_clock();
+
+      if (report_stack.empty())
+	    return;
+
+      report_frame_s frame = report_stack.back();
+      report_stack.pop_back();
+      charge_frame(frame, now);
+
+      if (frame.phase_flag) {
+	    frame.phase->active -= 1;
+	    if (frame.phase->active == 0)
+		  frame.phase->total_ns += now - frame.enter;
+
+	      // Sample the memory only at the end of the outer phases,
+	      // which are few. The inner phases are left far too often.
+	    if (report_stack.size() < 2)
+		  frame.phase->peak_rss = report_peak_rss();
+      }
+
+      if (! report_stack.empty())
+	    report_stack.back().start = now;
+}
+
+static void write_string(FILE*fd, const char*text)
+{
+      fputc('"', fd);
+      for (const char*cp = text ; *cp ; cp += 1) {
+	    unsigned char ch = *cp;
+	    if (ch == '"' || ch == '\\')
+		  fprintf(fd, "\\%c", ch);
+	    else if (ch < 0x20)
+		  fprintf(fd, "\\u%04x", ch);
+	    else
+		  fputc(ch, fd);
+      }
+      fputc('"', fd);
+}
+
+static void write_phase(FILE*fd, const phase_s*phase, unsigned indent)
+{
+      fprintf(fd, "%*s{\"name\": ", indent, "");
+      write_string(fd, phase->name);
+      fprintf(fd, ", \"calls\": %lu, \"seconds\": %.6f, \"self_seconds\": %.6f",
+	      phase->calls, phase->total_ns / 1e9, phase->self_ns / 1e9);
+      if (phase->peak_rss >= 0)
+	    fprintf(fd, ", \"peak_rss_kb\": %ld", phase->peak_rss);
+
+      if (phase->children.empty()) {
+	    fprintf(fd, "}");
+	    return;
+      }
+
+      fprintf(fd, ",\n%*s \"phases\": [\n", indent, "");
+      for (unsigned idx = 0 ; idx < phase->children.size() ; idx += 1) {
+	    write_phase(fd, phase->children[idx], indent+2);
+	    fprintf(fd, "%s\n", idx+1 < phase->children.size()? "," : "");
+      }
+      fprintf(fd, "%*s]}", indent, "");
+}
+
+static bool module_more_costly(const module_s*a, const module_s*b)
+{
+      return a->total_ns > b->total_ns;
+}
+
+static const unsigned report_module_count = 25;
+
+void pass_report_write(void)
+{
+      unsigned long long now = report_clock();
+
+	// Close any phases that are still open, so that their time is
+	// in the report.
+      while (! report_stack.empty())
+	    pass_report_leave();
+
+      root_phase.total_ns = now - report_start;
+      root_phase.self_ns = root_phase.total_ns;
+      for (unsigned idx = 0 ; idx < root_phase.children.size() ; idx += 1)
+	    root_phase.self_ns -= root_phase.children[idx]->total_ns;
+      root_phase.peak_rss = report_peak_rss();
+
+      FILE*fd = fopen(report_path.c_str(), "w");
+      if (fd == 0) {
+	    perror(report_path.c_str());
+	    return;
+      }
+
+      fprintf(fd, "{\n");
+      fprintf(fd, "  \"seconds\": %.6f,\n", root_phase.total_ns / 1e9);
+      if (root_phase.peak_rss >= 0)
+	    fprintf(fd, "  \"peak_rss_kb\": %ld,\n", root_phase.peak_rss);
+
+      fprintf(fd, "  \"phases\": [\n");
+      for (unsigned idx = 0 ; idx < root_phase.children.size() ; idx += 1) {
+	    write_phase(fd, root_phase.children[idx], 4);
+	    fprintf(fd, "%s\n", idx+1 < root_phase.children.size()? "," : "");
+      }
+      fprintf(fd, "  ],\n");
+
+	// The modules that cost the most, with their time split by
+	// the phases that it was spent in.
+      vector<module_s*> sorted;
+      sorted.reserve(modules.size());
+      for (map<perm_string,module_s>::iterator cur = modules.begin()
+		 ; cur != modules.end() ; ++ cur )
+	    sorted.push_back(&cur->second);
+      sort(sorted.begin(), sorted.end(), module_more_costly);
+      if (sorted.size() > report_module_count)
+	    sorted.resize(report_module_count);
+
+      fprintf(fd, "  \"module_count\": %lu,\n",
+	      (unsigned long)modules.size());
+      fprintf(fd, "  \"modules\": [\n");
+      for (unsigned idx = 0 ; idx < sorted.size() ; idx += 1) {
+	    const module_s*module = sorted[idx];
+	    fprintf(fd, "    {\"name\": ");
+	    write_string(fd, module->name.str());
+	    fprintf(fd, ", \"seconds\": %.6f, \"phases\": [",
+		    module->total_ns / 1e9);
+	    for (list<module_cost_s>::const_iterator cur = module->costs.begin()
+		       ; cur != module->costs.end() ; ++ cur ) {
+		  fprintf(fd, "%s\n      {\"name\": ",
+			  cur == module->costs.begin()? "" : ",");
+		  write_string(fd, cur->phase);
+		  fprintf(fd, ", \"calls\": %lu, \"seconds\": %.6f}",
+			  cur->calls, cur->ns / 1e9);
+	    }
+	    fprintf(fd, "]}%s\n", idx+1 < sorted.size()? "," : "");
+      }
+      fprintf(fd, "  ]\n");
+      fprintf(fd, "}\n");
+
+      fclose(fd);
+}
@@ -0,0 +1,79 @@
+#ifndef __pass_report_H
+#define __pass_report_H
+/*
+ * Copyright (c) 2014 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "StringHeap.h"
+
+/*
+ * The pass report charges the run time of the compiler to the phases
+ * (parsing, the passes of elaboration, the functors, code generation)
+ * and to the modules that are being elaborated, and writes the result
+ * to a JSON file. It is turned on by the PASS_REPORT flag, which
+ * names the file (-pPASS_REPORT=<file> to the driver).
+ *
+ * Phases nest: a phase entered while another is running is a child
+ * of it, so for example the expressions elaborated while elaborating
+ * signals are kept apart from the expressions elaborated while
+ * elaborating the netlist. The time is exclusive: while a nested
+ * phase or module runs, the outer one is not charged.
+ *
+ * The pass_report_flag is true if the report was requested. The other
+ * functions must only be called if it is set.
+ */
+extern bool pass_report_flag;
+
+extern void pass_report_init(const char*path);
+
+/*
+ * Start charging time to the named phase, nested in the current
+ * phase, or to the named module within the current phase. The phase
+ * name must be a string constant. The pass_report_leave function
+ * stops charging the most recently entered phase or module.
+ */
+extern void pass_report_enter(const char*phase);
+extern void pass_report_enter_module(perm_string name);
+extern void pass_report_leave(void);
+
+/*
+ * Write the report file.
+ */
+extern void pass_report_write(void);
+
+/*
+ * This charges the time of the enclosing C++ block to a phase or to a
+ * module. It is for functions that have many ways out.
+ */
+class pass_report_t {
+    public:
+      explicit pass_report_t(const char*phase)
+      : flag_(pass_report_flag) { if (flag_) pass_report_enter(phase); }
+      explicit pass_report_t(perm_string module)
+      : flag_(pass_report_flag) { if (flag_) pass_report_enter_module(module); }
+      ~pass_report_t() { if (flag_) pass_report_leave(); }
+
+    private:
+      bool flag_;
+
+    private: // not implemented
+      pass_report_t(const pass_report_t&);
+      pass_report_t& operator= (const pass_report_t&);
+};
+
+#endif
@@ -1669,13 +1669,13 @@ extern "C" void ivl_nexus_set_private(ivl_nexus_t net, void*data)
 extern "C" unsigned ivl_nexus_ptrs(ivl_nexus_t net)
 {
       assert(net);
-      return net->ptrs_.size();
+      return net->nptr_;
 }
 
 extern "C" ivl_nexus_ptr_t ivl_nexus_ptr(ivl_nexus_t net, unsigned idx)
 {
       assert(net);
-      assert(idx < net->ptrs_.size());
+      assert(idx < net->nptr_);
       return & net->ptrs_[idx];
 }
 
@@ -1994,13 +1994,13 @@ extern "C" ivl_enumtype_t ivl_scope_enumerate(ivl_scope_t net, unsigned idx)
 extern "C" unsigned ivl_scope_events(ivl_scope_t net)
 {
       assert(net);
-      return net->nevent_;
+      return net->event_.size();
 }
 
 extern "C" ivl_event_t ivl_scope_event(ivl_scope_t net, unsigned idx)
 {
       assert(net);
-      assert(idx < net->nevent_);
+      assert(idx < net->event_.size());
       return net->event_[idx];
 }
 
@@ -2031,26 +2031,26 @@ extern "C" unsigned ivl_scope_lineno(ivl_scope_t net)
 extern "C" unsigned ivl_scope_logs(ivl_scope_t net)
 {
       assert(net);
-      return net->nlog_;
+      return net->log_.size();
 }
 
 extern "C" ivl_net_logic_t ivl_scope_log(ivl_scope_t net, unsigned idx)
 {
       assert(net);
-      assert(idx < net->nlog_);
+      assert(idx < net->log_.size());
       return net->log_[idx];
 }
 
 extern "C" unsigned ivl_scope_lpms(ivl_scope_t net)
 {
       assert(net);
-      return net->nlpm_;
+      return net->lpm_.size();
 }
 
 extern "C" ivl_lpm_t ivl_scope_lpm(ivl_scope_t net, unsigned idx)
 {
       assert(net);
-      assert(idx < net->nlpm_);
+      assert(idx < net->lpm_.size());
       return net->lpm_[idx];
 }
 
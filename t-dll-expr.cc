@@ -417,7 +417,7 @@ void dll_target::expr_event(const NetEEvent*net)
       const NetEvent*ev = net->event();
       ivl_scope_t ev_scope = lookup_scope_(ev->scope());
 
-      for (unsigned idx = 0 ;  idx < ev_scope->nevent_ ;  idx += 1) {
+      for (unsigned idx = 0 ;  idx < ev_scope->event_.size() ;  idx += 1) {
             const char*ename = ivl_event_basename(ev_scope->event_[idx]);
             if (strcmp(ev->name(), ename) == 0) {
                   expr_->u_.event_.event = ev_scope->event_[idx];
@@ -342,8 +342,8 @@ void dll_target::proc_assign_nb(const NetAssignNB*net)
 		  ivl_event_t ev_tmp=0;
 
 		  assert(ev_scope);
-		  assert(ev_scope->nevent_ > 0);
-		  for (unsigned idx = 0;  idx < ev_scope->nevent_; idx += 1) {
+		  assert(! ev_scope->event_.empty());
+		  for (unsigned idx = 0;  idx < ev_scope->event_.size(); idx += 1) {
 			const char*ename =
 			      ivl_event_basename(ev_scope->event_[idx]);
 			if (strcmp(ev->name(), ename) == 0) {
@@ -807,7 +807,7 @@ bool dll_target::proc_trigger(const NetEvTrig*net)
       const NetEvent*ev = net->event();
       ivl_scope_t ev_scope = lookup_scope_(ev->scope());
 
-      for (unsigned idx = 0 ;  idx < ev_scope->nevent_ ;  idx += 1) {
+      for (unsigned idx = 0 ;  idx < ev_scope->event_.size() ;  idx += 1) {
 	    const char*ename = ivl_event_basename(ev_scope->event_[idx]);
 	    if (strcmp(ev->name(), ename) == 0) {
 		  stmt_cur_->u_.wait_.event = ev_scope->event_[idx];
@@ -864,8 +864,8 @@ bool dll_target::proc_wait(const NetEvWait*net)
 	    ivl_event_t ev_tmp=0;
 
 	    assert(ev_scope);
-	    assert(ev_scope->nevent_ > 0);
-	    for (unsigned idx = 0 ;  idx < ev_scope->nevent_ ;  idx += 1) {
+	    assert(! ev_scope->event_.empty());
+	    for (unsigned idx = 0 ;  idx < ev_scope->event_.size() ;  idx += 1) {
 		  const char*ename = ivl_event_basename(ev_scope->event_[idx]);
 		  if (strcmp(ev->name(), ename) == 0) {
 			ev_tmp = ev_scope->event_[idx];
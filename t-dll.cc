@@ -22,6 +22,7 @@
 
 # include  <iostream>
 
+# include  <algorithm>
 # include  <cstring>
 # include  <cstdio> // sprintf()
 # include  "compiler.h"
@@ -129,9 +130,25 @@ template <class TYPE> void* pool_permalloc(size_t s)
       return tmp;
 }
 
+/*
+ * The ivl_nexus_s objects have a pool of their own, so that the
+ * nexus_compact function below can find all of them.
+ */
+static const unsigned NEXUS_POOL_SIZE = 4096;
+static vector<ivl_nexus_s*> nexus_pool;
+static unsigned nexus_pool_used = NEXUS_POOL_SIZE;
+
 void* ivl_nexus_s::operator new(size_t s)
 {
-      return pool_permalloc<struct ivl_nexus_s>(s);
+      assert(s == sizeof(ivl_nexus_s));
+      if (nexus_pool_used == NEXUS_POOL_SIZE) {
+	    nexus_pool.push_back(new ivl_nexus_s[NEXUS_POOL_SIZE]);
+	    nexus_pool_used = 0;
+      }
+
+      ivl_nexus_s*tmp = nexus_pool.back() + nexus_pool_used;
+      nexus_pool_used += 1;
+      return tmp;
 }
 
 void ivl_nexus_s::operator delete(void*, size_t)
@@ -310,10 +327,62 @@ ivl_signal_t dll_target::find_signal(ivl_design_s &des, const NetNet*net)
       return 0;
 }
 
+/*
+ * Make room for one more pointer in the nexus, and return its index.
+ * The array doubles when it is full, so that a nexus with many pins
+ * (a clock or a reset in a flat netlist) is built in linear time.
+ */
+static unsigned nexus_ptr_new(ivl_nexus_t nex)
+{
+      assert(nex->nptr_ == 0 || nex->mptr_ > 0);
+      if (nex->nptr_ == nex->mptr_) {
+	    nex->mptr_ = nex->mptr_? 2*nex->mptr_ : 2;
+	    nex->ptrs_ = (ivl_nexus_ptr_s*)
+		  realloc(nex->ptrs_, nex->mptr_*sizeof(ivl_nexus_ptr_s));
+      }
+      return nex->nptr_++;
+}
+
+/*
+ * Move the ptrs_ arrays of all the nexus objects into pooled blocks,
+ * each sized exactly. This drops the unused tail that the doubling
+ * leaves in each array, and the malloc overhead of each, before the
+ * target gets the design. No more pointers can be added after this.
+ */
+static void nexus_compact(void)
+{
+      static const unsigned PTR_POOL_SIZE = 4096;
+      ivl_nexus_ptr_s*pool = 0;
+      unsigned pool_remaining = 0;
+
+      for (unsigned blk = 0 ; blk < nexus_pool.size() ; blk += 1) {
+	    unsigned count = blk+1 < nexus_pool.size()
+		  ? NEXUS_POOL_SIZE : nexus_pool_used;
+	    for (unsigned idx = 0 ; idx < count ; idx += 1) {
+		  ivl_nexus_t nex = nexus_pool[blk] + idx;
+		  if (nex->mptr_ == 0)
+			continue;
+
+		  if (nex->nptr_ > pool_remaining) {
+			pool_remaining = max(nex->nptr_, PTR_POOL_SIZE);
+			pool = (ivl_nexus_ptr_s*)
+			      malloc(pool_remaining*sizeof(ivl_nexus_ptr_s));
+		  }
+
+		  memcpy(pool, nex->ptrs_, nex->nptr_*sizeof(ivl_nexus_ptr_s));
+		  free(nex->ptrs_);
+		  nex->ptrs_ = pool;
+		  nex->mptr_ = 0;
+		  pool += nex->nptr_;
+		  pool_remaining -= nex->nptr_;
+	    }
+      }
+}
+
 static ivl_nexus_t nexus_sig_make(ivl_signal_t net, unsigned pin)
 {
       ivl_nexus_t tmp = new struct ivl_nexus_s;
-      tmp->ptrs_.resize(1);
+      nexus_ptr_new(tmp);
       tmp->ptrs_[0].pin_   = pin;
       tmp->ptrs_[0].type_  = __NEXUS_PTR_SIG;
       tmp->ptrs_[0].l.sig  = net;
@@ -334,8 +403,7 @@ static ivl_nexus_t nexus_sig_make(ivl_signal_t net, unsigned pin)
 
 static void nexus_sig_add(ivl_nexus_t nex, ivl_signal_t net, unsigned pin)
 {
-      unsigned top = nex->ptrs_.size();
-      nex->ptrs_.resize(top+1);
+      unsigned top = nexus_ptr_new(nex);
       ivl_drive_t drive = IVL_DR_HiZ;
       switch (ivl_signal_type(net)) {
 	  case IVL_SIT_REG:
@@ -354,8 +422,7 @@ static void nexus_sig_add(ivl_nexus_t nex, ivl_signal_t net, unsigned pin)
 
 static void nexus_bra_add(ivl_nexus_t nex, ivl_branch_t net, unsigned pin)
 {
-      unsigned top = nex->ptrs_.size();
-      nex->ptrs_.resize(top+1);
+      unsigned top = nexus_ptr_new(nex);
       nex->ptrs_[top].type_= __NEXUS_PTR_BRA;
       nex->ptrs_[top].drive0 = 0;
       nex->ptrs_[top].drive1 = 0;
@@ -374,8 +441,7 @@ static ivl_nexus_ptr_t nexus_log_add(ivl_nexus_t nex,
 				     ivl_net_logic_t net,
 				     unsigned pin)
 {
-      unsigned top = nex->ptrs_.size();
-      nex->ptrs_.resize(top+1);
+      unsigned top = nexus_ptr_new(nex);
 
       nex->ptrs_[top].type_= __NEXUS_PTR_LOG;
       nex->ptrs_[top].drive0 = (pin == 0)? IVL_DR_STRONG : IVL_DR_HiZ;
@@ -389,8 +455,7 @@ static ivl_nexus_ptr_t nexus_log_add(ivl_nexus_t nex,
 static void nexus_con_add(ivl_nexus_t nex, ivl_net_const_t net, unsigned pin,
 			  ivl_drive_t drive0, ivl_drive_t drive1)
 {
-      unsigned top = nex->ptrs_.size();
-      nex->ptrs_.resize(top+1);
+      unsigned top = nexus_ptr_new(nex);
 
       nex->ptrs_[top].type_= __NEXUS_PTR_CON;
       nex->ptrs_[top].drive0 = drive0;
@@ -402,8 +467,7 @@ static void nexus_con_add(ivl_nexus_t nex, ivl_net_const_t net, unsigned pin,
 static void nexus_lpm_add(ivl_nexus_t nex, ivl_lpm_t net, unsigned pin,
 			  ivl_drive_t drive0, ivl_drive_t drive1)
 {
-      unsigned top = nex->ptrs_.size();
-      nex->ptrs_.resize(top+1);
+      unsigned top = nexus_ptr_new(nex);
 
       nex->ptrs_[top].type_= __NEXUS_PTR_LPM;
       nex->ptrs_[top].drive0 = drive0;
@@ -414,8 +478,7 @@ static void nexus_lpm_add(ivl_nexus_t nex, ivl_lpm_t net, unsigned pin,
 
 static void nexus_switch_add(ivl_nexus_t nex, ivl_switch_t net, unsigned pin)
 {
-      unsigned top = nex->ptrs_.size();
-      nex->ptrs_.resize(top+1);
+      unsigned top = nexus_ptr_new(nex);
 
       nex->ptrs_[top].type_= __NEXUS_PTR_SWI;
       nex->ptrs_[top].drive0 = IVL_DR_HiZ;
@@ -426,52 +489,17 @@ static void nexus_switch_add(ivl_nexus_t nex, ivl_switch_t net, unsigned pin)
 
 void scope_add_logic(ivl_scope_t scope, ivl_net_logic_t net)
 {
-      if (scope->nlog_ == 0) {
-	    scope->nlog_ = 1;
-	    scope->log_ = (ivl_net_logic_t*)malloc(sizeof(ivl_net_logic_t));
-	    scope->log_[0] = net;
-
-      } else {
-	    scope->nlog_ += 1;
-	    scope->log_ = (ivl_net_logic_t*)
-		  realloc(scope->log_, scope->nlog_*sizeof(ivl_net_logic_t));
-	    scope->log_[scope->nlog_-1] = net;
-      }
-
+      scope->log_.push_back(net);
 }
 
 void scope_add_event(ivl_scope_t scope, ivl_event_t net)
 {
-      if (scope->nevent_ == 0) {
-	    scope->nevent_ = 1;
-	    scope->event_ = (ivl_event_t*)malloc(sizeof(ivl_event_t));
-	    scope->event_[0] = net;
-
-      } else {
-	    scope->nevent_ += 1;
-	    scope->event_ = (ivl_event_t*)
-		  realloc(scope->event_, scope->nevent_*sizeof(ivl_event_t));
-	    scope->event_[scope->nevent_-1] = net;
-      }
-
+      scope->event_.push_back(net);
 }
 
 static void scope_add_lpm(ivl_scope_t scope, ivl_lpm_t net)
 {
-      if (scope->nlpm_ == 0) {
-	    assert(scope->lpm_ == 0);
-	    scope->nlpm_ = 1;
-	    scope->lpm_ = (ivl_lpm_t*)malloc(sizeof(ivl_lpm_t));
-	    scope->lpm_[0] = net;
-
-      } else {
-	    assert(scope->lpm_);
-	    scope->nlpm_ += 1;
-	    scope->lpm_   = (ivl_lpm_t*)
-		  realloc(scope->lpm_,
-			  scope->nlpm_*sizeof(ivl_lpm_t));
-	    scope->lpm_[scope->nlpm_-1] = net;
-      }
+      scope->lpm_.push_back(net);
 }
 
 static void scope_add_switch(ivl_scope_t scope, ivl_switch_t net)
@@ -597,12 +625,6 @@ void dll_target::add_root(const NetScope *s)
       root_->name_ = name;
       FILE_NAME(root_, s);
       root_->parent = 0;
-      root_->nlog_ = 0;
-      root_->log_ = 0;
-      root_->nevent_ = 0;
-      root_->event_ = 0;
-      root_->nlpm_ = 0;
-      root_->lpm_ = 0;
       root_->def = 0;
       make_scope_parameters(root_, s);
       switch (s->type()) {
@@ -725,6 +747,7 @@ int dll_target::end_design(const Design*)
 		  cout << " ... invoking target_design" << endl;
 	    }
 
+	    nexus_compact();
 	    rc = (target_)(&des_);
       } else {
 	    if (verbose_flag) {
@@ -1234,8 +1257,8 @@ ivl_event_t dll_target::make_lpm_trigger(const NetEvWait*net)
             ivl_scope_t ev_scope = lookup_scope_(ev->scope());
 
             assert(ev_scope);
-            assert(ev_scope->nevent_ > 0);
-            for (unsigned idx = 0;  idx < ev_scope->nevent_; idx += 1) {
+            assert(! ev_scope->event_.empty());
+            for (unsigned idx = 0;  idx < ev_scope->event_.size(); idx += 1) {
                   const char*ename =
                         ivl_event_basename(ev_scope->event_[idx]);
                   if (strcmp(ev->name(), ename) == 0) {
@@ -2380,12 +2403,6 @@ void dll_target::scope(const NetScope*net)
 	    assert(scop->parent);
 	    scop->parent->children[net->fullname()] = scop;
 	    scop->parent->child .push_back(scop);
-	    scop->nlog_ = 0;
-	    scop->log_ = 0;
-	    scop->nevent_ = 0;
-	    scop->event_ = 0;
-	    scop->nlpm_ = 0;
-	    scop->lpm_ = 0;
 	    scop->def = 0;
 	    make_scope_parameters(scop, net);
 	    scop->time_precision = net->time_precision();
@@ -591,10 +591,18 @@ struct ivl_nexus_ptr_s {
 
 /*
  * NOTE: ONLY allocate ivl_nexus_s objects with the included "new" operator.
+ *
+ * The ptrs_ array is malloced and grows by doubling while the design
+ * is scanned. Before the target is called, the arrays of all the
+ * nexus objects are compacted into a single pool, and then mptr_ is
+ * 0 and no more pointers can be added.
  */
 struct ivl_nexus_s {
-      ivl_nexus_s() : ptrs_(1), nexus_(0), name_(0), private_data(0) { }
-      vector<ivl_nexus_ptr_s>ptrs_;
+      ivl_nexus_s() : ptrs_(0), nptr_(0), mptr_(0),
+		      nexus_(0), name_(0), private_data(0) { }
+      ivl_nexus_ptr_s*ptrs_;
+      unsigned nptr_;
+      unsigned mptr_;
       const Nexus*nexus_;
       const char*name_;
       void*private_data;
@@ -663,14 +671,9 @@ struct ivl_scope_s {
 
       std::vector<ivl_signal_t> sigs_;
 
-      unsigned nlog_;
-      ivl_net_logic_t*log_;
-
-      unsigned nevent_;
-      ivl_event_t* event_;
-
-      unsigned nlpm_;
-      ivl_lpm_t* lpm_;
+      std::vector<ivl_net_logic_t> log_;
+      std::vector<ivl_event_t> event_;
+      std::vector<ivl_lpm_t> lpm_;
 
       std::vector<struct ivl_parameter_s> param;
 
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2014 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "vvp_priv.h"
+# include  <string.h>
+# include  <stdlib.h>
+# include  <ctype.h>
+# include  <assert.h>
+# include  "ivl_alloc.h"
+
+/*
+ * This is a peephole pass over the generated code. It replaces some
+ * common sequences of instructions with the fused instructions of
+ * vvp (see vvp/opcodes.txt), which run a whole sequence with a single
+ * dispatch. The code generator writes the instructions one statement
+ * per line, and any line that is not an instruction (a label, for
+ * example) ends a sequence, so no sequence is fused if anything may
+ * jump into the middle of it.
+ *
+ * Each pattern lists the instructions of the sequence, and for each
+ * operand of each instruction, the position of that operand in the
+ * fused instruction. Operands that share a position must be the same
+ * for the pattern to match. The patterns with longer sequences come
+ * first, so that they are preferred.
+ */
+# define PEEP_PARTS 3
+# define PEEP_ARGS 3
+# define PEEP_FUSED_ARGS 6
+
+struct peep_pattern_s {
+      const char*fused;
+      unsigned argc;
+      unsigned nparts;
+      const char*part[PEEP_PARTS];
+      unsigned part_argc[PEEP_PARTS];
+      unsigned char argv[PEEP_PARTS][PEEP_ARGS];
+};
+
+static const struct peep_pattern_s peep_patterns[] = {
+      { "%load/cmpi/s/jmp/0xz", 6, 3,
+	{ "%load/v", "%cmpi/s", "%jmp/0xz" }, { 3, 3, 2 },
+	{ {0,1,2}, {0,3,2}, {4,5} } },
+      { "%load/cmpi/u/jmp/0xz", 6, 3,
+	{ "%load/v", "%cmpi/u", "%jmp/0xz" }, { 3, 3, 2 },
+	{ {0,1,2}, {0,3,2}, {4,5} } },
+      { "%load/addi/set/v", 5, 3,
+	{ "%load/v", "%addi", "%set/v" }, { 3, 3, 3 },
+	{ {0,1,2}, {0,3,2}, {4,0,2} } },
+      { "%cmp/s/jmp/0xz", 5, 2,
+	{ "%cmp/s", "%jmp/0xz" }, { 3, 2 },
+	{ {0,1,2}, {3,4} } },
+      { "%cmp/u/jmp/0xz", 5, 2,
+	{ "%cmp/u", "%jmp/0xz" }, { 3, 2 },
+	{ {0,1,2}, {3,4} } },
+      { "%cmpi/s/jmp/0xz", 5, 2,
+	{ "%cmpi/s", "%jmp/0xz" }, { 3, 2 },
+	{ {0,1,2}, {3,4} } },
+      { "%cmpi/u/jmp/0xz", 5, 2,
+	{ "%cmpi/u", "%jmp/0xz" }, { 3, 2 },
+	{ {0,1,2}, {3,4} } },
+      { "%load/vp0/set/v", 4, 2,
+	{ "%load/vp0", "%set/v" }, { 3, 3 },
+	{ {0,1,2}, {3,0,2} } },
+      { "%load/vp0/s/set/v", 4, 2,
+	{ "%load/vp0/s", "%set/v" }, { 3, 3 },
+	{ {0,1,2}, {3,0,2} } },
+      { "%ix/get/load/av", 6, 2,
+	{ "%ix/get", "%load/av" }, { 3, 3 },
+	{ {0,1,2}, {3,4,5} } },
+      { "%ix/get/s/load/av", 6, 2,
+	{ "%ix/get/s", "%load/av" }, { 3, 3 },
+	{ {0,1,2}, {3,4,5} } },
+      { "%ix/getv/load/av", 5, 2,
+	{ "%ix/getv", "%load/av" }, { 2, 3 },
+	{ {0,1}, {2,3,4} } },
+      { "%ix/getv/s/load/av", 5, 2,
+	{ "%ix/getv/s", "%load/av" }, { 2, 3 },
+	{ {0,1}, {2,3,4} } },
+      { 0, 0, 0, { 0 }, { 0 }, { { 0 } } }
+};
+
+/*
+ * A pending instruction keeps the line as it was written, and a copy
+ * that is cut up into the mnemonic and the operands.
+ */
+struct peep_instr_s {
+      char*line;
+      size_t line_size;
+      char*text;
+      size_t text_size;
+      const char*mnem;
+      unsigned argc;
+      const char*argv[PEEP_ARGS];
+};
+
+static struct peep_instr_s peep_pending[PEEP_PARTS];
+static unsigned peep_count = 0;
+static struct peep_instr_s peep_next;
+
+static char*peep_trim(char*cp)
+{
+      char*end;
+      while (isspace((unsigned char)*cp))
+	    cp += 1;
+      end = cp + strlen(cp);
+      while (end > cp && isspace((unsigned char)end[-1]))
+	    end -= 1;
+      *end = 0;
+      return cp;
+}
+
+/*
+ * Cut the line of the instruction into its mnemonic and operands.
+ * Return false if the line is not an instruction that can be part of
+ * a fused sequence.
+ */
+static int peep_parse(struct peep_instr_s*ins)
+{
+      const char*cp = ins->line;
+      const char*end;
+      char*tp;
+      size_t len;
+
+      if (! isspace((unsigned char)*cp))
+	    return 0;
+      while (isspace((unsigned char)*cp))
+	    cp += 1;
+      if (*cp != '%')
+	    return 0;
+      if (strchr(cp, '"'))
+	    return 0;
+      end = strchr(cp, ';');
+      if (end == 0)
+	    return 0;
+
+      len = end - cp;
+      if (ins->text_size < len+1) {
+	    ins->text_size = len+1;
+	    ins->text = realloc(ins->text, ins->text_size);
+      }
+      memcpy(ins->text, cp, len);
+      ins->text[len] = 0;
+
+      tp = ins->text;
+      while (*tp && ! isspace((unsigned char)*tp))
+	    tp += 1;
+      ins->mnem = ins->text;
+      ins->argc = 0;
+      if (*tp == 0)
+	    return 1;
+      *tp++ = 0;
+
+      tp = peep_trim(tp);
+      while (*tp) {
+	    char*comma = strchr(tp, ',');
+	    if (ins->argc == PEEP_ARGS)
+		  return 0;
+	    if (comma)
+		  *comma = 0;
+	    ins->argv[ins->argc++] = peep_trim(tp);
+	    if (comma == 0)
+		  break;
+	    tp = comma + 1;
+      }
+
+      return 1;
+}
+
+/*
+ * Try to match the pattern to the pending instructions, and if it
+ * matches, write the fused instruction.
+ */
+static int peep_match(const struct peep_pattern_s*pat, FILE*out)
+{
+      const char*args[PEEP_FUSED_ARGS];
+      unsigned pdx, idx;
+
+      if (pat->nparts > peep_count)
+	    return 0;
+
+      for (idx = 0 ; idx < pat->argc ; idx += 1)
+	    args[idx] = 0;
+
+      for (pdx = 0 ; pdx < pat->nparts ; pdx += 1) {
+	    const struct peep_instr_s*ins = peep_pending + pdx;
+	    if (strcmp(ins->mnem, pat->part[pdx]) != 0)
+		  return 0;
+	    if (ins->argc != pat->part_argc[pdx])
+		  return 0;
+
+	    for (idx = 0 ; idx < ins->argc ; idx += 1) {
+		  unsigned pos = pat->argv[pdx][idx];
+		  assert(pos < pat->argc);
+		  if (args[pos] == 0)
+			args[pos] = ins->argv[idx];
+		  else if (strcmp(args[pos], ins->argv[idx]) != 0)
+			return 0;
+	    }
+      }
+
+      fprintf(out, "    %s ", pat->fused);
+      for (idx = 0 ; idx < pat->argc ; idx += 1) {
+	    assert(args[idx]);
+	    fprintf(out, "%s%s", idx? ", " : "", args[idx]);
+      }
+      fprintf(out, ";\n");
+      return 1;
+}
+
+/*
+ * Write out the first pending instruction, or the fused instruction
+ * of a sequence that starts with it, and drop what was written from
+ * the pending list.
+ */
+static void peep_reduce(FILE*out)
+{
+      unsigned used = 1;
+      unsigned idx;
+
+      for (idx = 0 ; peep_patterns[idx].fused ; idx += 1) {
+	    if (peep_match(peep_patterns+idx, out)) {
+		  used = peep_patterns[idx].nparts;
+		  break;
+	    }
+      }
+
+      if (peep_patterns[idx].fused == 0)
+	    fputs(peep_pending[0].line, out);
+
+	/* Rotate the written entries to the end, so that their
+	   buffers are used again. */
+      while (used > 0) {
+	    struct peep_instr_s tmp = peep_pending[0];
+	    for (idx = 1 ; idx < PEEP_PARTS ; idx += 1)
+		  peep_pending[idx-1] = peep_pending[idx];
+	    peep_pending[PEEP_PARTS-1] = tmp;
+	    peep_count -= 1;
+	    used -= 1;
+      }
+}
+
+/*
+ * Read a line of any length into the buffer of the instruction.
+ * Return false at the end of the file.
+ */
+static int peep_read_line(struct peep_instr_s*ins, FILE*in)
+{
+      size_t len = 0;
+
+      if (ins->line_size == 0) {
+	    ins->line_size = 256;
+	    ins->line = malloc(ins->line_size);
+      }
+
+      for (;;) {
+	    if (fgets(ins->line+len, ins->line_size-len, in) == 0)
+		  return len > 0;
+
+	    len += strlen(ins->line+len);
+	    if (len > 0 && ins->line[len-1] == '\n')
+		  return 1;
+
+	    ins->line_size *= 2;
+	    ins->line = realloc(ins->line, ins->line_size);
+      }
+}
+
+void vvp_peephole(FILE*in, FILE*out)
+{
+      unsigned idx;
+
+      while (peep_read_line(&peep_next, in)) {
+
+	    if (peep_parse(&peep_next)) {
+		  struct peep_instr_s tmp = peep_pending[peep_count];
+		  peep_pending[peep_count] = peep_next;
+		  peep_next = tmp;
+		  peep_count += 1;
+		  if (peep_count == PEEP_PARTS)
+			peep_reduce(out);
+		  continue;
+	    }
+
+	      /* Anything else ends the sequence. */
+	    while (peep_count > 0)
+		  peep_reduce(out);
+	    fputs(peep_next.line, out);
+      }
+
+      while (peep_count > 0)
+	    peep_reduce(out);
+
+      for (idx = 0 ; idx < PEEP_PARTS ; idx += 1) {
+	    free(peep_pending[idx].line);
+	    free(peep_pending[idx].text);
+      }
+      free(peep_next.line);
+      free(peep_next.text);
+      memset(peep_pending, 0, sizeof peep_pending);
+      memset(&peep_next, 0, sizeof peep_next);
+}
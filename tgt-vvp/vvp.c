@@ -99,6 +99,9 @@ int target_design(ivl_design_t des)
 	 * printed for procedural statements. (e.g. -pfileline=1).
 	 * The default is no file/line information will be included. */
       const char*fileline = ivl_design_flag(des, "fileline");
+	/* Use -pfuse=0 to turn off the fused instructions. */
+      const char*fuse = ivl_design_flag(des, "fuse");
+      FILE*fused_out = 0;
 
       assert(path);
 
@@ -142,6 +145,17 @@ int target_design(ivl_design_t des)
 
       draw_execute_header(des);
 
+	/* The rest of the code is written to a temporary file first,
+	   so that the peephole pass can copy it to the output. */
+      if (strcmp(fuse, "0") != 0) {
+	    fused_out = vvp_out;
+	    vvp_out = tmpfile();
+	    if (vvp_out == 0) {
+		  vvp_out = fused_out;
+		  fused_out = 0;
+	    }
+      }
+
       fprintf(vvp_out, ":ivl_delay_selection \"%s\";\n",
                        ivl_design_delay_sel(des));
 
@@ -174,6 +188,13 @@ int target_design(ivl_design_t des)
 	    fprintf(vvp_out, "    \"%s\";\n", ivl_file_table_item(idx));
       }
 
+      if (fused_out) {
+	    rewind(vvp_out);
+	    vvp_peephole(vvp_out, fused_out);
+	    fclose(vvp_out);
+	    vvp_out = fused_out;
+      }
+
       fclose(vvp_out);
       EOC_cleanup_drivers();
 
@@ -47,6 +47,13 @@ extern unsigned transient_id;
  */
 extern unsigned show_file_line;
 
+/*
+ * Copy the generated code from one file to the other, replacing some
+ * common sequences of instructions with fused instructions. This is
+ * done unless the user asks for -pfuse=0.
+ */
+extern void vvp_peephole(FILE*in, FILE*out);
+
 struct vector_info {
       unsigned base;
       unsigned wid;
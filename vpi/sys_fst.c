@@ -62,6 +62,9 @@ static enum lxm_optimum_mode_e {
       LXM_BOTH = 3
 } lxm_optimum_mode = LXM_NONE;
 
+/* Compress the blocks on a separate thread. */
+static int fst_parallel = 0;
+
 static const char*units_names[] = {
       "s",
       "ms",
@@ -403,6 +406,10 @@ static void open_dumpfile(vpiHandle callh)
 	        (lxm_optimum_mode == LXM_BOTH)) {
 		  fstWriterSetRepackOnClose(dump_file, 1);
 	    }
+	      /* Hand the block compression to a writer thread. */
+	    if (fst_parallel) {
+		  fstWriterSetParallelMode(dump_file, 1);
+	    }
       }
 }
 
@@ -901,6 +908,14 @@ void sys_fst_register()
 		  lxm_optimum_mode = LXM_BOTH;
 	    } else if (strcmp(vlog_info.argv[idx],"-fst-speed-space") == 0) {
 		  lxm_optimum_mode = LXM_BOTH;
+
+	    } else if (strcmp(vlog_info.argv[idx],"-fst-parallel") == 0) {
+#ifdef HAVE_LIBPTHREAD
+		  fst_parallel = 1;
+#else
+		  vpi_printf("FST warning: The parallel writer needs thread "
+		             "support, -fst-parallel is ignored.\n");
+#endif
 	    }
       }
 
@@ -37,25 +37,217 @@ static vpiHandle sdf_callh = 0;
   /* The cell in process. */
 static vpiHandle sdf_cur_cell;
 
-static vpiHandle find_scope(vpiHandle scope, const char*name)
+/*
+ * A gate level netlist can have millions of cells, so the scopes and
+ * the modpaths are not searched by scanning them with VPI. Instead,
+ * the module scopes under the annotation scope are entered into a
+ * hash table when the annotation starts, keyed by the parent scope
+ * and the name. The modpaths of a cell are entered into a second hash
+ * table, keyed by the source and destination names, when the first
+ * IOPATH of the cell is looked up. Both tables are chained and grow
+ * as entries are added. The path entries are also kept in a list, so
+ * that the path table can be emptied for the next cell without going
+ * through all of its buckets.
+ */
+struct sdf_hash_link_s {
+      struct sdf_hash_link_s*next;
+      unsigned long hash;
+};
+
+struct sdf_scope_entry_s {
+      struct sdf_hash_link_s link;
+      vpiHandle parent;
+      vpiHandle scope;
+      char*name;
+};
+
+struct sdf_path_entry_s {
+      struct sdf_hash_link_s link;
+      struct sdf_path_entry_s*list_next;
+      vpiHandle path;
+      int edge;
+      char*src;
+      char*dst;
+};
+
+struct sdf_hash_s {
+      struct sdf_hash_link_s**table;
+      unsigned size;
+      unsigned count;
+};
+
+static struct sdf_hash_s sdf_scopes = { 0, 0, 0 };
+static struct sdf_hash_s sdf_paths = { 0, 0, 0 };
+  /* The cell whose paths are in sdf_paths, and the list of them. */
+static vpiHandle sdf_paths_cell = 0;
+static struct sdf_path_entry_s*sdf_path_list = 0;
+
+static unsigned long hash_string(unsigned long hash, const char*str)
 {
-      vpiHandle idx = vpi_iterate(vpiModule, scope);
-	/* If this scope has no modules then it can't have the one we
-	 * are looking for so just return 0. */
-      if (idx == 0) return 0;
+      while (*str) {
+	    hash ^= (unsigned char) *str++;
+	    hash *= 16777619UL;
+      }
+      return hash;
+}
+
+static unsigned long hash_scope(vpiHandle parent, const char*name)
+{
+      return hash_string(2166136261UL ^ (unsigned long)parent, name);
+}
+
+static unsigned long hash_path(const char*src, const char*dst)
+{
+      return hash_string(hash_string(2166136261UL, src) * 31, dst);
+}
+
+static void hash_insert(struct sdf_hash_s*hash, struct sdf_hash_link_s*link,
+			unsigned min_size)
+{
+      unsigned idx;
+
+      if (hash->count >= hash->size) {
+	    unsigned size = hash->size? 2*hash->size : min_size;
+	    struct sdf_hash_link_s**table = calloc(size, sizeof(*table));
+	    for (idx = 0 ; idx < hash->size ; idx += 1) {
+		  struct sdf_hash_link_s*cur = hash->table[idx];
+		  while (cur) {
+			struct sdf_hash_link_s*nxt = cur->next;
+			cur->next = table[cur->hash & (size-1)];
+			table[cur->hash & (size-1)] = cur;
+			cur = nxt;
+		  }
+	    }
+	    free(hash->table);
+	    hash->table = table;
+	    hash->size = size;
+      }
+
+      idx = link->hash & (hash->size-1);
+      link->next = hash->table[idx];
+      hash->table[idx] = link;
+      hash->count += 1;
+}
 
+static void index_scopes(vpiHandle parent)
+{
+      vpiHandle idx = vpi_iterate(vpiModule, parent);
       vpiHandle cur;
+
+      if (idx == 0) return;
+
       while ( (cur = vpi_scan(idx)) ) {
+	    struct sdf_scope_entry_s*ent = malloc(sizeof *ent);
+	    ent->parent = parent;
+	    ent->scope = cur;
+	    ent->name = strdup(vpi_get_str(vpiName, cur));
+	    ent->link.hash = hash_scope(parent, ent->name);
+	    hash_insert(&sdf_scopes, &ent->link, 1024);
+	    index_scopes(cur);
+      }
+}
 
-	    if ( strcmp(name, vpi_get_str(vpiName,cur)) == 0) {
-		  vpi_free_object(idx);
-		  return cur;
+static void clear_scope_index(void)
+{
+      unsigned idx;
+      for (idx = 0 ; idx < sdf_scopes.size ; idx += 1) {
+	    struct sdf_hash_link_s*cur = sdf_scopes.table[idx];
+	    while (cur) {
+		  struct sdf_hash_link_s*nxt = cur->next;
+		  free(((struct sdf_scope_entry_s*)cur)->name);
+		  free(cur);
+		  cur = nxt;
 	    }
       }
+      free(sdf_scopes.table);
+      sdf_scopes.table = 0;
+      sdf_scopes.size = 0;
+      sdf_scopes.count = 0;
+}
+
+static vpiHandle find_scope(vpiHandle scope, const char*name)
+{
+      struct sdf_hash_link_s*cur;
+      unsigned long hash = hash_scope(scope, name);
+
+	/* If there are no modules then there can't be the one we
+	 * are looking for so just return 0. */
+      if (sdf_scopes.size == 0) return 0;
+
+      for (cur = sdf_scopes.table[hash & (sdf_scopes.size-1)]
+	   ; cur ; cur = cur->next) {
+	    struct sdf_scope_entry_s*ent = (struct sdf_scope_entry_s*)cur;
+	    if (cur->hash == hash && ent->parent == scope
+		&& strcmp(name, ent->name) == 0)
+		  return ent->scope;
+      }
 
       return 0;
 }
 
+/*
+ * Make the index of the modpaths of the cell. The terms of a modpath
+ * are expected to be signals, vpiNet or vpiReg. A path with other
+ * terms cannot be matched by name, so is left out with a warning.
+ */
+static void index_paths(vpiHandle cell)
+{
+      vpiHandle iter = vpi_iterate(vpiModPath, cell);
+      vpiHandle path;
+
+      sdf_paths_cell = cell;
+      if (iter == 0) return;
+
+      while ( (path = vpi_scan(iter)) ) {
+	    struct sdf_path_entry_s*ent;
+	    int in_type, out_type;
+
+	    vpiHandle path_t_in = vpi_handle(vpiModPathIn,path);
+	    vpiHandle path_t_out = vpi_handle(vpiModPathOut,path);
+
+	    vpiHandle path_in = path_t_in? vpi_handle(vpiExpr,path_t_in) : 0;
+	    vpiHandle path_out = path_t_out? vpi_handle(vpiExpr,path_t_out) : 0;
+
+	    in_type = path_in? vpi_get(vpiType,path_in) : 0;
+	    out_type = path_out? vpi_get(vpiType,path_out) : 0;
+	    if (in_type != vpiNet || (out_type != vpiNet && out_type != vpiReg)) {
+		  if (sdf_flag_warning) {
+			vpi_printf("SDF WARNING: %s:%d: ",
+			           vpi_get_str(vpiFile, sdf_callh),
+			           (int)vpi_get(vpiLineNo, sdf_callh));
+			vpi_printf("Skipping a ModPath of %s that does not "
+			           "connect nets.\n",
+			           vpi_get_str(vpiFullName, cell));
+		  }
+		  continue;
+	    }
+
+	    ent = malloc(sizeof *ent);
+	    ent->path = path;
+	    ent->edge = vpi_get(vpiEdge,path_t_in);
+	    ent->src = strdup(vpi_get_str(vpiName,path_in));
+	    ent->dst = strdup(vpi_get_str(vpiName,path_out));
+	    ent->link.hash = hash_path(ent->src, ent->dst);
+	    hash_insert(&sdf_paths, &ent->link, 16);
+	    ent->list_next = sdf_path_list;
+	    sdf_path_list = ent;
+      }
+}
+
+static void clear_path_index(void)
+{
+      while (sdf_path_list) {
+	    struct sdf_path_entry_s*cur = sdf_path_list;
+	    sdf_path_list = cur->list_next;
+	    sdf_paths.table[cur->link.hash & (sdf_paths.size-1)] = 0;
+	    free(cur->src);
+	    free(cur->dst);
+	    free(cur);
+      }
+      sdf_paths.count = 0;
+      sdf_paths_cell = 0;
+}
+
 /*
  * These functions are called by the SDF parser during parsing to
  * handling items discovered in the parse.
@@ -121,7 +313,6 @@ void sdf_select_instance(const char*celltype, const char*cellinst)
 		       vpi_get_str(vpiFullName, sdf_scope), celltype,
 		       vpi_get_str(vpiDefName, sdf_cur_cell));
       }
-
 }
 
 static const char*edge_str(int vpi_edge)
@@ -138,46 +329,46 @@ static const char*edge_str(int vpi_edge)
 void sdf_iopath_delays(int vpi_edge, const char*src, const char*dst,
 		       const struct sdf_delval_list_s*delval_list)
 {
-      vpiHandle iter, path;
+      struct sdf_hash_link_s*link = 0;
+      unsigned long hash;
       int match_count = 0;
 
       if (sdf_cur_cell == 0)
 	    return;
 
-      iter = vpi_iterate(vpiModPath, sdf_cur_cell);
+	/* The modpaths of the cell are indexed the first time that
+	   one of its IOPATHs is looked up. */
+      if (sdf_paths_cell != sdf_cur_cell) {
+	    clear_path_index();
+	    index_paths(sdf_cur_cell);
+      }
 
 	/* Search for the modpath that matches the IOPATH by looking
 	   for the modpath that uses the same ports as the ports that
 	   the parser has found. */
-      if (iter) while ( (path = vpi_scan(iter)) ) {
+      hash = hash_path(src, dst);
+      if (sdf_paths.size)
+	    link = sdf_paths.table[hash & (sdf_paths.size-1)];
+      for ( ; link ; link = link->next) {
+	    struct sdf_path_entry_s*cur = (struct sdf_path_entry_s*)link;
 	    s_vpi_delay delays;
 	    struct t_vpi_time delay_vals[12];
 	    int idx;
 
-	    vpiHandle path_t_in = vpi_handle(vpiModPathIn,path);
-	    vpiHandle path_t_out = vpi_handle(vpiModPathOut,path);
-
-	    vpiHandle path_in = vpi_handle(vpiExpr,path_t_in);
-	    vpiHandle path_out = vpi_handle(vpiExpr,path_t_out);
-
-	      /* The expressions for the path terms must be signals,
-	         vpiNet or vpiReg. */
-	    assert(vpi_get(vpiType,path_in) == vpiNet);
-	    assert(vpi_get(vpiType,path_out) == vpiNet
-		   || vpi_get(vpiType,path_out) == vpiReg);
-
+	    if (link->hash != hash)
+		  continue;
 	      /* If the src name doesn't match, go on. */
-	    if (strcmp(src,vpi_get_str(vpiName,path_in)) != 0)
+	    if (strcmp(src,cur->src) != 0)
 		  continue;
 	      /* The edge type must match too. But note that if this
 	         IOPATH has no edge, then it matches with all edges of
 	         the modpath object. */
 /* --> Is this correct in the context of the 10, 01, etc. edges? */
-	    if (vpi_edge != vpiNoEdge && vpi_get(vpiEdge,path_t_in) != vpi_edge)
+	    if (vpi_edge != vpiNoEdge && cur->edge != vpi_edge)
 		  continue;
 
 	      /* If the dst name doesn't match, go on. */
-	    if (strcmp(dst,vpi_get_str(vpiName,path_out)) != 0)
+	    if (strcmp(dst,cur->dst) != 0)
 		  continue;
 
 	      /* Ah, this must be a match! */
@@ -187,7 +378,7 @@ void sdf_iopath_delays(int vpi_edge, const char*src, const char*dst,
 	    delays.mtm_flag = 0;
 	    delays.append_flag = 0;
 	    delays.plusere_flag = 0;
-	    vpi_get_delays(path, &delays);
+	    vpi_get_delays(cur->path, &delays);
 
 	    for (idx = 0 ; idx < delval_list->count ; idx += 1) {
 		  delay_vals[idx].type = vpiScaledRealTime;
@@ -196,7 +387,7 @@ void sdf_iopath_delays(int vpi_edge, const char*src, const char*dst,
 		  }
 	    }
 
-	    vpi_put_delays(path, &delays);
+	    vpi_put_delays(cur->path, &delays);
 	    match_count += 1;
       }
 
@@ -310,7 +501,13 @@ static PLI_INT32 sys_sdf_annotate_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
       sdf_cur_cell = 0;
       sdf_callh = callh;
+      index_scopes(sdf_scope);
       sdf_process_file(sdf_fd, fname);
+      clear_path_index();
+      clear_scope_index();
+      free(sdf_paths.table);
+      sdf_paths.table = 0;
+      sdf_paths.size = 0;
       sdf_callh = 0;
 
       fclose(sdf_fd);
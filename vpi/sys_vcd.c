@@ -25,6 +25,7 @@
  */
 
 # include  <stdio.h>
+# include  <stdarg.h>
 # include  <stdlib.h>
 # include  <string.h>
 # include  <assert.h>
@@ -99,26 +100,447 @@ static char *truncate_bitvec(char *s)
       }
 }
 
-static void show_this_item(struct vcd_info*info)
+/*
+ * With the -vcd-parallel extended argument the text of the dump file
+ * is made and written by a separate writer thread. The simulation
+ * thread only gets the values from VPI and appends them, in binary
+ * form, to a ring buffer. There is one producer (the simulation) and
+ * one consumer (the writer), so the ring itself needs no locks: the
+ * producer owns the head index and the consumer owns the tail index,
+ * and each only reads the other's index. A side that has to wait (the
+ * writer for data, the simulation for space) sleeps on a condition
+ * variable, and the other side only takes the lock to wake it when it
+ * has flagged that it is waiting. All other output goes through the
+ * ring as preformatted text, so the order in the file is the order
+ * that the simulation made it in.
+ *
+ * The writer tracks the number of bytes it has written, which takes
+ * the place of ftell() for $dumplimit. The simulation keeps an upper
+ * bound of the size that the queued records will have, so it only
+ * needs to wait for the writer when the limit may have been crossed.
+ */
+#if defined(HAVE_LIBPTHREAD) && defined(__GNUC__)
+# define VCD_PARALLEL 1
+# include  <pthread.h>
+#endif
+
+static int vcd_parallel = 0;
+
+#ifdef VCD_PARALLEL
+
+enum vcd_rec_e {
+      VCD_REC_TEXT,   /* Preformatted text */
+      VCD_REC_REAL,   /* A real value change */
+      VCD_REC_EVENT,  /* A named event trigger */
+      VCD_REC_SCALAR, /* A single bit value change */
+      VCD_REC_VECTOR, /* A vector value change, as vpiVectorVal words */
+      VCD_REC_FLUSH,  /* $dumpflush */
+      VCD_REC_STOP    /* Close the writer */
+};
+
+struct vcd_rec_s {
+      unsigned char type;
+      char bit;
+      unsigned size;     /* Text length, or vector width */
+      const char*ident;
+};
+
+#define VCD_RING_SIZE (4*1024*1024)
+  /* A sleeping writer is only woken once this much is queued, or
+     when the simulation needs it to finish. */
+#define VCD_WAKE_SIZE (64*1024)
+
+static unsigned char*vcd_ring = 0;
+static size_t vcd_ring_head = 0; /* Written by the simulation */
+static size_t vcd_ring_tail = 0; /* Written by the writer */
+static size_t vcd_ring_done = 0; /* Written by the writer */
+static size_t vcd_written = 0;   /* Written by the writer */
+static long vcd_size_bound = 0;
+static pthread_t vcd_writer;
+
+  /* The waiting side sets its flag under the lock before it checks
+     the ring again and sleeps, and the other side checks the flag
+     after it moves its index. */
+static pthread_mutex_t vcd_ring_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vcd_ring_data = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t vcd_ring_space = PTHREAD_COND_INITIALIZER;
+static int vcd_writer_waiting = 0;
+static int vcd_sim_waiting = 0;
+
+static size_t vcd_ring_used(void)
+{
+      size_t tail = __atomic_load_n(&vcd_ring_tail, __ATOMIC_ACQUIRE);
+      return vcd_ring_head - tail;
+}
+
+static void vcd_ring_copy_in(size_t pos, const void*src, size_t cnt)
+{
+      size_t off = pos % VCD_RING_SIZE;
+      size_t first = VCD_RING_SIZE - off;
+      if (first > cnt) first = cnt;
+      memcpy(vcd_ring+off, src, first);
+      memcpy(vcd_ring, (const char*)src+first, cnt-first);
+}
+
+static void vcd_ring_copy_out(size_t pos, void*dst, size_t cnt)
+{
+      size_t off = pos % VCD_RING_SIZE;
+      size_t first = VCD_RING_SIZE - off;
+      if (first > cnt) first = cnt;
+      memcpy(dst, vcd_ring+off, first);
+      memcpy((char*)dst+first, vcd_ring, cnt-first);
+}
+
+static void vcd_ring_wake(int*flag, pthread_cond_t*cond)
+{
+      if (__atomic_load_n(flag, __ATOMIC_SEQ_CST) == 0)
+	    return;
+
+      pthread_mutex_lock(&vcd_ring_lock);
+      pthread_cond_signal(cond);
+      pthread_mutex_unlock(&vcd_ring_lock);
+}
+
+/*
+ * Wait until the writer has handled all but at most keep bytes of
+ * the ring.
+ */
+static void vcd_ring_wait(size_t keep)
+{
+      if (vcd_ring_head - __atomic_load_n(&vcd_ring_done, __ATOMIC_ACQUIRE)
+	  <= keep)
+	    return;
+
+      vcd_ring_wake(&vcd_writer_waiting, &vcd_ring_data);
+      pthread_mutex_lock(&vcd_ring_lock);
+      __atomic_store_n(&vcd_sim_waiting, 1, __ATOMIC_SEQ_CST);
+      while (vcd_ring_head - __atomic_load_n(&vcd_ring_done, __ATOMIC_SEQ_CST)
+	     > keep)
+	    pthread_cond_wait(&vcd_ring_space, &vcd_ring_lock);
+      __atomic_store_n(&vcd_sim_waiting, 0, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&vcd_ring_lock);
+}
+
+/*
+ * Wait until the writer has handled everything in the ring.
+ */
+static void vcd_ring_drain(void)
+{
+      vcd_ring_wait(0);
+}
+
+/*
+ * Add a record, with cnt bytes of data after it, to the ring. The
+ * bound is the most text that the record can make.
+ */
+static void vcd_ring_put(const struct vcd_rec_s*rec, const void*data,
+                         size_t cnt, size_t bound)
+{
+      size_t need = sizeof(struct vcd_rec_s) + cnt;
+
+	/* Records that do not fit in the ring are written directly,
+	   once the writer has caught up and left the file alone. */
+      if (need > VCD_RING_SIZE/2) {
+	    vcd_ring_drain();
+	    assert(rec->type == VCD_REC_TEXT);
+	    fwrite(data, 1, cnt, dump_file);
+	    __atomic_add_fetch(&vcd_written, cnt, __ATOMIC_RELEASE);
+	    vcd_size_bound += cnt;
+	    return;
+      }
+
+      if (VCD_RING_SIZE - vcd_ring_used() < need)
+	    vcd_ring_wait(VCD_RING_SIZE - need);
+
+      vcd_ring_copy_in(vcd_ring_head, rec, sizeof(struct vcd_rec_s));
+      if (cnt > 0)
+	    vcd_ring_copy_in(vcd_ring_head+sizeof(struct vcd_rec_s), data, cnt);
+
+      __atomic_store_n(&vcd_ring_head, vcd_ring_head+need, __ATOMIC_SEQ_CST);
+      vcd_size_bound += bound;
+      if (rec->type == VCD_REC_STOP || vcd_ring_used() >= VCD_WAKE_SIZE)
+	    vcd_ring_wake(&vcd_writer_waiting, &vcd_ring_data);
+}
+
+static void vcd_write_vector(unsigned wid, const s_vpi_vecval*vec,
+                             const char*ident, char*buf)
+{
+      unsigned idx;
+      int rc;
+
+      for (idx = 0 ;  idx < wid ;  idx += 1) {
+	    unsigned bit = wid - 1 - idx;
+	    PLI_INT32 mask = 1 << (bit % 32);
+	    int a = (vec[bit/32].aval & mask) != 0;
+	    int b = (vec[bit/32].bval & mask) != 0;
+	    buf[idx] = b ? (a ? 'x' : 'z') : (a ? '1' : '0');
+      }
+      buf[wid] = 0;
+
+      rc = fprintf(dump_file, "b%s %s\n", truncate_bitvec(buf), ident);
+      if (rc > 0) __atomic_add_fetch(&vcd_written, rc, __ATOMIC_RELEASE);
+}
+
+static void* vcd_writer_thread(void*arg)
+{
+      size_t tail = 0;
+      size_t data_size = 0;
+      char*data = 0;
+      char*text = 0;
+      int running = 1;
+      (void)arg;
+
+      while (running) {
+	    struct vcd_rec_s rec;
+	    size_t cnt = 0;
+	    int rc = 0;
+	    if (__atomic_load_n(&vcd_ring_head, __ATOMIC_ACQUIRE) == tail) {
+		  pthread_mutex_lock(&vcd_ring_lock);
+		  __atomic_store_n(&vcd_writer_waiting, 1, __ATOMIC_SEQ_CST);
+		  while (__atomic_load_n(&vcd_ring_head, __ATOMIC_SEQ_CST)
+		         == tail)
+			pthread_cond_wait(&vcd_ring_data, &vcd_ring_lock);
+		  __atomic_store_n(&vcd_writer_waiting, 0, __ATOMIC_SEQ_CST);
+		  pthread_mutex_unlock(&vcd_ring_lock);
+	    }
+
+	    vcd_ring_copy_out(tail, &rec, sizeof rec);
+	    switch (rec.type) {
+		case VCD_REC_TEXT:
+		  cnt = rec.size;
+		  break;
+		case VCD_REC_REAL:
+		  cnt = sizeof(double);
+		  break;
+		case VCD_REC_VECTOR:
+		  cnt = (rec.size+31)/32 * sizeof(s_vpi_vecval);
+		  break;
+	    }
+
+	    if (cnt > data_size) {
+		  data_size = cnt;
+		  data = realloc(data, data_size);
+		  text = realloc(text, data_size*8 + 1);
+	    }
+	    if (cnt > 0)
+		  vcd_ring_copy_out(tail+sizeof rec, data, cnt);
+
+	      /* The data is copied out, so the space can be reused. */
+	    tail += sizeof rec + cnt;
+	    __atomic_store_n(&vcd_ring_tail, tail, __ATOMIC_RELEASE);
+
+	    switch (rec.type) {
+		case VCD_REC_TEXT:
+		  rc = fwrite(data, 1, cnt, dump_file);
+		  break;
+		case VCD_REC_REAL: {
+		      double val;
+		      memcpy(&val, data, sizeof val);
+		      rc = fprintf(dump_file, "r%.16g %s\n", val, rec.ident);
+		      break;
+		}
+		case VCD_REC_EVENT:
+		  rc = fprintf(dump_file, "1%s\n", rec.ident);
+		  break;
+		case VCD_REC_SCALAR:
+		  rc = fprintf(dump_file, "%c%s\n", rec.bit, rec.ident);
+		  break;
+		case VCD_REC_VECTOR:
+		  vcd_write_vector(rec.size, (const s_vpi_vecval*)data,
+		                   rec.ident, text);
+		  break;
+		case VCD_REC_FLUSH:
+		  fflush(dump_file);
+		  break;
+		case VCD_REC_STOP:
+		  running = 0;
+		  break;
+	    }
+
+	    if (rc > 0) __atomic_add_fetch(&vcd_written, rc, __ATOMIC_RELEASE);
+	    __atomic_store_n(&vcd_ring_done, tail, __ATOMIC_SEQ_CST);
+	    vcd_ring_wake(&vcd_sim_waiting, &vcd_ring_space);
+      }
+
+      free(data);
+      free(text);
+      return 0;
+}
+
+static void vcd_writer_start(void)
+{
+      vcd_ring = malloc(VCD_RING_SIZE);
+      vcd_ring_head = 0;
+      vcd_ring_tail = 0;
+      vcd_ring_done = 0;
+      vcd_written = 0;
+      vcd_size_bound = 0;
+      if (pthread_create(&vcd_writer, 0, vcd_writer_thread, 0) != 0) {
+	    vpi_printf("VCD warning: Unable to start the writer thread, "
+	               "-vcd-parallel is ignored.\n");
+	    free(vcd_ring);
+	    vcd_ring = 0;
+	    vcd_parallel = 0;
+      }
+}
+
+static void vcd_writer_stop(void)
+{
+      struct vcd_rec_s rec;
+      rec.type = VCD_REC_STOP;
+      vcd_ring_put(&rec, 0, 0, 0);
+      pthread_join(vcd_writer, 0);
+      free(vcd_ring);
+      vcd_ring = 0;
+}
+
+/*
+ * $dumpflush has the writer flush the file, and waits for that so
+ * that the file is complete when the task returns.
+ */
+static void vcd_writer_flush(void)
+{
+      struct vcd_rec_s rec;
+      rec.type = VCD_REC_FLUSH;
+      vcd_ring_put(&rec, 0, 0, 0);
+      vcd_ring_drain();
+}
+
+/*
+ * Return the size of the dump file, as ftell() would for a directly
+ * written file. This is exact when it matters: if the bound on the
+ * size is over the limit, wait for the writer and use its count.
+ */
+static long vcd_writer_size(void)
 {
+      if (vcd_size_bound <= dump_limit)
+	    return vcd_size_bound;
+
+      vcd_ring_drain();
+      vcd_size_bound = __atomic_load_n(&vcd_written, __ATOMIC_ACQUIRE);
+      return vcd_size_bound;
+}
+
+static void vcd_printf(const char*fmt, ...);
+
+static void show_this_item_parallel(struct vcd_info*info)
+{
+      struct vcd_rec_s rec;
       s_vpi_value value;
       PLI_INT32 type = vpi_get(vpiType, info->item);
+      size_t id_len = strlen(info->ident);
+
+      rec.ident = info->ident;
+      rec.size = 0;
+      rec.bit = 0;
 
       if (type == vpiRealVar) {
 	    value.format = vpiRealVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "r%.16g %s\n", value.value.real, info->ident);
+	    rec.type = VCD_REC_REAL;
+	    vcd_ring_put(&rec, &value.value.real, sizeof(double), 26+id_len);
       } else if (type == vpiNamedEvent) {
-	    fprintf(dump_file, "1%s\n", info->ident);
+	    rec.type = VCD_REC_EVENT;
+	    vcd_ring_put(&rec, 0, 0, 2+id_len);
+      } else if ((rec.size = vpi_get(vpiSize, info->item)) == 1) {
+	    value.format = vpiBinStrVal;
+	    vpi_get_value(info->item, &value);
+	    rec.type = VCD_REC_SCALAR;
+	    rec.bit = value.value.str[0];
+	    vcd_ring_put(&rec, 0, 0, 2+id_len);
+      } else if (rec.size > VCD_RING_SIZE/16) {
+	      /* Too wide for the ring, so send it as text. */
+	    value.format = vpiBinStrVal;
+	    vpi_get_value(info->item, &value);
+	    vcd_printf("b%s %s\n", truncate_bitvec(value.value.str),
+	               info->ident);
+      } else {
+	    value.format = vpiVectorVal;
+	    vpi_get_value(info->item, &value);
+	    rec.type = VCD_REC_VECTOR;
+	    vcd_ring_put(&rec, value.value.vector,
+	                 (rec.size+31)/32 * sizeof(s_vpi_vecval),
+	                 rec.size+3+id_len);
+      }
+}
+
+#endif
+
+/*
+ * All the text of the dump file is written with this function, so
+ * that it goes through the writer thread when there is one.
+ */
+static void vcd_printf(const char*fmt, ...)
+{
+      va_list args;
+
+      va_start(args, fmt);
+#ifdef VCD_PARALLEL
+      if (vcd_parallel) {
+	    char buf[1024];
+	    char*text = buf;
+	    struct vcd_rec_s rec;
+	    va_list copy;
+	    int len;
+
+	    va_copy(copy, args);
+	    len = vsnprintf(buf, sizeof buf, fmt, args);
+	    assert(len >= 0);
+	    if ((size_t)len >= sizeof buf) {
+		  text = malloc(len+1);
+		  vsnprintf(text, len+1, fmt, copy);
+	    }
+	    va_end(copy);
+
+	    rec.type = VCD_REC_TEXT;
+	    rec.size = len;
+	    rec.ident = 0;
+	    vcd_ring_put(&rec, text, len, len);
+	    if (text != buf) free(text);
+	    va_end(args);
+	    return;
+      }
+#endif
+      vfprintf(dump_file, fmt, args);
+      va_end(args);
+}
+
+static long vcd_file_size(void)
+{
+#ifdef VCD_PARALLEL
+      if (vcd_parallel) return vcd_writer_size();
+#endif
+      return ftell(dump_file);
+}
+
+static void show_this_item(struct vcd_info*info)
+{
+      s_vpi_value value;
+      PLI_INT32 type;
+
+#ifdef VCD_PARALLEL
+      if (vcd_parallel) {
+	    show_this_item_parallel(info);
+	    return;
+      }
+#endif
+
+      type = vpi_get(vpiType, info->item);
+      if (type == vpiRealVar) {
+	    value.format = vpiRealVal;
+	    vpi_get_value(info->item, &value);
+	    vcd_printf("r%.16g %s\n", value.value.real, info->ident);
+      } else if (type == vpiNamedEvent) {
+	    vcd_printf("1%s\n", info->ident);
       } else if (vpi_get(vpiSize, info->item) == 1) {
 	    value.format = vpiBinStrVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "%s%s\n", value.value.str, info->ident);
+	    vcd_printf("%s%s\n", value.value.str, info->ident);
       } else {
 	    value.format = vpiBinStrVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "b%s %s\n", truncate_bitvec(value.value.str),
-		    info->ident);
+	    vcd_printf("b%s %s\n", truncate_bitvec(value.value.str),
+		       info->ident);
       }
 }
 
@@ -129,13 +551,13 @@ static void show_this_item_x(struct vcd_info*info)
 
       if (type == vpiRealVar) {
 	      /* Some tools dump nothing here...? */
-	    fprintf(dump_file, "rNaN %s\n", info->ident);
+	    vcd_printf("rNaN %s\n", info->ident);
       } else if (type == vpiNamedEvent) {
 	    /* Do nothing for named events. */
       } else if (vpi_get(vpiSize, info->item) == 1) {
-	    fprintf(dump_file, "x%s\n", info->ident);
+	    vcd_printf("x%s\n", info->ident);
       } else {
-	    fprintf(dump_file, "bx %s\n", info->ident);
+	    vcd_printf("bx %s\n", info->ident);
       }
 }
 
@@ -181,7 +603,7 @@ static PLI_INT32 variable_cb_2(p_cb_data cause)
       PLI_UINT64 now = timerec_to_time64(cause->time);
 
       if (now != vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now);
+	    vcd_printf("#%" PLI_UINT64_FMT "\n", now);
 	    vcd_cur_time = now;
       }
 
@@ -205,12 +627,12 @@ static PLI_INT32 variable_cb_1(p_cb_data cause)
       if (dump_header_pending()) return 0;
       if (info->scheduled) return 0;
 
-      if ((dump_limit > 0) && (ftell(dump_file) > dump_limit)) {
+      if ((dump_limit > 0) && (vcd_file_size() > dump_limit)) {
             dump_is_full = 1;
             vpi_printf("WARNING: Dump file limit (%ld bytes) "
                                "exceeded.\n", dump_limit);
-            fprintf(dump_file, "$comment Dump file limit (%ld bytes) "
-                               "exceeded. $end\n", dump_limit);
+            vcd_printf("$comment Dump file limit (%ld bytes) "
+                       "exceeded. $end\n", dump_limit);
             return 0;
       }
 
@@ -237,13 +659,13 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
 
-      fprintf(dump_file, "$enddefinitions $end\n");
+      vcd_printf("$enddefinitions $end\n");
 
       if (!dump_is_off) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", dumpvars_time);
-	    fprintf(dump_file, "$dumpvars\n");
+	    vcd_printf("#%" PLI_UINT64_FMT "\n", dumpvars_time);
+	    vcd_printf("$dumpvars\n");
 	    vcd_checkpoint();
-	    fprintf(dump_file, "$end\n");
+	    vcd_printf("$end\n");
       }
 
       return 0;
@@ -260,9 +682,12 @@ static PLI_INT32 finish_cb(p_cb_data cause)
       dumpvars_time = timerec_to_time64(cause->time);
 
       if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", dumpvars_time);
+	    vcd_printf("#%" PLI_UINT64_FMT "\n", dumpvars_time);
       }
 
+#ifdef VCD_PARALLEL
+      if (vcd_parallel) vcd_writer_stop();
+#endif
       fclose(dump_file);
 
       for (cur = vcd_list ;  cur ;  cur = next) {
@@ -329,13 +754,13 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       now64 = timerec_to_time64(&now);
 
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    vcd_printf("#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpoff\n");
+      vcd_printf("$dumpoff\n");
       vcd_checkpoint_x();
-      fprintf(dump_file, "$end\n");
+      vcd_printf("$end\n");
 
       return 0;
 }
@@ -357,13 +782,13 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       now64 = timerec_to_time64(&now);
 
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    vcd_printf("#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpon\n");
+      vcd_printf("$dumpon\n");
       vcd_checkpoint();
-      fprintf(dump_file, "$end\n");
+      vcd_printf("$end\n");
 
       return 0;
 }
@@ -382,13 +807,13 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       now64 = timerec_to_time64(&now);
 
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    vcd_printf("#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpall\n");
+      vcd_printf("$dumpall\n");
       vcd_checkpoint();
-      fprintf(dump_file, "$end\n");
+      vcd_printf("$end\n");
 
       return 0;
 }
@@ -414,6 +839,10 @@ static void open_dumpfile(vpiHandle callh)
 	    vpi_printf("VCD info: dumpfile %s opened for output.\n",
 	               dump_path);
 
+#ifdef VCD_PARALLEL
+	    if (vcd_parallel) vcd_writer_start();
+#endif
+
 	    time(&walltime);
 
 	    assert(prec >= -15);
@@ -426,15 +855,15 @@ static void open_dumpfile(vpiHandle callh)
 		  prec -= 1;
 	    }
 
-	    fprintf(dump_file, "$date\n");
-	    fprintf(dump_file, "\t%s",asctime(localtime(&walltime)));
-	    fprintf(dump_file, "$end\n");
-	    fprintf(dump_file, "$version\n");
-	    fprintf(dump_file, "\tIcarus Verilog\n");
-	    fprintf(dump_file, "$end\n");
-	    fprintf(dump_file, "$timescale\n");
-	    fprintf(dump_file, "\t%u%s\n", scale, units_names[udx]);
-	    fprintf(dump_file, "$end\n");
+	    vcd_printf("$date\n");
+	    vcd_printf("\t%s",asctime(localtime(&walltime)));
+	    vcd_printf("$end\n");
+	    vcd_printf("$version\n");
+	    vcd_printf("\tIcarus Verilog\n");
+	    vcd_printf("$end\n");
+	    vcd_printf("$timescale\n");
+	    vcd_printf("\t%u%s\n", scale, units_names[udx]);
+	    vcd_printf("$end\n");
       }
 }
 
@@ -475,7 +904,15 @@ static PLI_INT32 sys_dumpfile_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
 static PLI_INT32 sys_dumpflush_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
-      if (dump_file) fflush(dump_file);
+      if (dump_file == 0) return 0;
+
+#ifdef VCD_PARALLEL
+      if (vcd_parallel) {
+	    vcd_writer_flush();
+	    return 0;
+      }
+#endif
+      fflush(dump_file);
 
       return 0;
 }
@@ -654,17 +1091,17 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	    if (item_type == vpiNamedEvent) size = 1;
 	    else size = vpi_get(vpiSize, item);
 
-	    fprintf(dump_file, "$var %s %u %s %s%s",
-		    type, size, ident, prefix, name);
+	    vcd_printf("$var %s %u %s %s%s",
+		       type, size, ident, prefix, name);
 
 	      /* Add a range for vectored values. */
 	    if (size > 1 || vpi_get(vpiLeftRange, item) != 0) {
-		  fprintf(dump_file, " [%i:%i]",
-			  (int)vpi_get(vpiLeftRange, item),
-			  (int)vpi_get(vpiRightRange, item));
+		  vcd_printf(" [%i:%i]",
+			     (int)vpi_get(vpiLeftRange, item),
+			     (int)vpi_get(vpiRightRange, item));
 	    }
 
-	    fprintf(dump_file, " $end\n");
+	    vcd_printf(" $end\n");
 	    break;
 
 	  case vpiModule:
@@ -705,7 +1142,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  }
 
 		  name = vpi_get_str(vpiName, item);
-		  fprintf(dump_file, "$scope %s %s $end\n", type, name);
+		  vcd_printf("$scope %s %s $end\n", type, name);
 
 		  for (i=0; types[i]>0; i++) {
 			vpiHandle hand;
@@ -716,7 +1153,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  }
 
 		    /* Sort any signals that we added above. */
-		  fprintf(dump_file, "$upscope $end\n");
+		  vcd_printf("$upscope $end\n");
 	    }
 	    break;
       }
@@ -750,7 +1187,7 @@ static int draw_scope(vpiHandle item, vpiHandle callh)
             assert(0);
       }
 
-      fprintf(dump_file, "$scope %s %s $end\n", type, name);
+      vcd_printf("$scope %s %s $end\n", type, name);
 
       return depth;
 }
@@ -841,7 +1278,7 @@ static PLI_INT32 sys_dumpvars_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 	      /* The scope list must be sorted after we scan an item.  */
 	    vcd_names_sort(&vcd_tab);
 
-	    while (dep--) fprintf(dump_file, "$upscope $end\n");
+	    while (dep--) vcd_printf("$upscope $end\n");
 
 	      /* Add this signal to the variable list so we can verify it
 	       * is not included twice. This must be done after it has
@@ -857,9 +1294,25 @@ static PLI_INT32 sys_dumpvars_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
 void sys_vcd_register()
 {
+      int idx;
+      struct t_vpi_vlog_info vlog_info;
       s_vpi_systf_data tf_data;
       vpiHandle res;
 
+	/* Scan the extended arguments, looking for the writer thread
+	   flag. */
+      vpi_get_vlog_info(&vlog_info);
+      for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
+	    if (strcmp(vlog_info.argv[idx],"-vcd-parallel") == 0) {
+#ifdef VCD_PARALLEL
+		  vcd_parallel = 1;
+#else
+		  vpi_printf("VCD warning: The parallel writer needs thread "
+		             "support, -vcd-parallel is ignored.\n");
+#endif
+	    }
+      }
+
       /* All the compiletf routines are located in vcd_priv.c. */
 
       tf_data.type      = vpiSysTask;
@@ -65,11 +65,17 @@ vvp_array_t array_find(const char*label)
 * of. The easiest case is if this is an array of nets.
 *
 * - Array of Nets:
-* If this represents an array of nets, then the nets member points to
-* an array of vpiHandle objects. Each vpiHandle is a word. This is
-* done because typically each word of a net array is simultaneously
-* driven and accessed by other means, so there is no advantage to
-* compacting the array in any other way.
+* If this represents an array of nets, then the net_nodes member points
+* to an array of the vvp_net_t objects that are the words, and the
+* nets member points to an array of vpiHandle objects for the words.
+* Each word is a net of its own because typically each word of a net
+* array is simultaneously driven and accessed by other means. Most
+* words are never looked at through VPI, so the vpiHandle of a word
+* is only made when it is first asked for. Until then, its slot in
+* the nets array is nil and the net_msb, net_lsb, net_real and
+* signed_flag members describe the handle to make.
+* The driven values of the words are kept packed together in the
+* net_vals4 member, and not in the filter of each word net.
 *
 * - Array of vector4 words.
 * In this case, the nets pointer is nil, and the vals4 member points
@@ -98,8 +104,14 @@ struct __vpiArray : public __vpiHandle {
       __vpiDecConst msb;
       __vpiDecConst lsb;
       unsigned vals_width;
-	// If this is a net array, nets lists the handles.
+	// If this is a net array, nets lists the handles (made on
+	// demand) and net_nodes lists the nets of the words.
       vpiHandle*nets;
+      vvp_net_t**net_nodes;
+      vvp_vector4array_t*net_vals4;
+      int net_msb, net_lsb;
+      bool net_real;
+      bool net_described;
 	// If this is a var array, then these are used instead of nets.
       vvp_vector4array_t*vals4;
       vvp_darray        *vals;
@@ -229,9 +241,11 @@ unsigned get_array_word_size(vvp_array_t array)
 	/* For a net array we need to get the width from the first element. */
       if (array->nets) {
 	    assert(array->vals4 == 0 && array->vals == 0);
-	    struct __vpiSignal*vsig = dynamic_cast<__vpiSignal*>(array->nets[0]);
-	    assert(vsig);
-	    width = vpip_size(vsig);
+	    assert(array->net_nodes[0]);
+	    vvp_signal_value*sig = dynamic_cast<vvp_signal_value*>
+		  (array->net_nodes[0]->fil);
+	    assert(sig);
+	    width = sig->value_size();
 	/* For a variable array we can get the width from vals_width. */
       } else {
 	    assert(array->vals4 || array->vals);
@@ -403,7 +417,7 @@ vpiHandle __vpiArray::vpi_index(int index)
 	    return 0;
 
       if (nets != 0) {
-	    return nets[index];
+	    return array_net_word(this, index);
       }
 
       if (vals_words == 0)
@@ -429,7 +443,7 @@ vpiHandle __vpiArrayIterator::vpi_index(int)
       unsigned use_index = next;
       next += 1;
 
-      if (array->nets) return array->nets[use_index];
+      if (array->nets) return array_net_word(array, use_index);
 
       assert(array->vals4 || array->vals);
 
@@ -813,15 +827,10 @@ static bool vpi_array_is_real(vvp_array_t arr)
       if (arr->vals != 0)
 	    return false;
 
-	// This must be a net array so look at element 0 to find the type.
+	// This must be a net array, which knows the type of its words.
       assert(arr->nets != 0);
       assert(arr->array_count > 0);
-      struct __vpiRealVar*rsig = dynamic_cast<__vpiRealVar*>(arr->nets[0]);
-      if (rsig) {
-	    return true;
-      }
-
-      return false;
+      return arr->net_real;
 }
 
 static bool vpi_array_is_string(vvp_array_t arr)
@@ -1023,11 +1032,12 @@ void array_set_word(vvp_array_t arr,
       assert(arr->nets != 0);
 
 	// Select the word of the array that we affect.
-      vpiHandle word = arr->nets[address];
-      struct __vpiSignal*vsig = dynamic_cast<__vpiSignal*>(word);
-      assert(vsig);
+      vvp_net_t*net = arr->net_nodes[address];
+      assert(net);
+      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (net->fil);
+      assert(sig);
 
-      vsig->node->send_vec4_pv(val, part_off, val.size(), vpip_size(vsig), 0);
+      net->send_vec4_pv(val, part_off, val.size(), sig->value_size(), 0);
       array_word_change(arr, address);
 }
 
@@ -1082,19 +1092,16 @@ vvp_vector4_t array_get_word(vvp_array_t arr, unsigned address)
 	      // Reading outside the array. Return X's but get the
 	      // width by looking at a word that we know is present.
 	    assert(arr->array_count > 0);
-	    vpiHandle word = arr->nets[0];
-	    assert(word);
-	    struct __vpiSignal*vsig = dynamic_cast<__vpiSignal*>(word);
-	    assert(vsig);
-	    vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (vsig->node->fil);
+	    vvp_net_t*net = arr->net_nodes[0];
+	    assert(net);
+	    vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (net->fil);
 	    assert(sig);
 	    return vvp_vector4_t(sig->value_size(), BIT4_X);
       }
 
-      vpiHandle word = arr->nets[address];
-      struct __vpiSignal*vsig = dynamic_cast<__vpiSignal*>(word);
-      assert(vsig);
-      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (vsig->node->fil);
+      vvp_net_t*net = arr->net_nodes[address];
+      assert(net);
+      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (net->fil);
       assert(sig);
 
       vvp_vector4_t val;
@@ -1118,10 +1125,10 @@ double array_get_word_r(vvp_array_t arr, unsigned address)
       }
 
       assert(arr->nets);
-      vpiHandle word = arr->nets[address];
-      struct __vpiRealVar*vsig = dynamic_cast<__vpiRealVar*>(word);
-      assert(vsig);
-      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (vsig->net->fil);
+      assert(arr->net_real);
+      vvp_net_t*net = arr->net_nodes[address];
+      assert(net);
+      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (net->fil);
       assert(sig);
 
       double val = sig->real_value();
@@ -1181,6 +1188,12 @@ static vpiHandle vpip_make_array(char*label, const char*name,
 
 	// Start off now knowing if we are nets or variables.
       obj->nets = 0;
+      obj->net_nodes = 0;
+      obj->net_vals4 = 0;
+      obj->net_msb = 0;
+      obj->net_lsb = 0;
+      obj->net_real = false;
+      obj->net_described = false;
       obj->vals4 = 0;
       obj->vals  = 0;
       obj->vals_width = 0;
@@ -1211,46 +1224,167 @@ static vpiHandle vpip_make_array(char*label, const char*name,
 void array_alias_word(vvp_array_t array, unsigned long addr, vpiHandle word,
                       int msb, int lsb)
 {
-      assert(array->msb.value == msb);
-      assert(array->lsb.value == lsb);
       assert(addr < array->array_count);
       assert(array->nets);
+
+	// The word keeps its own parent and callbacks, so only note
+	// its net here; the word access paths read net_nodes.
+      vvp_net_t*net = 0;
+      bool real_flag = false;
+      bool signed_flag = false;
+      if (struct __vpiSignal*sig = dynamic_cast<__vpiSignal*>(word)) {
+	    net = sig->node;
+	    signed_flag = sig->signed_flag;
+      } else if (struct __vpiRealVar*rsig = dynamic_cast<__vpiRealVar*>(word)) {
+	    net = rsig->net;
+	    real_flag = true;
+	    signed_flag = true;
+      }
+      assert(net);
+
+      if (! array->net_described) {
+	    array->net_described = true;
+	    array->net_msb = msb;
+	    array->net_lsb = lsb;
+	    array->net_real = real_flag;
+	    array->signed_flag = signed_flag;
+      }
+
+      array->net_nodes[addr] = net;
       array->nets[addr] = word;
 }
 
-void array_attach_word(vvp_array_t array, unsigned addr, vpiHandle word)
+/*
+ * Fill in the handle of a net array word, and enter it into the nets
+ * list of the array.
+ */
+static void array_set_net_word(vvp_array_t array, unsigned long addr,
+			       vpiHandle word)
 {
-      assert(addr < array->array_count);
-      assert(array->nets);
       array->nets[addr] = word;
 
       if (struct __vpiSignal*sig = dynamic_cast<__vpiSignal*>(word)) {
-	    vvp_net_t*net = sig->node;
-	    assert(net);
-	    vvp_vpi_callback*fun = dynamic_cast<vvp_vpi_callback*>(net->fil);
-	    assert(fun);
-	    fun->attach_as_word(array, addr);
 	    sig->is_netarray = 1;
 	    sig->within.parent = array;
 	    sig->id.index = new __vpiDecConst(addr + array->first_addr.value);
-	      // Now we know the data type, update the array signed_flag.
-	    array->signed_flag = sig->signed_flag;
 	    return;
       }
 
       if (struct __vpiRealVar*sig = dynamic_cast<__vpiRealVar*>(word)) {
-	    vvp_net_t*net = sig->net;
-	    assert(net);
-	    vvp_vpi_callback*fun = dynamic_cast<vvp_vpi_callback*>(net->fil);
-	    assert(fun);
-	    fun->attach_as_word(array, addr);
 	    sig->is_netarray = 1;
 	    sig->within.parent = array;
 	    sig->id.index = new __vpiDecConst(addr + array->first_addr.value);
+	    return;
+      }
+}
+
+static void array_attach_net(vvp_array_t array, unsigned long addr,
+			     vvp_net_t*net)
+{
+      assert(net);
+      vvp_vpi_callback*fun = dynamic_cast<vvp_vpi_callback*>(net->fil);
+      assert(fun);
+      fun->attach_as_word(array, addr);
+      array->net_nodes[addr] = net;
+}
+
+void array_attach_word(vvp_array_t array, unsigned addr, vpiHandle word)
+{
+      assert(addr < array->array_count);
+      assert(array->nets);
+
+      if (struct __vpiSignal*sig = dynamic_cast<__vpiSignal*>(word)) {
+	    array_attach_net(array, addr, sig->node);
+	    array_set_net_word(array, addr, word);
+	      // Now we know the data type, update the array signed_flag.
+	    array->signed_flag = sig->signed_flag;
+	    return;
+      }
+
+      if (struct __vpiRealVar*sig = dynamic_cast<__vpiRealVar*>(word)) {
+	    array_attach_net(array, addr, sig->net);
+	    array_set_net_word(array, addr, word);
 	      // Now we know the data type, update the array signed_flag.
 	    array->signed_flag = true;
+	    array->net_real = true;
 	    return;
       }
+
+      array->nets[addr] = word;
+}
+
+void array_attach_net_word(vvp_array_t array, unsigned long addr,
+			   vvp_net_t*net, int msb, int lsb, bool signed_flag)
+{
+      assert(addr < array->array_count);
+      assert(array->nets);
+
+	// The first word describes the handles of all the words. In
+	// the odd case that a word does not match that description,
+	// make its handle now.
+      if (! array->net_described) {
+	    array->net_described = true;
+	    array->net_msb = msb;
+	    array->net_lsb = lsb;
+	    array->signed_flag = signed_flag;
+      } else if (array->net_real || array->net_msb != msb
+		 || array->net_lsb != lsb
+		 || array->signed_flag != signed_flag) {
+	    array_attach_net(array, addr, net);
+	    array_set_net_word(array, addr,
+			       vpip_make_net4(0, msb, lsb, signed_flag, net));
+	    return;
+      }
+
+      array_attach_net(array, addr, net);
+}
+
+void array_attach_real_net_word(vvp_array_t array, unsigned long addr,
+				vvp_net_t*net)
+{
+      assert(addr < array->array_count);
+      assert(array->nets);
+
+      array->signed_flag = true;
+      array->net_described = true;
+      array->net_real = true;
+      array_attach_net(array, addr, net);
+}
+
+vvp_wire_base* array_net_word_filter(vvp_array_t array, unsigned long addr,
+				     unsigned wid)
+{
+      assert(addr < array->array_count);
+      assert(array->nets);
+
+	// The store is made for the width of the first word. Words of
+	// another width keep their values in their own filters.
+      if (array->net_vals4 == 0)
+	    array->net_vals4 = new vvp_vector4array_sa(wid, array->array_count);
+      else if (array->net_vals4->width() != wid)
+	    return 0;
+
+      return new vvp_wire_vec4_word(array->net_vals4, addr);
+}
+
+vpiHandle array_net_word(vvp_array_t array, unsigned long addr)
+{
+      assert(addr < array->array_count);
+      assert(array->nets);
+
+      if (array->nets[addr] || array->net_nodes[addr] == 0)
+	    return array->nets[addr];
+
+      vvp_net_t*net = array->net_nodes[addr];
+      vpiHandle word;
+      if (array->net_real)
+	    word = vpip_make_real_var(0, net);
+      else
+	    word = vpip_make_net4(0, array->net_msb, array->net_lsb,
+				  array->signed_flag, net);
+
+      array_set_net_word(array, addr, word);
+      return word;
 }
 
 void compile_var_array(char*label, char*name, int last, int first,
@@ -1363,6 +1497,8 @@ void compile_net_array(char*label, char*name, int last, int first)
 
       struct __vpiArray*arr = dynamic_cast<__vpiArray*>(obj);
       arr->nets = (vpiHandle*)calloc(arr->array_count, sizeof(vpiHandle));
+      arr->net_nodes = (vvp_net_t**)calloc(arr->array_count,
+					   sizeof(vvp_net_t*));
 
       count_net_arrays += 1;
       count_net_array_words += arr->array_count;
@@ -1896,8 +2032,19 @@ void compile_array_alias(char*label, char*name, char*src)
       obj->msb.value = mem->msb.value;
       obj->lsb.value = mem->lsb.value;
 
-	// Share the words with the source array.
+	// Share the words with the source array. The word handles of
+	// a net array point to their parent, so make them all now so
+	// that the parent is the source array.
+      if (mem->nets) {
+	    for (unsigned idx = 0 ; idx < mem->array_count ; idx += 1)
+		  array_net_word(mem, idx);
+      }
       obj->nets = mem->nets;
+      obj->net_nodes = mem->net_nodes;
+      obj->net_msb = mem->net_msb;
+      obj->net_lsb = mem->net_lsb;
+      obj->net_real = mem->net_real;
+      obj->net_described = mem->net_described;
       obj->vals4 = mem->vals4;
       obj->vals  = mem->vals;
       obj->vals_width = mem->vals_width;
@@ -2051,6 +2198,8 @@ void memory_delete(vpiHandle item)
 
       if (arr->nets) {
 	    for (unsigned idx = 0; idx < arr->array_count; idx += 1) {
+		    /* Words that were never asked for have no handle. */
+		  if (arr->nets[idx] == 0) continue;
 		  if (struct __vpiSignal*sig =
 		      dynamic_cast<__vpiSignal*>(arr->nets[idx])) {
 // Delete the individual words?
@@ -2067,6 +2216,8 @@ void memory_delete(vpiHandle item)
 		  }
 	    }
 	    free(arr->nets);
+	    free(arr->net_nodes);
+	    delete arr->net_vals4;
       }
 
       while (arr->vpi_callbacks) {
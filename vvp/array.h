@@ -24,6 +24,7 @@
 
 typedef struct __vpiArray* vvp_array_t;
 class value_callback;
+class vvp_wire_base;
 
 /*
  * This function tries to find the array (by label) in the global
@@ -36,6 +37,25 @@ extern vpiHandle array_index_iterate(int code, vpiHandle ref);
 extern void array_word_change(vvp_array_t array, unsigned long addr);
 
 extern void array_attach_word(vvp_array_t array, unsigned addr, vpiHandle word);
+/*
+ * Attach the net of a word to a net array without making a vpiHandle
+ * for it. The array_net_word function makes the handle of a net array
+ * word the first time it is asked for.
+ */
+extern void array_attach_net_word(vvp_array_t array, unsigned long addr,
+				  vvp_net_t*net, int msb, int lsb,
+				  bool signed_flag);
+extern void array_attach_real_net_word(vvp_array_t array, unsigned long addr,
+				       vvp_net_t*net);
+extern vpiHandle array_net_word(vvp_array_t array, unsigned long addr);
+/*
+ * Make the filter of a net array word, which keeps the driven value
+ * of the word in the packed store of the array. This returns nil if
+ * the word does not fit in the store, and needs a filter of its own.
+ */
+extern vvp_wire_base* array_net_word_filter(vvp_array_t array,
+					    unsigned long addr,
+					    unsigned wid);
 extern void array_alias_word(vvp_array_t array, unsigned long addr,
                              vpiHandle word, int msb, int lsb);
 
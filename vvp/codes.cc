@@ -23,6 +23,7 @@
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
+# include  <map>
 # include  <cstring>
 # include  <cassert>
 
@@ -39,6 +40,18 @@ static struct vvp_code_s *first_chunk = 0;
 static struct vvp_code_s *current_chunk = 0;
 static unsigned current_within_chunk = 0;
 
+/*
+ * The file_line_map maps the first instruction of each run of code to
+ * the %file_line instruction in force for that run, or nil. A new run
+ * starts at each %file_line instruction, at each scope or thread
+ * boundary of the compiled code, and at the start of each chunk, so
+ * the nearest entry at or before an instruction is always in the same
+ * chunk and the same thread.
+ */
+static std::map<vvp_code_t,vvp_code_t> file_line_map;
+static vvp_code_t file_line_cur = 0;
+static bool file_line_pending = false;
+
 /*
  * This initializes the code space. It sets up the first code chunk,
  * and places at address 0 a ZOMBIE instruction.
@@ -55,6 +68,7 @@ void codespace_init(void)
       current_chunk[code_chunk_size-1].cptr = 0;
 
       current_within_chunk = 1;
+      file_line_map[current_chunk] = 0;
 
       count_opcodes = 0;
       size_opcodes += code_chunk_size * sizeof (struct vvp_code_s);
@@ -86,21 +100,60 @@ vvp_code_t codespace_allocate(void)
       current_within_chunk += 1;
       count_opcodes += 1;
 
+      if (file_line_pending || res == current_chunk) {
+	    file_line_map[res] = file_line_cur;
+	    file_line_pending = false;
+      }
+
       memset(res, 0, sizeof(*res));
 
       return res;
 }
 
+void codespace_reserve(unsigned count)
+{
+      assert(count < code_chunk_size);
+      while (current_within_chunk < (code_chunk_size-1)
+	     && current_within_chunk + count > (code_chunk_size-1)) {
+	    vvp_code_t code = codespace_allocate();
+	    code->opcode = &of_NOOP;
+      }
+}
+
 vvp_code_t codespace_null(void)
 {
       return first_chunk + 0;
 }
 
+void codespace_set_file_line(vvp_code_t line)
+{
+      if (line) {
+	    file_line_map[line] = line;
+	    file_line_pending = false;
+      } else if (file_line_cur) {
+	    file_line_pending = true;
+      }
+      file_line_cur = line;
+}
+
+vvp_code_t codespace_file_line(vvp_code_t code)
+{
+      std::map<vvp_code_t,vvp_code_t>::const_iterator cur
+	    = file_line_map.upper_bound(code);
+      if (cur == file_line_map.begin())
+	    return 0;
+
+      --cur;
+      return cur->second;
+}
+
 #ifdef CHECK_WITH_VALGRIND
 void codespace_delete(void)
 {
       vvp_code_t cur = first_chunk;
 
+      file_line_map.clear();
+
 	/* If there are no opcodes then just delete the code space. */
       if (count_opcodes == 0) {
 	    delete [] cur;
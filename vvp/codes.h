@@ -222,6 +222,28 @@ extern bool of_REAP_UFUNC(vthread_t thr, vvp_code_t code);
 
 extern bool of_CHUNK_LINK(vthread_t thr, vvp_code_t code);
 
+/*
+ * These are the fused instructions. Each runs a short sequence of
+ * the instructions above with a single dispatch. A fused instruction
+ * takes one code word for each instruction of the sequence, laid out
+ * as that instruction would be, with the fused opcode in the first
+ * word (see compile_code). Only the last instruction of a sequence
+ * may jump.
+ */
+extern bool of_CMPS_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_CMPU_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_CMPIS_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_CMPIU_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_IX_GET_LOAD_AV(vthread_t thr, vvp_code_t code);
+extern bool of_IX_GET_S_LOAD_AV(vthread_t thr, vvp_code_t code);
+extern bool of_IX_GETV_LOAD_AV(vthread_t thr, vvp_code_t code);
+extern bool of_IX_GETV_S_LOAD_AV(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_ADDI_SET_VEC(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_CMPIS_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_CMPIU_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_VP0_SET_VEC(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_VP0_S_SET_VEC(vthread_t thr, vvp_code_t code);
+
 /*
  * This is the format of a machine code instruction.
  */
@@ -264,4 +286,27 @@ extern vvp_code_t codespace_allocate(void);
 extern vvp_code_t codespace_next(void);
 extern vvp_code_t codespace_null(void);
 
+/*
+ * Make sure that the next count instructions allocated are in
+ * consecutive code words. If they would not fit in the current chunk,
+ * the rest of the chunk is filled with %noop instructions.
+ */
+extern void codespace_reserve(unsigned count);
+
+/*
+ * The compiler calls codespace_set_file_line with each %file_line
+ * instruction it makes, and with nil at each scope or thread boundary.
+ * codespace_file_line returns the %file_line instruction in force for
+ * the instruction, which is the nearest one before it in the same
+ * thread, or nil if there is none.
+ */
+extern void codespace_set_file_line(vvp_code_t line);
+extern vvp_code_t codespace_file_line(vvp_code_t code);
+
+/*
+ * Return the mnemonic of the opcode function, or nil if it is not
+ * known. This uses the opcode table of the compiler.
+ */
+extern const char* codespace_mnemonic(vvp_code_fun opcode);
+
 #endif
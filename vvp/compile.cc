@@ -25,15 +25,23 @@
 # include  "logic.h"
 # include  "resolv.h"
 # include  "udp.h"
+# include  "part.h"
+# include  "dff.h"
+# include  "bufif.h"
+# include  "npmos.h"
+# include  "event.h"
+# include  "vvp_net_sig.h"
 # include  "symbols.h"
 # include  "codes.h"
 # include  "schedule.h"
 # include  "vpi_priv.h"
 # include  "parse_misc.h"
 # include  "statistics.h"
+# include  "profile.h"
 # include  "schedule.h"
 # include  <iostream>
 # include  <list>
+# include  <vector>
 # include  <cstdlib>
 # include  <cstring>
 # include  <cassert>
@@ -273,6 +281,103 @@ static int opcode_compare(const void*k, const void*r)
       return strcmp(kp, rp->mnemonic);
 }
 
+/*
+ * The fused instructions are emitted by the code generator for some
+ * common sequences of instructions. The operands of a fused
+ * instruction are the distinct operands of the sequence, and the argv
+ * of each part maps the operands of that instruction to them. Only
+ * numbers may be used by more than one part.
+ */
+struct fused_table_s {
+      const char*mnemonic;
+      vvp_code_fun opcode;
+      unsigned argc;
+      unsigned nparts;
+      struct {
+	    const char*mnemonic;
+	    unsigned char argv[3];
+      } part[3];
+};
+
+static const struct fused_table_s fused_table[] = {
+      { "%cmp/s/jmp/0xz", of_CMPS_JMP0XZ, 5, 2,
+	{ {"%cmp/s", {0,1,2}}, {"%jmp/0xz", {3,4}} } },
+      { "%cmp/u/jmp/0xz", of_CMPU_JMP0XZ, 5, 2,
+	{ {"%cmp/u", {0,1,2}}, {"%jmp/0xz", {3,4}} } },
+      { "%cmpi/s/jmp/0xz", of_CMPIS_JMP0XZ, 5, 2,
+	{ {"%cmpi/s", {0,1,2}}, {"%jmp/0xz", {3,4}} } },
+      { "%cmpi/u/jmp/0xz", of_CMPIU_JMP0XZ, 5, 2,
+	{ {"%cmpi/u", {0,1,2}}, {"%jmp/0xz", {3,4}} } },
+      { "%ix/get/load/av", of_IX_GET_LOAD_AV, 6, 2,
+	{ {"%ix/get", {0,1,2}}, {"%load/av", {3,4,5}} } },
+      { "%ix/get/s/load/av", of_IX_GET_S_LOAD_AV, 6, 2,
+	{ {"%ix/get/s", {0,1,2}}, {"%load/av", {3,4,5}} } },
+      { "%ix/getv/load/av", of_IX_GETV_LOAD_AV, 5, 2,
+	{ {"%ix/getv", {0,1}}, {"%load/av", {2,3,4}} } },
+      { "%ix/getv/s/load/av", of_IX_GETV_S_LOAD_AV, 5, 2,
+	{ {"%ix/getv/s", {0,1}}, {"%load/av", {2,3,4}} } },
+      { "%load/addi/set/v", of_LOAD_ADDI_SET_VEC, 5, 3,
+	{ {"%load/v", {0,1,2}}, {"%addi", {0,3,2}}, {"%set/v", {4,0,2}} } },
+      { "%load/cmpi/s/jmp/0xz", of_LOAD_CMPIS_JMP0XZ, 6, 3,
+	{ {"%load/v", {0,1,2}}, {"%cmpi/s", {0,3,2}}, {"%jmp/0xz", {4,5}} } },
+      { "%load/cmpi/u/jmp/0xz", of_LOAD_CMPIU_JMP0XZ, 6, 3,
+	{ {"%load/v", {0,1,2}}, {"%cmpi/u", {0,3,2}}, {"%jmp/0xz", {4,5}} } },
+      { "%load/vp0/s/set/v", of_LOAD_VP0_S_SET_VEC, 4, 2,
+	{ {"%load/vp0/s", {0,1,2}}, {"%set/v", {3,0,2}} } },
+      { "%load/vp0/set/v", of_LOAD_VP0_SET_VEC, 4, 2,
+	{ {"%load/vp0", {0,1,2}}, {"%set/v", {3,0,2}} } },
+      { 0, of_NOOP, 0, 0, { } }
+};
+
+static const unsigned fused_count =
+                    sizeof(fused_table)/sizeof(*fused_table) - 1;
+
+static int fused_compare(const void*k, const void*r)
+{
+      const char*kp = (const char*)k;
+      const struct fused_table_s*rp = (const struct fused_table_s*)r;
+      return strcmp(kp, rp->mnemonic);
+}
+
+/*
+ * These opcodes are compiled by their own statements, so are not in
+ * the opcode_table, or are only created internally.
+ */
+static const struct {
+      const char*mnemonic;
+      vvp_code_fun opcode;
+} opcode_extra_table[] = {
+      { "%chunk_link",  of_CHUNK_LINK },
+      { "%disable",     of_DISABLE },
+      { "%exec_ufunc",  of_EXEC_UFUNC },
+      { "%file_line",   of_FILE_LINE },
+      { "%fork",        of_FORK },
+      { "%reap_ufunc",  of_REAP_UFUNC },
+      { "%vpi_call",    of_VPI_CALL },
+      { "%zombie",      of_ZOMBIE },
+      { 0, 0 }
+};
+
+const char* codespace_mnemonic(vvp_code_fun opcode)
+{
+      for (unsigned idx = 0 ; idx < opcode_count ; idx += 1) {
+	    if (opcode_table[idx].opcode == opcode)
+		  return opcode_table[idx].mnemonic;
+      }
+
+      for (unsigned idx = 0 ; opcode_extra_table[idx].mnemonic ; idx += 1) {
+	    if (opcode_extra_table[idx].opcode == opcode)
+		  return opcode_extra_table[idx].mnemonic;
+      }
+
+      for (unsigned idx = 0 ; idx < fused_count ; idx += 1) {
+	    if (fused_table[idx].opcode == opcode)
+		  return fused_table[idx].mnemonic;
+      }
+
+      return 0;
+}
+
 /*
  * Keep a symbol table of addresses within code space. Labels on
  * executable opcodes are mapped to their address here.
@@ -315,6 +420,7 @@ void define_functor_symbol(const char*label, vvp_net_t*net)
       symbol_value_t val;
       val.net = net;
       sym_set_value(sym_functors, label, val);
+      if (profile_flag) profile_define_net(net, vpip_peek_current_scope());
 }
 
 static vvp_net_t*lookup_functor_symbol(const char*label)
@@ -324,11 +430,31 @@ static vvp_net_t*lookup_functor_symbol(const char*label)
       return val.net;
 }
 
+/*
+ * The words of a net array do not have their vpiHandle entered into
+ * the sym_vpi table. If the label is a net that is an array word, get
+ * the handle from the array, which makes it if it does not yet exist.
+ */
+static vpiHandle lookup_array_word_symbol(const char*label)
+{
+      vvp_net_t*net = lookup_functor_symbol(label);
+      if (net == 0) return 0;
+
+      vvp_vpi_callback*fun = dynamic_cast<vvp_vpi_callback*>(net->fil);
+      if (fun == 0) return 0;
+
+      unsigned long addr;
+      vvp_array_t array = fun->get_array_word(addr);
+      if (array == 0) return 0;
+
+      return array_net_word(array, addr);
+}
+
 vpiHandle vvp_lookup_handle(const char*label)
 {
       symbol_value_t val = sym_get_value(sym_vpi, label);
       if (val.ptr) return (vpiHandle) val.ptr;
-      return 0;
+      return lookup_array_word_symbol(label);
 }
 
 vvp_net_t* vvp_net_lookup(const char*label)
@@ -560,6 +686,11 @@ bool vpi_handle_resolv_list_s::resolve(bool mes)
 	    // check for memory word  M<mem,base,wid>
       }
 
+      if (!val.ptr) {
+	    // check for a word of a net array
+	    val.ptr = lookup_array_word_symbol(label());
+      }
+
       if (val.ptr) {
 	    *handle = (vpiHandle) val.ptr;
 	    return true;
@@ -684,6 +815,159 @@ void compile_compiletf(struct __vpiSysTaskCall*obj)
       scheduled_compiletf.push_back(obj);
 }
 
+/*
+ * Partition the linked net graph into regions: sets of nets that are
+ * connected through fan-out links, or through a wide functor and its
+ * core. Nets in different regions never pass values to each other
+ * directly, so the active events of different regions within a time
+ * step are independent, and the scheduler can run them in parallel.
+ * This is a union-find over all the allocated nets, which are
+ * numbered in allocation order. The resulting region number of each
+ * net is stored in the net.
+ *
+ * A region is serial, and its events are only ever run alone, if any
+ * of its nets has a functor that may reach outside the region (see
+ * region_parallel_functor) or is a net array word, whose changes
+ * reach the array ports through the array.
+ */
+static unsigned region_find(std::vector<unsigned>&parent, unsigned idx)
+{
+      while (parent[idx] != idx) {
+	    parent[idx] = parent[parent[idx]];
+	    idx = parent[idx];
+      }
+      return idx;
+}
+
+static void region_union(std::vector<unsigned>&parent,
+			 unsigned idx1, unsigned idx2)
+{
+      idx1 = region_find(parent, idx1);
+      idx2 = region_find(parent, idx2);
+      if (idx1 != idx2)
+	    parent[idx2] = idx1;
+}
+
+/*
+ * These are the functors whose recv and run methods only touch their
+ * own state and the output of their own net, and only reach the rest
+ * of the simulation through the schedule_* functions. Anything else,
+ * for example system and user functions, islands, module paths, named
+ * events and the automatic functors, makes its region serial.
+ */
+static bool region_parallel_functor(vvp_net_fun_t*fun)
+{
+      if (fun == 0)
+	    return true;
+      if (dynamic_cast<automatic_hooks_s*>(fun))
+	    return false;
+      if (vvp_wide_fun_t*wide = dynamic_cast<vvp_wide_fun_t*>(fun))
+	    return dynamic_cast<vvp_udp_fun_core*>(wide->core()) != 0;
+
+      return dynamic_cast<vvp_fun_gate_*>(fun)
+	  || dynamic_cast<vvp_fun_signal_base*>(fun)
+	  || dynamic_cast<vvp_arith_*>(fun)
+	  || dynamic_cast<vvp_fun_part*>(fun)
+	  || dynamic_cast<vvp_fun_part_pv*>(fun)
+	  || dynamic_cast<vvp_fun_part_var*>(fun)
+	  || dynamic_cast<vvp_fun_concat*>(fun)
+	  || dynamic_cast<vvp_fun_concat8*>(fun)
+	  || dynamic_cast<vvp_fun_repeat*>(fun)
+	  || dynamic_cast<vvp_fun_extend_signed*>(fun)
+	  || dynamic_cast<vvp_fun_drive*>(fun)
+	  || dynamic_cast<resolv_core*>(fun)
+	  || dynamic_cast<vvp_fun_bufz*>(fun)
+	  || dynamic_cast<vvp_fun_muxz*>(fun)
+	  || dynamic_cast<vvp_fun_muxr*>(fun)
+	  || dynamic_cast<vvp_fun_bufif*>(fun)
+	  || dynamic_cast<vvp_fun_pmos_*>(fun)
+	  || dynamic_cast<vvp_fun_cmos_*>(fun)
+	  || dynamic_cast<vvp_dff*>(fun)
+	  || dynamic_cast<vvp_udp_fun_core*>(fun)
+	  || dynamic_cast<vvp_fun_delay*>(fun)
+	  || dynamic_cast<vvp_arith_real_*>(fun)
+	  || dynamic_cast<vvp_arith_abs*>(fun)
+	  || dynamic_cast<vvp_arith_cast_int*>(fun)
+	  || dynamic_cast<vvp_arith_cast_real*>(fun)
+	  || dynamic_cast<vvp_arith_cast_vec2*>(fun)
+	  || dynamic_cast<vvp_fun_edge*>(fun)
+	  || dynamic_cast<vvp_fun_anyedge*>(fun)
+	  || dynamic_cast<vvp_fun_event_or*>(fun);
+}
+
+static void compile_net_regions(void)
+{
+      size_t count = vvp_net_t::net_count();
+      std::vector<unsigned> parent (count);
+      for (size_t idx = 0 ; idx < count ; idx += 1) {
+	    parent[idx] = idx;
+	    vvp_net_t::net_at(idx)->region(idx);
+      }
+
+      for (size_t idx = 0 ; idx < count ; idx += 1) {
+	    vvp_net_t*net = vvp_net_t::net_at(idx);
+
+	    vvp_net_ptr_t cur = net->fanout();
+	    while (vvp_net_t*dst_net = cur.ptr()) {
+		  unsigned dst = dst_net->region();
+		  assert(dst < count);
+		  region_union(parent, idx, dst);
+		  cur = dst_net->port[cur.port()];
+	    }
+
+	    if (vvp_wide_fun_t*wide = dynamic_cast<vvp_wide_fun_t*>(net->fun)) {
+		  unsigned core = wide->core()->net()->region();
+		  assert(core < count);
+		  region_union(parent, idx, core);
+	    }
+      }
+
+	/* Number the regions densely, and store the region number
+	   in each net, so that the scheduler finds the region of an
+	   event directly from its net. */
+      std::vector<unsigned> number (count, vvp_net_t::NO_REGION);
+      std::vector<unsigned> size;
+      std::vector<bool> serial;
+      for (size_t idx = 0 ; idx < count ; idx += 1) {
+	    vvp_net_t*net = vvp_net_t::net_at(idx);
+	    unsigned root = region_find(parent, idx);
+	    if (number[root] == vvp_net_t::NO_REGION) {
+		  number[root] = size.size();
+		  size.push_back(0);
+		  serial.push_back(false);
+	    }
+
+	    unsigned id = number[root];
+	    net->region(id);
+	    size[id] += 1;
+
+	    unsigned long addr;
+	    if (! region_parallel_functor(net->fun)
+		|| (net->fil && net->fil->get_array_word(addr)))
+		  serial[id] = true;
+      }
+
+      if (verbose_flag) {
+	    unsigned singles = 0;
+	    unsigned serials = 0;
+	    unsigned largest = 0;
+	    for (size_t id = 0 ; id < size.size() ; id += 1) {
+		  if (size[id] == 1) singles += 1;
+		  if (serial[id]) serials += 1;
+		  if (size[id] > largest) largest = size[id];
+	    }
+
+	    fprintf(stderr, " ... %u nets in %u net regions"
+		    " (largest %u, %u single, %u serial)\n",
+		    (unsigned)count, (unsigned)size.size(),
+		    largest, singles, serials);
+	    fflush(stderr);
+      }
+
+      if (schedule_thread_count() > 1)
+	    schedule_use_regions(serial);
+}
+
 /*
  * When parsing is otherwise complete, this function is called to do
  * the final stuff. Clean up deferred linking here.
@@ -725,6 +1009,15 @@ void compile_cleanup(void)
 
       compile_errors += nerrs;
 
+      if (verbose_flag || schedule_thread_count() > 1)
+	    compile_net_regions();
+
+	/* The netlist is now linked, so gates that only drive other
+	   gates can be fused, and the fan-outs can be copied into
+	   arrays for faster propagation. */
+      compile_fuse_functors();
+      vvp_net_t::flatten_fanouts();
+
       if (verbose_flag) {
 	    fprintf(stderr, " ... Removing symbol tables\n");
 	    fflush(stderr);
@@ -1612,40 +1905,13 @@ char **compile_udp_table(char **table, char *row)
  * table gives the operand structure that is acceptable, so I can
  * process the operands here as well.
  */
-void compile_code(char*label, char*mnem, comp_operands_t opa)
+/*
+ * Pull the operands that the instruction expects from the list that
+ * the parser supplied.
+ */
+static void compile_operands(vvp_code_t code, const struct opcode_table_s*op,
+			     comp_operands_t opa)
 {
-	/* First, I can give the label a value that is the current
-	   codespace pointer. Don't need the text of the label after
-	   this is done. */
-      if (label)
-	    compile_codelabel(label);
-
-	/* Lookup the opcode in the opcode table. */
-      struct opcode_table_s*op = (struct opcode_table_s*)
-	    bsearch(mnem, opcode_table, opcode_count,
-		    sizeof(struct opcode_table_s), &opcode_compare);
-      if (op == 0) {
-	    yyerror("Invalid opcode");
-	    compile_errors += 1;
-	    return;
-      }
-
-      assert(op);
-
-	/* Build up the code from the information about the opcode and
-	   the information from the compiler. */
-      vvp_code_t code = codespace_allocate();
-      code->opcode = op->opcode;
-
-      if (op->argc != (opa? opa->argc : 0)) {
-	    yyerror("operand count");
-	    compile_errors += 1;
-	    return;
-      }
-
-	/* Pull the operands that the instruction expects from the
-	   list that the parser supplied. */
-
       for (unsigned idx = 0 ;  idx < op->argc ;  idx += 1) {
 
 	    switch (op->argt[idx]) {
@@ -1742,6 +2008,87 @@ void compile_code(char*label, char*mnem, comp_operands_t opa)
 		  break;
 	    }
       }
+}
+
+/*
+ * A fused instruction is compiled as the instructions of its sequence,
+ * in consecutive code words, and then the fused opcode replaces the
+ * opcode of the first of them.
+ */
+static void compile_fused(const struct fused_table_s*fop, comp_operands_t opa)
+{
+      if (fop->argc != (opa? opa->argc : 0)) {
+	    yyerror("operand count");
+	    compile_errors += 1;
+	    return;
+      }
+
+      codespace_reserve(fop->nparts);
+
+      vvp_code_t first = 0;
+      for (unsigned pdx = 0 ; pdx < fop->nparts ; pdx += 1) {
+	    const struct opcode_table_s*op = (const struct opcode_table_s*)
+		  bsearch(fop->part[pdx].mnemonic, opcode_table, opcode_count,
+			  sizeof(struct opcode_table_s), &opcode_compare);
+	    assert(op);
+
+	    struct comp_operands_s part;
+	    part.argc = op->argc;
+	    for (unsigned idx = 0 ; idx < op->argc ; idx += 1)
+		  part.argv[idx] = opa->argv[fop->part[pdx].argv[idx]];
+
+	    vvp_code_t code = codespace_allocate();
+	    code->opcode = op->opcode;
+	    compile_operands(code, op, &part);
+	    if (first == 0)
+		  first = code;
+      }
+
+      first->opcode = fop->opcode;
+}
+
+void compile_code(char*label, char*mnem, comp_operands_t opa)
+{
+	/* First, I can give the label a value that is the current
+	   codespace pointer. Don't need the text of the label after
+	   this is done. */
+      if (label)
+	    compile_codelabel(label);
+
+	/* Lookup the opcode in the opcode table. */
+      struct opcode_table_s*op = (struct opcode_table_s*)
+	    bsearch(mnem, opcode_table, opcode_count,
+		    sizeof(struct opcode_table_s), &opcode_compare);
+      if (op == 0) {
+	    struct fused_table_s*fop = (struct fused_table_s*)
+		  bsearch(mnem, fused_table, fused_count,
+			  sizeof(struct fused_table_s), &fused_compare);
+	    if (fop == 0) {
+		  yyerror("Invalid opcode");
+		  compile_errors += 1;
+		  return;
+	    }
+
+	    compile_fused(fop, opa);
+	    free(opa);
+	    free(mnem);
+	    return;
+      }
+
+      assert(op);
+
+	/* Build up the code from the information about the opcode and
+	   the information from the compiler. */
+      vvp_code_t code = codespace_allocate();
+      code->opcode = op->opcode;
+
+      if (op->argc != (opa? opa->argc : 0)) {
+	    yyerror("operand count");
+	    compile_errors += 1;
+	    return;
+      }
+
+      compile_operands(code, op, opa);
 
       free(opa);
 
@@ -1807,6 +2154,7 @@ void compile_file_line(char*label, long file_idx, long lineno,
 	/* Create a vpiHandle that contains the information. */
       code->handle = vpip_build_file_line(description, file_idx, lineno);
       assert(code->handle);
+      codespace_set_file_line(code);
 
 	/* Done with the lexor-allocated name string. */
       delete[] description;
@@ -1873,6 +2221,9 @@ void compile_thread(char*start_sym, char*flag)
 {
       bool push_flag = false;
 
+	/* The code of the thread ends here. */
+      codespace_set_file_line(0);
+
       symbol_value_t tmp = sym_get_value(sym_codespace, start_sym);
       vvp_code_t pc = reinterpret_cast<vvp_code_t>(tmp.ptr);
       if (pc == 0) {
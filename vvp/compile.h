@@ -106,6 +106,12 @@ extern void compile_functor(char*label, char*type, unsigned width,
 			    unsigned ostr0, unsigned ostr1,
 			    unsigned argc, struct symb_s*argv);
 
+/*
+ * This is called when the netlist is linked to fuse the trees of
+ * logic gates that only drive other gates into single functors.
+ */
+extern void compile_fuse_functors(void);
+
 
 /*
  * This is called by the parser to make a resolver. This is a special
@@ -387,7 +393,8 @@ extern void compile_named_event(char*label, char*type);
 
 
 /*
- * A code statement is a label, an opcode and up to 3 operands. There
+ * A code statement is a label, an opcode and up to 3 operands, or up
+ * to 6 for the fused instructions. There
  * are a few lexical types that the parser recognizes of the operands,
  * given by the ltype_e enumeration. The compile_code function takes
  * the label, mnemonic and parsed operands and writes a properly
@@ -395,7 +402,7 @@ extern void compile_named_event(char*label, char*type);
  * symbol table with the address of the instruction.
  */
 
-#define OPERAND_MAX 3
+#define OPERAND_MAX 6
 enum ltype_e { L_NUMB, L_SYMB, L_STRING };
 
 struct comp_operands_s {
@@ -101,6 +101,7 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       virtual void run_run();
+      vvp_net_t* region_net(void) { return net_; }
 
 
       void run_run_vec4_(struct vvp_fun_delay::event_*cur);
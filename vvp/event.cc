@@ -91,6 +91,8 @@ void schedule_evctl(__vpiHandle*handle, double value,
 	// Get the functor we are going to wait on.
       waitable_hooks_s*ep = dynamic_cast<waitable_hooks_s*> (event->fun);
       assert(ep);
+	// The control writes to another net when the event fires.
+      schedule_region_serial(event);
 	// Now add this call to the end of the event list.
       *(ep->last) = new evctl_real(handle, value, ecount);
       ep->last = &((*(ep->last))->next);
@@ -121,6 +123,8 @@ void schedule_evctl(vvp_net_ptr_t ptr, const vvp_vector4_t&value,
 	// Get the functor we are going to wait on.
       waitable_hooks_s*ep = dynamic_cast<waitable_hooks_s*> (event->fun);
       assert(ep);
+	// The control writes to another net when the event fires.
+      schedule_region_serial(event);
 	// Now add this call to the end of the event list.
       *(ep->last) = new evctl_vector(ptr, value, offset, wid, ecount);
       ep->last = &((*(ep->last))->next);
@@ -148,6 +152,8 @@ void schedule_evctl(vvp_array_t memory, unsigned index,
 	// Get the functor we are going to wait on.
       waitable_hooks_s*ep = dynamic_cast<waitable_hooks_s*> (event->fun);
       assert(ep);
+	// The control writes to another net when the event fires.
+      schedule_region_serial(event);
 	// Now add this call to the end of the event list.
       *(ep->last) = new evctl_array(memory, index, value, offset, ecount);
       ep->last = &((*(ep->last))->next);
@@ -174,6 +180,8 @@ void schedule_evctl(vvp_array_t memory, unsigned index,
 	// Get the functor we are going to wait on.
       waitable_hooks_s*ep = dynamic_cast<waitable_hooks_s*> (event->fun);
       assert(ep);
+	// The control writes to another net when the event fires.
+      schedule_region_serial(event);
 	// Now add this call to the end of the event list.
       *(ep->last) = new evctl_array_r(memory, index, value, ecount);
       ep->last = &((*(ep->last))->next);
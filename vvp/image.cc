@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2014 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "parse_misc.h"
+# include  "compile.h"
+# include  "parse.h"
+# include  <string>
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <cassert>
+# include  "ivl_alloc.h"
+
+/*
+ * A design image is the token stream that the lexor produced for a
+ * .vvp file, stored in a compact binary form. Loading an image feeds
+ * the parser directly from memory, so the text of the design does not
+ * need to be scanned again. The parse and the compile of the design
+ * still run as they do for the text. The file starts with a text
+ * header that holds the checksum of the grammar of the parser that
+ * made it, since the token numbers are only meaningful to that
+ * parser. The header is then followed by one record per token:
+ *
+ *    <token> <line delta> [<payload>]
+ *
+ * All the integers are stored as little endian base-128 varints. The
+ * payload depends on the token: T_NUMBER has a number, T_VECTOR has a
+ * width and a string, and the other text tokens have a string. A
+ * string is a length followed by the bytes. The token stream ends
+ * with a 0 token, which is the end of input to the parser.
+ */
+
+static const char image_magic[] = "#!vvp-image\n";
+
+  /* The image format number, which must change if the encoding of
+     the tokens changes, followed by the grammar checksum. */
+static const unsigned image_format = 1;
+
+static std::string image_version(void)
+{
+      char text[64];
+      snprintf(text, sizeof text, "format %u grammar %08lx\n",
+	       image_format, compile_grammar_checksum());
+      return text;
+}
+
+  /* The image being recorded while the lexor runs, if any. */
+static bool image_recording = false;
+static std::string image_out;
+static unsigned image_out_line = 1;
+
+  /* The image being replayed in place of the lexor, if any. */
+static char*image_buf = 0;
+static size_t image_len = 0;
+static size_t image_pos = 0;
+static unsigned image_in_line = 1;
+
+static void put_varint(uint64_t val)
+{
+      while (val >= 0x80) {
+	    image_out.push_back((char)(0x80 | (val & 0x7f)));
+	    val >>= 7;
+      }
+      image_out.push_back((char)val);
+}
+
+static void put_string(const char*text)
+{
+      size_t len = strlen(text);
+      put_varint(len);
+      image_out.append(text, len);
+}
+
+static uint64_t get_varint(void)
+{
+      uint64_t val = 0;
+      unsigned shift = 0;
+      while (image_pos < image_len) {
+	    unsigned char byte = image_buf[image_pos++];
+	    val |= (uint64_t)(byte & 0x7f) << shift;
+	    if ((byte & 0x80) == 0)
+		  return val;
+	    shift += 7;
+      }
+
+      fprintf(stderr, "%s: Design image is truncated.\n", yypath);
+      exit(1);
+}
+
+  /* Strings are returned in the same kind of memory that the lexor
+     would have used, since the parser releases them accordingly. */
+static char* get_string(bool new_flag)
+{
+      size_t len = get_varint();
+      if (len > image_len - image_pos) {
+	    fprintf(stderr, "%s: Design image is truncated.\n", yypath);
+	    exit(1);
+      }
+
+      char*text = new_flag? new char[len+1] : (char*)malloc(len+1);
+      memcpy(text, image_buf+image_pos, len);
+      text[len] = 0;
+      image_pos += len;
+      return text;
+}
+
+static void record_token(int tok)
+{
+      put_varint(tok);
+      put_varint(yyline - image_out_line);
+      image_out_line = yyline;
+
+      switch (tok) {
+	  case T_NUMBER:
+	    put_varint(yylval.numb);
+	    break;
+	  case T_VECTOR:
+	    put_varint(yylval.vect.idx);
+	    put_string(yylval.vect.text);
+	    break;
+	  case T_INSTR:
+	  case T_LABEL:
+	  case T_STRING:
+	  case T_SYMBOL:
+	    put_string(yylval.text);
+	    break;
+	  default:
+	    break;
+      }
+}
+
+static int replay_token(void)
+{
+      if (image_pos >= image_len)
+	    return 0;
+
+      int tok = get_varint();
+      image_in_line += get_varint();
+      yyline = image_in_line;
+
+      switch (tok) {
+	  case T_NUMBER:
+	    yylval.numb = get_varint();
+	    break;
+	  case T_VECTOR:
+	    yylval.vect.idx = get_varint();
+	    yylval.vect.text = get_string(false);
+	    break;
+	  case T_STRING:
+	    yylval.text = get_string(true);
+	    break;
+	  case T_INSTR:
+	  case T_LABEL:
+	  case T_SYMBOL:
+	    yylval.text = get_string(false);
+	    break;
+	  default:
+	    break;
+      }
+
+      return tok;
+}
+
+/*
+ * The parser gets its tokens here. They come from the image if one
+ * is loaded, otherwise from the flex scanner, and are recorded if an
+ * image is going to be written. Replayed tokens are recorded too, so
+ * that an image can be rewritten from an image.
+ */
+int yylex(void)
+{
+      int tok = image_buf? replay_token() : yylex_text();
+      if (image_recording)
+	    record_token(tok);
+      return tok;
+}
+
+void image_record(void)
+{
+      image_recording = true;
+      image_out.assign(image_magic);
+      image_out.append(image_version());
+      image_out_line = 1;
+}
+
+int image_write(const char*path)
+{
+      assert(image_recording);
+      image_recording = false;
+
+      FILE*fd = fopen(path, "wb");
+      if (fd == 0) {
+	    perror(path);
+	    return -1;
+      }
+
+      size_t len = image_out.size();
+      size_t rc = fwrite(image_out.data(), 1, len, fd);
+      fclose(fd);
+      std::string().swap(image_out);
+
+      if (rc != len) {
+	    fprintf(stderr, "%s: Unable to write design image.\n", path);
+	    return -1;
+      }
+      return 0;
+}
+
+int image_load(FILE*fd)
+{
+      char head[sizeof image_magic];
+      size_t cnt = fread(head, 1, sizeof image_magic - 1, fd);
+      if (cnt != sizeof image_magic - 1
+	  || memcmp(head, image_magic, sizeof image_magic - 1) != 0) {
+	    rewind(fd);
+	    return 0;
+      }
+
+	/* The whole file is read into memory, so its size must be
+	   known and must fit. */
+      long len = -1;
+      if (fseek(fd, 0, SEEK_END) == 0)
+	    len = ftell(fd);
+      if (len < 0 || fseek(fd, 0, SEEK_SET) != 0) {
+	    fprintf(stderr, "%s: Unable to read design image.\n", yypath);
+	    return -1;
+      }
+
+      image_len = len;
+      if ((long)image_len != len) {
+	    fprintf(stderr, "%s: Design image is too large.\n", yypath);
+	    image_len = 0;
+	    return -1;
+      }
+
+      image_buf = (char*)malloc(image_len);
+      if (image_buf == 0) {
+	    fprintf(stderr, "%s: Not enough memory to load design image "
+		    "(%zu bytes).\n", yypath, image_len);
+	    image_len = 0;
+	    return -1;
+      }
+
+      if (fread(image_buf, 1, image_len, fd) != image_len) {
+	    fprintf(stderr, "%s: Unable to read design image.\n", yypath);
+	    image_unload();
+	    return -1;
+      }
+
+      image_pos = sizeof image_magic - 1;
+      std::string version = image_version();
+      size_t vlen = version.size();
+      if (image_len - image_pos < vlen
+	  || memcmp(image_buf+image_pos, version.data(), vlen) != 0) {
+	    fprintf(stderr, "%s: Design image was made by a different "
+		    "version of vvp.\n", yypath);
+	    image_unload();
+	    return -1;
+      }
+
+      image_pos += vlen;
+      image_in_line = 1;
+      return 1;
+}
+
+void image_unload(void)
+{
+      free(image_buf);
+      image_buf = 0;
+      image_len = 0;
+      image_pos = 0;
+}
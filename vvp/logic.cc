@@ -25,13 +25,32 @@
 # include  "delay.h"
 # include  "statistics.h"
 # include  <iostream>
+# include  <algorithm>
+# include  <map>
+# include  <vector>
 # include  <cstring>
 # include  <cassert>
 # include  <cstdlib>
 
-vvp_fun_boolean_::vvp_fun_boolean_(unsigned wid)
+  /* The nets of the simple gates, kept until they are fused. */
+static std::vector<vvp_net_t*> gate_nets;
+
+vvp_fun_gate_::vvp_fun_gate_()
 {
       net_ = 0;
+      fused_root_ = 0;
+      fused_next_ = 0;
+      fused_head_ = 0;
+      fused_net_ = 0;
+}
+
+vvp_fun_gate_::~vvp_fun_gate_()
+{
+}
+
+vvp_fun_boolean_::vvp_fun_boolean_(unsigned wid)
+: vvp_fun_gate_()
+{
       for (unsigned idx = 0 ;  idx < 4 ;  idx += 1)
 	    input_[idx] = vvp_vector4_t(wid, BIT4_Z);
 }
@@ -40,6 +59,20 @@ vvp_fun_boolean_::~vvp_fun_boolean_()
 {
 }
 
+/*
+ * Return true if all the inputs are the same width, so that the
+ * vector operators can be used to combine them a word at a time.
+ */
+bool vvp_fun_boolean_::inputs_same_width_() const
+{
+      unsigned wid = input_[0].size();
+      for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
+	    if (input_[pdx].size() != wid)
+		  return false;
+      }
+      return true;
+}
+
 void vvp_fun_boolean_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                                  vvp_context_t)
 {
@@ -48,10 +81,7 @@ void vvp_fun_boolean_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 	    return;
 
       input_[port] = bit;
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
-      }
+      schedule_(ptr.ptr());
 }
 
 void vvp_fun_boolean_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
@@ -68,9 +98,43 @@ void vvp_fun_boolean_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       if (flag == false)
 	    return;
 
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
+      schedule_(ptr.ptr());
+}
+
+/*
+ * A gate that has been fused into a tree does not get an event of
+ * its own. The net_ is set to mark that it needs to be run, and the
+ * root gets the event instead. The root is marked with its own net.
+ */
+void vvp_fun_gate_::schedule_(vvp_net_t*net)
+{
+      if (net_)
+	    return;
+
+      net_ = net;
+      if (fused_root_ == 0) {
 	    schedule_functor(this);
+	    return;
+      }
+
+      if (fused_root_->net_ == 0) {
+	    fused_root_->net_ = fused_root_->fused_net_;
+	    schedule_functor(fused_root_);
+      }
+}
+
+/*
+ * Run the marked gates of the tree. The list is in order from the
+ * inputs toward the root, so a gate that is marked by the output of
+ * an earlier gate is run later in the same pass. The outputs arrive
+ * at the root while it is still marked, so the root is not scheduled
+ * again.
+ */
+void vvp_fun_gate_::run_fused_list_()
+{
+      for (vvp_fun_gate_*cur = fused_head_ ; cur ; cur = cur->fused_next_) {
+	    if (cur->net_)
+		  cur->run_run();
       }
 }
 
@@ -86,11 +150,22 @@ vvp_fun_and::~vvp_fun_and()
 
 void vvp_fun_and::run_run()
 {
+      run_fused_();
+
       vvp_net_t*ptr = net_;
       net_ = 0;
 
       vvp_vector4_t result (input_[0]);
 
+      if (inputs_same_width_()) {
+	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1)
+		  result &= input_[pdx];
+	    if (invert_)
+		  result.invert();
+	    ptr->send_vec4(result, 0);
+	    return;
+      }
+
       for (unsigned idx = 0 ;  idx < result.size() ;  idx += 1) {
 	    vvp_bit4_t bitbit = result.value(idx);
 	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
@@ -113,7 +188,6 @@ void vvp_fun_and::run_run()
 vvp_fun_buf::vvp_fun_buf(unsigned wid)
 : input_(wid, BIT4_Z)
 {
-      net_ = 0;
       count_functors_logic += 1;
 }
 
@@ -135,11 +209,7 @@ void vvp_fun_buf::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 	    return;
 
       input_ = bit;
-
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
-      }
+      schedule_(ptr.ptr());
 }
 
 void vvp_fun_buf::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
@@ -157,14 +227,13 @@ void vvp_fun_buf::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       if (flag == false)
 	    return;
 
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
-      }
+      schedule_(ptr.ptr());
 }
 
 void vvp_fun_buf::run_run()
 {
+      run_fused_();
+
       vvp_net_t*ptr = net_;
       net_ = 0;
 
@@ -440,7 +509,6 @@ void vvp_fun_muxz::run_run()
 vvp_fun_not::vvp_fun_not(unsigned wid)
 : input_(wid, BIT4_Z)
 {
-      net_ = 0;
       count_functors_logic += 1;
 }
 
@@ -462,10 +530,7 @@ void vvp_fun_not::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 	    return;
 
       input_ = bit;
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
-      }
+      schedule_(ptr.ptr());
 }
 
 void vvp_fun_not::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
@@ -483,14 +548,13 @@ void vvp_fun_not::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       if (flag == false)
 	    return;
 
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
-      }
+      schedule_(ptr.ptr());
 }
 
 void vvp_fun_not::run_run()
 {
+      run_fused_();
+
       vvp_net_t*ptr = net_;
       net_ = 0;
 
@@ -510,11 +574,22 @@ vvp_fun_or::~vvp_fun_or()
 
 void vvp_fun_or::run_run()
 {
+      run_fused_();
+
       vvp_net_t*ptr = net_;
       net_ = 0;
 
       vvp_vector4_t result (input_[0]);
 
+      if (inputs_same_width_()) {
+	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1)
+		  result |= input_[pdx];
+	    if (invert_)
+		  result.invert();
+	    ptr->send_vec4(result, 0);
+	    return;
+      }
+
       for (unsigned idx = 0 ;  idx < result.size() ;  idx += 1) {
 	    vvp_bit4_t bitbit = result.value(idx);
 	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
@@ -546,6 +621,8 @@ vvp_fun_xor::~vvp_fun_xor()
 
 void vvp_fun_xor::run_run()
 {
+      run_fused_();
+
       vvp_net_t*ptr = net_;
       net_ = 0;
 
@@ -670,6 +747,9 @@ void compile_functor(char*label, char*type, unsigned width,
       inputs_connect(net, argc, argv);
       free(argv);
 
+      if (dynamic_cast<vvp_fun_gate_*>(obj))
+	    gate_nets.push_back(net);
+
 	/* If both the strengths are the default strong drive, then
 	   there is no need for a specialized driver. Attach the label
 	   to this node and we are finished. */
@@ -689,3 +769,129 @@ void compile_functor(char*label, char*type, unsigned width,
       define_functor_symbol(label, net_drv);
       free(label);
 }
+
+struct fuse_order_s {
+      size_t root;
+      size_t depth;
+      size_t gate;
+
+      bool operator < (const fuse_order_s&that) const
+      {
+	    if (root != that.root)
+		  return root < that.root;
+	    return depth > that.depth;
+      }
+};
+
+/*
+ * Fuse the trees of simple gates (AND, OR, XOR and their inverted
+ * forms, BUF and NOT). A gate can be fused if its only fan-out is an
+ * input of another such gate. Delays and drive
+ * strengths are separate functors, so such a gate has no delay, and
+ * since no signal is attached to its output, nothing can observe the
+ * value except the gate that it drives. The gate is fused into the
+ * root of its tree, which is the first gate downstream that can not
+ * be fused. Gates in a loop that has no root are left alone.
+ */
+void compile_fuse_functors(void)
+{
+      std::map<vvp_net_t*,size_t> index;
+      for (size_t idx = 0 ; idx < gate_nets.size() ; idx += 1)
+	    index[gate_nets[idx]] = idx;
+
+      const size_t NO_GATE = (size_t)-1;
+      const size_t UNKNOWN = (size_t)-2;
+      const size_t ON_PATH = (size_t)-3;
+
+	/* Find the gate that each gate drives, if that is all that
+	   the gate drives. */
+      std::vector<size_t> down (gate_nets.size(), NO_GATE);
+      for (size_t idx = 0 ; idx < gate_nets.size() ; idx += 1) {
+	    vvp_net_t*net = gate_nets[idx];
+	    vvp_fun_gate_*fun = static_cast<vvp_fun_gate_*>(net->fun);
+	    if (fun->net_)
+		  continue;
+
+	    vvp_net_ptr_t cur = net->fanout();
+	    vvp_net_t*dst = cur.ptr();
+	    if (dst == 0 || dst == net || dst->port[cur.port()].ptr())
+		  continue;
+
+	    std::map<vvp_net_t*,size_t>::iterator cur_dst = index.find(dst);
+	    if (cur_dst == index.end())
+		  continue;
+
+	    down[idx] = cur_dst->second;
+      }
+
+	/* Find the root and the distance to the root of each gate by
+	   walking down the tree. A gate that is its own root is not
+	   fused, and gates that lead into a loop have no root. */
+      std::vector<size_t> root (gate_nets.size(), UNKNOWN);
+      std::vector<size_t> depth (gate_nets.size(), 0);
+      std::vector<size_t> path;
+      for (size_t idx = 0 ; idx < gate_nets.size() ; idx += 1) {
+	    size_t cur = idx;
+	    while (root[cur] == UNKNOWN && down[cur] != NO_GATE) {
+		  root[cur] = ON_PATH;
+		  path.push_back(cur);
+		  cur = down[cur];
+	    }
+
+	    if (root[cur] == UNKNOWN)
+		  root[cur] = cur;
+
+	    size_t use_root = root[cur] == ON_PATH? NO_GATE : root[cur];
+	    size_t use_depth = depth[cur];
+	    while (! path.empty()) {
+		  size_t tmp = path.back();
+		  path.pop_back();
+		  use_depth += 1;
+		  root[tmp] = use_root;
+		  depth[tmp] = use_depth;
+	    }
+      }
+
+	/* Sort the fused gates by root, and the farthest gates of
+	   each root first. */
+      std::vector<fuse_order_s> order;
+      for (size_t idx = 0 ; idx < gate_nets.size() ; idx += 1) {
+	    if (root[idx] == NO_GATE || root[idx] == idx)
+		  continue;
+	    fuse_order_s tmp;
+	    tmp.root = root[idx];
+	    tmp.depth = depth[idx];
+	    tmp.gate = idx;
+	    order.push_back(tmp);
+      }
+      std::sort(order.begin(), order.end());
+
+      unsigned roots = 0;
+      vvp_fun_gate_*prev = 0;
+      for (size_t idx = 0 ; idx < order.size() ; idx += 1) {
+	    vvp_net_t*root_net = gate_nets[order[idx].root];
+	    vvp_fun_gate_*root_fun =
+		  static_cast<vvp_fun_gate_*>(root_net->fun);
+	    vvp_fun_gate_*fun =
+		  static_cast<vvp_fun_gate_*>(gate_nets[order[idx].gate]->fun);
+
+	    if (root_fun->fused_net_ == 0) {
+		  root_fun->fused_net_ = root_net;
+		  root_fun->fused_head_ = fun;
+		  roots += 1;
+	    } else {
+		  prev->fused_next_ = fun;
+	    }
+
+	    fun->fused_root_ = root_fun;
+	    prev = fun;
+      }
+
+      if (verbose_flag) {
+	    fprintf(stderr, " ... %u gates fused into %u trees\n",
+		    (unsigned)order.size(), roots);
+	    fflush(stderr);
+      }
+
+      std::vector<vvp_net_t*>().swap(gate_nets);
+}
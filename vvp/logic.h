@@ -23,10 +23,50 @@
 # include  "schedule.h"
 # include  <cstddef>
 
+/*
+ * vvp_fun_gate_ is the common hook for the simple gates that can be
+ * fused together.
+ *
+ * A gate whose only fan-out is an input of another gate can be fused
+ * into that gate by compile_fuse_functors. Nothing else sees the
+ * output of such a gate, so instead of scheduling an event of its
+ * own it marks itself and schedules the root of the fused tree. When
+ * the root runs, it first runs the marked gates of its tree in order
+ * from the inputs toward the root, so the whole tree costs one
+ * scheduler event.
+ */
+class vvp_fun_gate_ : public vvp_net_fun_t, protected vvp_gen_event_s {
+
+    public:
+      vvp_fun_gate_();
+      ~vvp_fun_gate_();
+
+    protected:
+      void schedule_(vvp_net_t*net);
+	// The root calls this before it evaluates its own inputs.
+      void run_fused_() { if (fused_head_) run_fused_list_(); }
+      vvp_net_t* region_net(void) { return net_; }
+
+      vvp_net_t*net_;
+
+    private:
+      void run_fused_list_();
+
+	// For a fused gate, the root of its tree and the next gate
+	// of the tree to be run. For a root, the first fused gate to
+	// be run and the net of the root itself.
+      vvp_fun_gate_*fused_root_;
+      vvp_fun_gate_*fused_next_;
+      vvp_fun_gate_*fused_head_;
+      vvp_net_t*fused_net_;
+
+      friend void compile_fuse_functors(void);
+};
+
 /*
  * vvp_fun_boolean_ is just a common hook for holding operands.
  */
-class vvp_fun_boolean_ : public vvp_net_fun_t, protected vvp_gen_event_s {
+class vvp_fun_boolean_ : public vvp_fun_gate_ {
 
     public:
       explicit vvp_fun_boolean_(unsigned wid);
@@ -39,8 +79,9 @@ class vvp_fun_boolean_ : public vvp_net_fun_t, protected vvp_gen_event_s {
                         vvp_context_t);
 
     protected:
+      bool inputs_same_width_() const;
+
       vvp_vector4_t input_[4];
-      vvp_net_t*net_;
 };
 
 class vvp_fun_and  : public vvp_fun_boolean_ {
@@ -60,7 +101,7 @@ class vvp_fun_and  : public vvp_fun_boolean_ {
  * The retransmitted vector has all Z values changed to X, just like
  * the buf(Q,D) gate in Verilog.
  */
-class vvp_fun_buf: public vvp_net_fun_t, private vvp_gen_event_s {
+class vvp_fun_buf: public vvp_fun_gate_ {
 
     public:
       explicit vvp_fun_buf(unsigned wid);
@@ -77,7 +118,6 @@ class vvp_fun_buf: public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       vvp_vector4_t input_;
-      vvp_net_t*net_;
 };
 
 /*
@@ -140,6 +180,7 @@ class vvp_fun_muxz : public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       void run_run();
+      vvp_net_t* region_net(void) { return net_; }
 
     private:
       vvp_vector4_t a_;
@@ -162,6 +203,7 @@ class vvp_fun_muxr : public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       void run_run();
+      vvp_net_t* region_net(void) { return net_; }
 
     private:
       double a_;
@@ -170,7 +212,7 @@ class vvp_fun_muxr : public vvp_net_fun_t, private vvp_gen_event_s {
       sel_type select_;
 };
 
-class vvp_fun_not: public vvp_net_fun_t, private vvp_gen_event_s {
+class vvp_fun_not: public vvp_fun_gate_ {
 
     public:
       explicit vvp_fun_not(unsigned wid);
@@ -187,7 +229,6 @@ class vvp_fun_not: public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       vvp_vector4_t input_;
-      vvp_net_t*net_;
 };
 
 class vvp_fun_or  : public vvp_fun_boolean_ {
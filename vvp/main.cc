@@ -27,9 +27,12 @@
 # include  "statistics.h"
 # include  "vvp_cleanup.h"
 # include  "vvp_object.h"
+# include  "slab.h"
+# include  "profile.h"
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
+# include  <string>
 # include  <unistd.h>
 #ifdef CHECK_WITH_VALGRIND
 # include  <pthread.h>
@@ -96,9 +99,9 @@ static void my_getrusage(struct rusage *a)
 #     endif
 }
 
-static void print_rusage(struct rusage *a, struct rusage *b)
+static double rusage_seconds(struct rusage *a, struct rusage *b)
 {
-      double delta = a->ru_utime.tv_sec
+      return a->ru_utime.tv_sec
 	    +        a->ru_utime.tv_usec/1E6
 	    +        a->ru_stime.tv_sec
 	    +        a->ru_stime.tv_usec/1E6
@@ -107,6 +110,11 @@ static void print_rusage(struct rusage *a, struct rusage *b)
 	    -        b->ru_stime.tv_sec
 	    -        b->ru_stime.tv_usec/1E6
 	    ;
+}
+
+static void print_rusage(struct rusage *a, struct rusage *b)
+{
+      double delta = rusage_seconds(a, b);
 
       vpi_mcd_printf(1,
 	      " ... %G seconds,"
@@ -123,9 +131,44 @@ static void print_rusage(struct rusage *a, struct rusage *b)
 struct rusage { int x; };
 inline static void my_getrusage(struct rusage *) { }
 inline static void print_rusage(struct rusage *, struct rusage *){};
+inline static double rusage_seconds(struct rusage *, struct rusage *)
+{ return 0.0; }
 
 #endif // ! defined(HAVE_SYS_RESOURCE_H)
 
+/*
+ * The VVP_SLAB_CHUNKS environment variable sets the chunk counts of
+ * the event heaps. It is a comma separated list of name=count items,
+ * with the heap names that the verbose statistics print. Setting the
+ * count to the peak of an earlier run makes a heap grow only once.
+ */
+static void set_slab_chunks(const char*spec)
+{
+      while (*spec) {
+	    const char*eq = strchr(spec, '=');
+	    if (eq == 0) {
+		  fprintf(stderr, "VVP_SLAB_CHUNKS: Missing count after "
+			  "\"%s\".\n", spec);
+		  return;
+	    }
+
+	    char*end;
+	    unsigned long cnt = strtoul(eq+1, &end, 0);
+	    std::string name (spec, eq-spec);
+	    if (end == eq+1 || cnt == 0 || (*end && *end != ',')) {
+		  fprintf(stderr, "VVP_SLAB_CHUNKS: Invalid count for "
+			  "heap %s.\n", name.c_str());
+		  return;
+	    }
+
+	    if (! schedule_heap_chunk_count(name.c_str(), cnt))
+		  fprintf(stderr, "VVP_SLAB_CHUNKS: Unknown heap %s, "
+			  "ignored.\n", name.c_str());
+
+	    spec = *end? end+1 : end;
+      }
+}
+
 static bool have_ivl_version = false;
 /*
  * Verify that the input file has a compatible version.
@@ -227,6 +270,8 @@ static void final_cleanup()
       signal_pool_delete();
       vvp_net_pool_delete();
       ufunc_pool_delete();
+      vthread_scratch_delete();
+      schedule_delete();
 #endif
 	/*
 	 * Unload the VPI modules. This is essential for MinGW, to ensure
@@ -258,6 +303,7 @@ int main(int argc, char*argv[])
       const char*design_path = 0;
       struct rusage cycles[3];
       const char *logfile_name = 0x0;
+      const char *image_path = 0x0;
       FILE *logfile = 0x0;
       extern void vpi_set_vlog_info(int, char**);
       extern bool stop_is_finish;
@@ -316,22 +362,35 @@ int main(int argc, char*argv[])
         /* For non-interactive runs we do not want to run the interactive
          * debugger, so make $stop just execute a $finish. */
       stop_is_finish = false;
-      while ((opt = getopt(argc, argv, "+hl:M:m:nNsvV")) != EOF) switch (opt) {
+      while ((opt = getopt(argc, argv, "+c:hj:l:M:m:nNp:svVw")) != EOF) switch (opt) {
          case 'h':
            fprintf(stderr,
                    "Usage: vvp [options] input-file [+plusargs...]\n"
                    "Options:\n"
+                   " -c file        Write a design image for faster loading.\n"
                    " -h             Print this help message.\n"
+                   " -j count       Run independent net regions on count threads.\n"
                    " -l file        Logfile, '-' for <stderr>\n"
                    " -M path        VPI module directory\n"
 		   " -M -           Clear VPI module path\n"
                    " -m module      Load vpi module.\n"
 		   " -n             Non-interactive ($stop = $finish).\n"
                    " -N             Same as -n, but exit code is 1 instead of 0\n"
+                   " -p file        Write a profile of the simulation.\n"
 		   " -s             $stop right away.\n"
                    " -v             Verbose progress messages.\n"
-                   " -V             Print the version information.\n" );
+                   " -V             Print the version information.\n"
+                   " -w             Use a timing wheel for the event queue.\n" );
            exit(0);
+	  case 'c':
+	    image_path = optarg;
+	    image_record();
+	    break;
+	  case 'j':
+	    if (! schedule_use_threads(strtoul(optarg, 0, 10)))
+		  fprintf(stderr, "%s: -j is not supported by this build.\n",
+			  argv[0]);
+	    break;
 	  case 'l':
 	    logfile_name = optarg;
 	    break;
@@ -353,6 +412,9 @@ int main(int argc, char*argv[])
             stop_is_finish = true;
             stop_is_finish_exit_code = 1;
             break;
+	  case 'p':
+	    profile_init(optarg);
+	    break;
 	  case 's':
 	    schedule_stop(0);
 	    break;
@@ -362,6 +424,9 @@ int main(int argc, char*argv[])
 	  case 'V':
 	    version_flag = true;
 	    break;
+	  case 'w':
+	    schedule_use_timing_wheel();
+	    break;
 	  default:
 	    flag_errors += 1;
       }
@@ -405,6 +470,10 @@ int main(int argc, char*argv[])
 
       design_path = argv[optind];
 
+      if (const char*spec = getenv("VVP_SLAB_CHUNKS")) {
+	    set_slab_chunks(spec);
+      }
+
 	/* This is needed to get the MCD I/O routines ready for
 	   anything. It is done early because it is plausible that the
 	   compile might affect it, and it is cheap to do. */
@@ -463,6 +532,13 @@ int main(int argc, char*argv[])
 	    return compile_errors;
       }
 
+	/* The design compiled cleanly, so the tokens that were read
+	   make a good design image. */
+      if (image_path && image_write(image_path) != 0) {
+	    final_cleanup();
+	    return 1;
+      }
+
       if (verbose_flag) {
 #ifdef __MINGW32__  /* MinGW does not know about z. */
 	    vpi_mcd_printf(1, " ... %8lu functors (net_fun pool=%u bytes)\n",
@@ -493,6 +569,8 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, " ... %8lu vvp_nets (%zu bytes)\n",
 #endif
 			   count_vvp_nets, size_vvp_nets);
+	    vpi_mcd_printf(1, " ... %8lu flattened fan-outs\n",
+			   count_flat_fanouts);
 	    vpi_mcd_printf(1, " ... %8lu arrays (%lu words)\n",
 			   count_net_arrays, count_net_array_words);
 	    vpi_mcd_printf(1, " ... %8lu memories\n",
@@ -502,6 +580,9 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, "           %8lu real (%lu words)\n",
 			   count_real_arrays, count_real_array_words);
 	    vpi_mcd_printf(1, " ... %8lu scopes\n",   count_vpi_scopes);
+	    vpi_mcd_printf(1, " ... %8lu symbol lookups (%lu probes,"
+			   " %G seconds)\n", count_symbol_lookups,
+			   count_symbol_probes, time_symbol_lookups);
       }
 
       if (verbose_flag) {
@@ -513,6 +594,9 @@ int main(int argc, char*argv[])
 
       schedule_simulate();
 
+      if (profile_flag)
+	    profile_report();
+
       if (verbose_flag) {
 	    my_getrusage(cycles+2);
 	    print_rusage(cycles+2, cycles+1);
@@ -536,6 +620,21 @@ int main(int argc, char*argv[])
 			   count_assign_arword_pool());
 	    vpi_mcd_printf(1, "    %8lu other events (pool=%lu)\n",
 			   count_gen_events, count_gen_pool());
+	    if (schedule_thread_count() > 1)
+		  vpi_mcd_printf(1, "    %8lu events in %lu parallel batches\n",
+				 count_batch_events, count_batches);
+
+	    double run_time = rusage_seconds(cycles+2, cycles+1);
+	    vpi_mcd_printf(1, "Event heaps:\n");
+	    for (unsigned idx = 0 ; schedule_heap_name(idx) ; idx += 1) {
+		  const slab_counts_s*heap = schedule_heap_counts(idx);
+		  vpi_mcd_printf(1, "    %-8s %10lu allocs",
+				 schedule_heap_name(idx), heap->allocs);
+		  if (run_time > 0.0)
+			vpi_mcd_printf(1, " (%.0f/s)", heap->allocs/run_time);
+		  vpi_mcd_printf(1, ", peak=%lu live=%lu pool=%lu\n",
+				 heap->peak, heap->live, heap->pool);
+	    }
       }
 
       final_cleanup();
@@ -926,7 +926,7 @@ operands_opt
 operands
 	: operands ',' operand
 		{ comp_operands_t opa = $1;
-		  assert(opa->argc < 3);
+		  assert(opa->argc < OPERAND_MAX);
 		  assert($3->argc == 1);
 		  opa->argv[opa->argc] = $3->argv[0];
 		  opa->argc += 1;
@@ -1176,17 +1176,53 @@ delay
 
 %%
 
+/*
+ * Make a checksum of the token numbers and the grammar tables of the
+ * parser. Design images hold token numbers, so an image is only
+ * usable by a parser with the same checksum.
+ */
+static void grammar_sum(unsigned long&sum, const void*data, size_t len)
+{
+      const unsigned char*cp = (const unsigned char*)data;
+      for (size_t idx = 0 ; idx < len ; idx += 1) {
+	    sum ^= cp[idx];
+	    sum = (sum * 16777619UL) & 0xffffffffUL;
+      }
+}
+
+unsigned long compile_grammar_checksum(void)
+{
+      unsigned long sum = 2166136261UL;
+      grammar_sum(sum, yytranslate, sizeof yytranslate);
+      grammar_sum(sum, yyr1, sizeof yyr1);
+      grammar_sum(sum, yyr2, sizeof yyr2);
+      grammar_sum(sum, yydefact, sizeof yydefact);
+      grammar_sum(sum, yypact, sizeof yypact);
+      grammar_sum(sum, yytable, sizeof yytable);
+      grammar_sum(sum, yycheck, sizeof yycheck);
+      return sum;
+}
+
 int compile_design(const char*path)
 {
       yypath = path;
       yyline = 1;
-      yyin = fopen(path, "r");
+      yyin = fopen(path, "rb");
       if (yyin == 0) {
 	    fprintf(stderr, "%s: Unable to open input file.\n", path);
 	    return -1;
       }
 
-      int rc = yyparse();
+	/* If the input is a design image, then the parser gets its
+	   tokens from the image instead of the scanner. */
+      int rc = image_load(yyin);
+      if (rc < 0) {
+	    fclose(yyin);
+	    return -1;
+      }
+
+      rc = yyparse();
+      image_unload();
       fclose(yyin);
       return rc;
 }
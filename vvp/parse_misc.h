@@ -20,6 +20,7 @@
  */
 
 # include  "vpi_priv.h"
+# include  <cstdio>
 
 /*
  * This method is called to compile the design file. The input is read
@@ -46,6 +47,33 @@ extern void yyerror(const char*msg);
 
 extern void destroy_lexor();
 
+/*
+ * The flex scanner itself. The parser calls yylex, which gets the
+ * tokens from here or from a loaded design image.
+ */
+extern int yylex_text(void);
+
+/*
+ * Design images hold the token stream of a .vvp file in binary form
+ * so that the scanner can be skipped when the design is run again.
+ *
+ * image_record arranges for the tokens of the design being compiled
+ * to be kept, and image_write saves them to the given path after the
+ * compile. image_load checks if the open file is an image, and if so
+ * reads it and returns 1 so that yylex replays it. It returns 0 if
+ * the file is not an image and -1 if it is not a usable image.
+ */
+extern void image_record(void);
+extern int  image_write(const char*path);
+extern int  image_load(FILE*fd);
+extern void image_unload(void);
+
+/*
+ * This is a checksum of the token numbers and tables of the parser,
+ * which is the version of the design image format.
+ */
+extern unsigned long compile_grammar_checksum(void);
+
 /*
  * This is the path of the current source file.
  */
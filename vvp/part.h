@@ -58,6 +58,7 @@ class vvp_fun_part_sa  : public vvp_fun_part, public vvp_gen_event_s {
 
     private:
       void run_run();
+      vvp_net_t* region_net(void) { return net_; }
 
     private:
       vvp_vector4_t val_;
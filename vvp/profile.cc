@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2014 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+# include  "profile.h"
+# include  "codes.h"
+# include  "schedule.h"
+# include  "vpi_priv.h"
+# include  <algorithm>
+# include  <map>
+# include  <string>
+# include  <typeinfo>
+# include  <vector>
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <ctime>
+# include  <cassert>
+# include  <sys/time.h>
+#ifdef __GNUC__
+# include  <cxxabi.h>
+#endif
+
+bool profile_flag = false;
+
+static std::string profile_path;
+
+/*
+ * There is an entry for each kind of thing that runs in each
+ * scope. The kind is "thread" for threads, and otherwise the type of
+ * the functor or event. The kind strings are kept unique so that the
+ * pointers can be compared.
+ */
+struct profile_entry_s {
+      struct __vpiScope*scope;
+      const char*kind;
+      unsigned long count;
+      unsigned long opcodes;
+      unsigned long long ns;
+};
+
+typedef std::pair<struct __vpiScope*,const char*> profile_key_t;
+static std::map<profile_key_t,profile_entry_s> profile_entries;
+
+  /* The scopes of the nets, and of their functors. */
+static std::map<vvp_net_t*,struct __vpiScope*> net_scopes;
+static std::map<const void*,profile_entry_s*> fun_entries;
+
+  /* The entries that are being charged, innermost last. */
+struct profile_frame_s {
+      profile_entry_s*entry;
+      unsigned long long start;
+};
+static std::vector<profile_frame_s> profile_stack;
+
+static unsigned long long profile_clock(void)
+{
+#ifdef CLOCK_MONOTONIC
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      return tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#endif
+}
+
+/*
+ * Return a readable and unique name for the type.
+ */
+static const char* type_name(const std::type_info&type)
+{
+      static std::map<const std::type_info*,std::string> names;
+
+      std::map<const std::type_info*,std::string>::iterator cur
+	    = names.find(&type);
+      if (cur != names.end())
+	    return cur->second.c_str();
+
+      std::string text = type.name();
+#ifdef __GNUC__
+      int status = 0;
+      char*tmp = abi::__cxa_demangle(type.name(), 0, 0, &status);
+      if (tmp && status == 0)
+	    text = tmp;
+      free(tmp);
+#endif
+      return (names[&type] = text).c_str();
+}
+
+static profile_entry_s* find_entry(struct __vpiScope*scope, const char*kind)
+{
+      profile_key_t key (scope, kind);
+      std::map<profile_key_t,profile_entry_s>::iterator cur
+	    = profile_entries.find(key);
+      if (cur != profile_entries.end())
+	    return &cur->second;
+
+      profile_entry_s&entry = profile_entries[key];
+      entry.scope = scope;
+      entry.kind = kind;
+      entry.count = 0;
+      entry.opcodes = 0;
+      entry.ns = 0;
+      return &entry;
+}
+
+void profile_init(const char*path)
+{
+      profile_flag = true;
+      profile_path = path;
+}
+
+void profile_define_net(vvp_net_t*net, struct __vpiScope*scope)
+{
+      net_scopes[net] = scope;
+}
+
+static void enter_entry(profile_entry_s*entry)
+{
+      unsigned long long now = profile_clock();
+      if (! profile_stack.empty()) {
+	    profile_frame_s&top = profile_stack.back();
+	    top.entry->ns += now - top.start;
+      }
+
+      profile_frame_s frame;
+      frame.entry = entry;
+      frame.start = now;
+      profile_stack.push_back(frame);
+      entry->count += 1;
+}
+
+void profile_leave(unsigned long opcodes)
+{
+      assert(! profile_stack.empty());
+      unsigned long long now = profile_clock();
+
+      profile_frame_s&top = profile_stack.back();
+      top.entry->ns += now - top.start;
+      top.entry->opcodes += opcodes;
+      profile_stack.pop_back();
+
+      if (! profile_stack.empty())
+	    profile_stack.back().start = now;
+}
+
+void profile_enter_thread(struct __vpiScope*scope)
+{
+      static const char thread_kind[] = "thread";
+      enter_entry(find_entry(scope, thread_kind));
+}
+
+/*
+ * Find the entry for the functor of a net. The entries are cached by
+ * the address of the complete functor object, since that is also
+ * what the generic events for the functor lead to.
+ */
+static profile_entry_s* net_entry(vvp_net_t*net)
+{
+      const void*key = dynamic_cast<const void*>(net->fun);
+      std::map<const void*,profile_entry_s*>::iterator cur
+	    = fun_entries.find(key);
+      if (cur != fun_entries.end())
+	    return cur->second;
+
+      struct __vpiScope*scope = 0;
+      std::map<vvp_net_t*,struct __vpiScope*>::iterator sdx
+	    = net_scopes.find(net);
+      if (sdx != net_scopes.end())
+	    scope = sdx->second;
+
+      const char*kind = net->fun? type_name(typeid(*net->fun)) : "net";
+      profile_entry_s*entry = find_entry(scope, kind);
+      if (net->fun)
+	    fun_entries[key] = entry;
+      return entry;
+}
+
+void profile_enter_net(vvp_net_t*net)
+{
+      enter_entry(net_entry(net));
+}
+
+/*
+ * A generic event is most often for a functor, but all that is
+ * known here is the event object. The first time that an event is
+ * seen, the functors of all the nets are added to the cache, so that
+ * the scope of the functor can be found. Events for other objects
+ * are charged to the type of the object.
+ */
+void profile_enter_event(vvp_gen_event_s*obj)
+{
+      static bool nets_cached = false;
+
+      if (obj == 0) {
+	    profile_enter_other("event");
+	    return;
+      }
+
+      if (! nets_cached) {
+	    nets_cached = true;
+	    for (std::map<vvp_net_t*,struct __vpiScope*>::iterator idx
+		       = net_scopes.begin() ; idx != net_scopes.end() ; ++ idx) {
+		  if (idx->first->fun)
+			net_entry(idx->first);
+	    }
+      }
+
+      std::map<const void*,profile_entry_s*>::iterator cur
+	    = fun_entries.find(dynamic_cast<const void*>(obj));
+      if (cur != fun_entries.end())
+	    enter_entry(cur->second);
+      else
+	    enter_entry(find_entry(0, type_name(typeid(*obj))));
+}
+
+void profile_enter_other(const char*what)
+{
+      enter_entry(find_entry(0, what));
+}
+
+/*
+ * Write the names of the scope and its parents, outermost first, with
+ * the separator between them.
+ */
+static std::string scope_path(struct __vpiScope*scope, char sep)
+{
+      if (scope == 0)
+	    return "(no scope)";
+
+      std::string path = scope->name;
+      for (scope = scope->scope ; scope ; scope = scope->scope)
+	    path = std::string(scope->name) + sep + path;
+      return path;
+}
+
+/*
+ * The instruction counts are kept in an open addressed hash table
+ * keyed by the address of the instruction, since this is done for
+ * every instruction that runs. The opcode is saved the first time the
+ * instruction runs, because some opcodes replace themselves with a
+ * specialized version that is not in the opcode table.
+ */
+struct profile_code_s {
+      vvp_code_t code;
+      vvp_code_fun opcode;
+      struct __vpiScope*scope;
+      unsigned long count;
+};
+
+static profile_code_s*code_table = 0;
+static size_t code_table_mask = 0;
+static size_t code_table_used = 0;
+
+static inline size_t code_hash(vvp_code_t code)
+{
+      size_t key = (size_t)code / sizeof(struct vvp_code_s);
+      return key * 0x9e3779b1UL;
+}
+
+static void code_table_grow(void)
+{
+      profile_code_s*old_table = code_table;
+      size_t old_size = code_table? code_table_mask + 1 : 0;
+
+      size_t size = old_size? 2 * old_size : 1024;
+      code_table = new profile_code_s[size];
+      code_table_mask = size - 1;
+      for (size_t idx = 0 ; idx < size ; idx += 1)
+	    code_table[idx].code = 0;
+
+      for (size_t idx = 0 ; idx < old_size ; idx += 1) {
+	    if (old_table[idx].code == 0)
+		  continue;
+	    size_t hdx = code_hash(old_table[idx].code) & code_table_mask;
+	    while (code_table[hdx].code)
+		  hdx = (hdx + 1) & code_table_mask;
+	    code_table[hdx] = old_table[idx];
+      }
+
+      delete[]old_table;
+}
+
+void profile_count_code(vvp_code_t code, struct __vpiScope*scope)
+{
+      if (code_table_used >= code_table_mask / 2)
+	    code_table_grow();
+
+      size_t hdx = code_hash(code) & code_table_mask;
+      for (;;) {
+	    profile_code_s&cur = code_table[hdx];
+	    if (cur.code == code) {
+		  cur.count += 1;
+		  return;
+	    }
+	    if (cur.code == 0)
+		  break;
+	    hdx = (hdx + 1) & code_table_mask;
+      }
+
+      profile_code_s&cur = code_table[hdx];
+      cur.code = code;
+      cur.opcode = code->opcode;
+      cur.scope = scope;
+      cur.count = 1;
+      code_table_used += 1;
+}
+
+static bool code_count_less(const profile_code_s*a, const profile_code_s*b)
+{
+      if (a->count != b->count)
+	    return a->count > b->count;
+      return a->code < b->code;
+}
+
+static std::string code_mnemonic(vvp_code_fun opcode)
+{
+      const char*name = codespace_mnemonic(opcode);
+      if (name)
+	    return name;
+
+      char buf[64];
+      snprintf(buf, sizeof buf, "(opcode %p)", (void*)opcode);
+      return buf;
+}
+
+/*
+ * Write the name of the source file and the line number of the
+ * %file_line instruction before the instruction in the same thread.
+ * The %file_line instructions are only there if the design was
+ * compiled with them.
+ */
+static std::string code_location(vvp_code_t code)
+{
+      vvp_code_t line = codespace_file_line(code);
+      if (line == 0)
+	    return "(no %file_line)";
+
+      char buf[32];
+      snprintf(buf, sizeof buf, ":%d", vpi_get(vpiLineNo, line->handle));
+      return std::string(vpi_get_str(vpiFile, line->handle)) + buf;
+}
+
+static void report_code(FILE*fd)
+{
+      const size_t hot_code_count = 25;
+
+      unsigned long long total_count = 0;
+      std::vector<const profile_code_s*> codes;
+      std::map<std::string,unsigned long long> opcodes;
+      for (size_t idx = 0 ; code_table && idx <= code_table_mask ; idx += 1) {
+	    const profile_code_s&cur = code_table[idx];
+	    if (cur.code == 0)
+		  continue;
+	    codes.push_back(&cur);
+	    opcodes[code_mnemonic(cur.opcode)] += cur.count;
+	    total_count += cur.count;
+      }
+
+      double total = total_count? (double)total_count : 1.0;
+
+      std::vector<std::pair<unsigned long long,std::string> > list;
+      for (std::map<std::string,unsigned long long>::iterator cur
+		 = opcodes.begin() ; cur != opcodes.end() ; ++ cur)
+	    list.push_back(std::make_pair(cur->second, cur->first));
+      std::sort(list.rbegin(), list.rend());
+
+      fprintf(fd, "#\n# Opcodes:\n");
+      fprintf(fd, "#          count      %%  opcode\n");
+      for (size_t idx = 0 ; idx < list.size() ; idx += 1) {
+	    fprintf(fd, "%16llu %6.2f  %s\n", list[idx].first,
+		    100.0 * list[idx].first / total, list[idx].second.c_str());
+      }
+
+      std::sort(codes.begin(), codes.end(), code_count_less);
+      if (codes.size() > hot_code_count)
+	    codes.resize(hot_code_count);
+
+      fprintf(fd, "#\n# Hot code:\n");
+      fprintf(fd, "#          count      %%  opcode        location  scope\n");
+      for (size_t idx = 0 ; idx < codes.size() ; idx += 1) {
+	    fprintf(fd, "%16lu %6.2f  %-12s  %s  %s\n", codes[idx]->count,
+		    100.0 * codes[idx]->count / total,
+		    code_mnemonic(codes[idx]->opcode).c_str(),
+		    code_location(codes[idx]->code).c_str(),
+		    scope_path(codes[idx]->scope, '.').c_str());
+      }
+}
+
+struct profile_total_s {
+      std::string name;
+      unsigned long count;
+      unsigned long opcodes;
+      unsigned long long ns;
+
+      bool operator < (const profile_total_s&that) const
+      {
+	    if (ns != that.ns)
+		  return ns > that.ns;
+	    return name < that.name;
+      }
+};
+
+static void add_total(std::map<std::string,profile_total_s>&totals,
+		      const std::string&name, const profile_entry_s&entry)
+{
+      profile_total_s&total = totals[name];
+      if (total.name.empty()) {
+	    total.name = name;
+	    total.count = 0;
+	    total.opcodes = 0;
+	    total.ns = 0;
+      }
+      total.count += entry.count;
+      total.opcodes += entry.opcodes;
+      total.ns += entry.ns;
+}
+
+static std::vector<profile_total_s>
+sorted_totals(const std::map<std::string,profile_total_s>&totals)
+{
+      std::vector<profile_total_s> list;
+      for (std::map<std::string,profile_total_s>::const_iterator cur
+		 = totals.begin() ; cur != totals.end() ; ++ cur)
+	    list.push_back(cur->second);
+      std::sort(list.begin(), list.end());
+      return list;
+}
+
+void profile_report(void)
+{
+      assert(profile_flag);
+
+      FILE*fd = fopen(profile_path.c_str(), "w");
+      if (fd == 0) {
+	    perror(profile_path.c_str());
+	    return;
+      }
+
+      std::string folded_path = profile_path + ".folded";
+      FILE*folded = fopen(folded_path.c_str(), "w");
+      if (folded == 0)
+	    perror(folded_path.c_str());
+
+      unsigned long long total_ns = 0;
+      std::map<std::string,profile_total_s> scopes;
+      std::map<std::string,profile_total_s> kinds;
+      for (std::map<profile_key_t,profile_entry_s>::iterator cur
+		 = profile_entries.begin() ; cur != profile_entries.end() ; ++ cur) {
+	    const profile_entry_s&entry = cur->second;
+	    total_ns += entry.ns;
+	    add_total(scopes, scope_path(entry.scope, '.'), entry);
+	    add_total(kinds, entry.kind, entry);
+
+	    if (folded && entry.ns > 0) {
+		  fprintf(folded, "%s;%s %llu\n",
+			  scope_path(entry.scope, ';').c_str(),
+			  entry.kind, entry.ns);
+	    }
+      }
+
+      double total = total_ns? (double)total_ns : 1.0;
+
+      fprintf(fd, "# vvp profile, %.6f seconds charged\n", total_ns / 1e9);
+      fprintf(fd, "#\n# Scopes:\n");
+      fprintf(fd, "#   seconds      %%        opcodes       runs  scope\n");
+      std::vector<profile_total_s> list = sorted_totals(scopes);
+      for (size_t idx = 0 ; idx < list.size() ; idx += 1) {
+	    fprintf(fd, "%11.6f %6.2f %14lu %10lu  %s\n",
+		    list[idx].ns / 1e9, 100.0 * list[idx].ns / total,
+		    list[idx].opcodes, list[idx].count,
+		    list[idx].name.c_str());
+      }
+
+      fprintf(fd, "#\n# Kinds:\n");
+      fprintf(fd, "#   seconds      %%        opcodes       runs  kind\n");
+      list = sorted_totals(kinds);
+      for (size_t idx = 0 ; idx < list.size() ; idx += 1) {
+	    fprintf(fd, "%11.6f %6.2f %14lu %10lu  %s\n",
+		    list[idx].ns / 1e9, 100.0 * list[idx].ns / total,
+		    list[idx].opcodes, list[idx].count,
+		    list[idx].name.c_str());
+      }
+
+      report_code(fd);
+
+      fclose(fd);
+      if (folded)
+	    fclose(folded);
+}
@@ -0,0 +1,80 @@
+#ifndef __profile_H
+#define __profile_H
+/*
+ * Copyright (c) 2014 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+class vvp_net_t;
+struct vvp_gen_event_s;
+struct vvp_code_s;
+struct __vpiScope;
+
+/*
+ * The profiler charges the run time of the simulation to scopes. The
+ * time that threads run is charged to the scope of the thread, along
+ * with the number of opcodes that they execute, and the time of the
+ * scheduled net events is charged to the type and the scope of the
+ * functor that they are for. The time is exclusive: while a thread
+ * or event runs inside another, the outer one is not charged. The
+ * work that a thread or event does by propagating values through the
+ * netlist without scheduling more events is charged to it.
+ *
+ * The profile_flag is true if profiling was requested. Everything
+ * else here must only be used if it is set.
+ */
+extern bool profile_flag;
+
+/*
+ * Turn on profiling, and write the report to the named file when the
+ * simulation is done. The collapsed stacks, for flame graph tools,
+ * are written to the same name with ".folded" appended.
+ */
+extern void profile_init(const char*path);
+
+/*
+ * The compiler tells the profiler the scope of each net that it
+ * defines, so that events can be charged to the scope.
+ */
+extern void profile_define_net(vvp_net_t*net, struct __vpiScope*scope);
+
+/*
+ * Start charging time to a thread of the scope, an event for the
+ * functor of the net, or a generic event. The profile_leave function
+ * stops charging time to the most recent of these, and adds the
+ * count of opcodes.
+ */
+extern void profile_enter_thread(struct __vpiScope*scope);
+extern void profile_enter_net(vvp_net_t*net);
+extern void profile_enter_event(vvp_gen_event_s*obj);
+extern void profile_enter_other(const char*what);
+extern void profile_leave(unsigned long opcodes =0);
+
+/*
+ * Count an execution of the instruction by a thread of the scope. The
+ * report has the counts summed by opcode, and lists the instructions
+ * that were executed the most with their %file_line locations.
+ */
+extern void profile_count_code(struct vvp_code_s*code,
+			       struct __vpiScope*scope);
+
+/*
+ * Write the report files.
+ */
+extern void profile_report(void);
+
+#endif
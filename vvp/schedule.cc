@@ -22,19 +22,35 @@
 # include  "vpi_priv.h"
 # include  "slab.h"
 # include  "compile.h"
+# include  "profile.h"
+#ifdef CHECK_WITH_VALGRIND
+# include  "vvp_cleanup.h"
+#endif
 # include  <new>
+# include  <map>
 # include  <typeinfo>
 # include  <csignal>
+# include  <climits>
+# include  <cstdio>
 # include  <cstdlib>
+# include  <cstring>
 # include  <cassert>
 
 # include  <iostream>
+#if defined(HAVE_LIBPTHREAD) && defined(__GNUC__)
+# define SCHED_THREADS
+# include  <algorithm>
+# include  <pthread.h>
+#endif
 
 unsigned long count_assign_events = 0;
 unsigned long count_gen_events = 0;
 unsigned long count_thread_events = 0;
   // Count the time events (A time cell created)
 unsigned long count_time_events = 0;
+  // Count the batches run by the -j workers, and the events in them.
+unsigned long count_batches = 0;
+unsigned long count_batch_events = 0;
 
 
 
@@ -42,8 +58,9 @@ unsigned long count_time_events = 0;
  * The event_s and event_time_s structures implement the Verilog
  * stratified event queue.
  *
- * The event_time_s objects are one per time step. Each time step in
- * turn contains a list of event_s objects that are the actual events.
+ * The event_time_s objects are one per time step, and hold the
+ * absolute simulation time of the step. Each time step in turn
+ * contains a list of event_s objects that are the actual events.
  *
  * The event_s objects are base classes for the more specific sort of
  * event.
@@ -56,6 +73,18 @@ struct event_s {
 	// Write something about the event to stderr
       virtual void single_step_display(void);
 
+	// Start charging the profile for the event.
+      virtual void profile_enter(void);
+
+	// The net whose region this event is confined to, or nil if
+	// the event must be run alone. An event with a region can be
+	// run in a parallel batch (see schedule_run_batch_), where
+	// run_region runs it, and count_event counts it in the event
+	// statistics on the main thread instead.
+      virtual vvp_net_t* region_net(void);
+      virtual void run_region(void);
+      virtual void count_event(void);
+
 	// Fallback new/delete
       static void*operator new (size_t size) { return ::new char[size]; }
       static void operator delete(void*ptr)  { ::delete[]( (char*)ptr ); }
@@ -66,6 +95,25 @@ void event_s::single_step_display(void)
       std::cerr << "event_s: Step into event " << typeid(*this).name() << std::endl;
 }
 
+void event_s::profile_enter(void)
+{
+      profile_enter_other("event");
+}
+
+vvp_net_t* event_s::region_net(void)
+{
+      return 0;
+}
+
+void event_s::run_region(void)
+{
+      run_run();
+}
+
+void event_s::count_event(void)
+{
+}
+
 struct event_time_s {
       event_time_s() {
 	    count_time_events += 1;
@@ -77,7 +125,7 @@ struct event_time_s {
 	    del_thr = 0;
 	    next = NULL;
       }
-      vvp_time64_t delay;
+      vvp_time64_t time;
 
       struct event_s*start;
       struct event_s*active;
@@ -101,12 +149,60 @@ void vvp_gen_event_s::single_step_display(void)
       cerr << "vvp_gen_event_s: Step into event " << typeid(*this).name() << endl;
 }
 
+vvp_net_t* vvp_gen_event_s::region_net(void)
+{
+      return 0;
+}
+
+#ifdef SCHED_THREADS
+/*
+ * While a parallel batch runs, each thread that runs region events
+ * points sched_worker at its own sched_worker_s. The events that a
+ * region event schedules are then not put into the queues, which are
+ * shared, but recorded here with the position in the batch of the
+ * event that scheduled them. See schedule_run_batch_.
+ */
+struct sched_defer_s {
+      size_t batch_pos;
+      struct event_s*cur;
+      vvp_time64_t delay;
+      int select_queue;
+};
+
+struct sched_worker_s {
+      size_t batch_pos;
+      std::vector<sched_defer_s> deferred;
+};
+
+static __thread sched_worker_s*sched_worker = 0;
+
+  // The slab heaps are not thread-safe, so the events that are
+  // allocated in a parallel batch are allocated under this lock. They
+  // are all freed by the main thread.
+static pthread_mutex_t sched_heap_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+static inline void* sched_alloc_slab_(slab_t<SLAB_SIZE,CHUNK_COUNT>&heap)
+{
+#ifdef SCHED_THREADS
+      if (sched_worker) {
+	    pthread_mutex_lock(&sched_heap_mutex);
+	    void*ptr = heap.alloc_slab();
+	    pthread_mutex_unlock(&sched_heap_mutex);
+	    return ptr;
+      }
+#endif
+      return heap.alloc_slab();
+}
+
 /*
  * Derived event types
  */
 struct vthread_event_s : public event_s {
       vthread_t thr;
       void run_run(void);
+      void profile_enter(void);
       void single_step_display(void);
 
       static void* operator new(size_t);
@@ -119,6 +215,11 @@ void vthread_event_s::run_run(void)
       vthread_run(thr);
 }
 
+void vthread_event_s::profile_enter(void)
+{
+      profile_enter_other("thread wakeup");
+}
+
 void vthread_event_s::single_step_display(void)
 {
       struct __vpiScope*scope = vthread_scope(thr);
@@ -133,7 +234,7 @@ static slab_t<sizeof(vthread_event_s),VTHR_CHUNK_COUNT> vthread_event_heap;
 inline void* vthread_event_s::operator new(size_t size)
 {
       assert(size == sizeof(vthread_event_s));
-      return vthread_event_heap.alloc_slab();
+      return sched_alloc_slab_(vthread_event_heap);
 }
 
 void vthread_event_s::operator delete(void*dptr)
@@ -181,7 +282,11 @@ struct assign_vector4_event_s  : public event_s {
 	/* Width of the destination vector. */
       unsigned vwid;
       void run_run(void);
+      void profile_enter(void);
       void single_step_display(void);
+      vvp_net_t* region_net(void) { return ptr.ptr(); }
+      void run_region(void);
+      void count_event(void) { count_assign_events += 1; }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -190,12 +295,22 @@ struct assign_vector4_event_s  : public event_s {
 void assign_vector4_event_s::run_run(void)
 {
       count_assign_events += 1;
+      run_region();
+}
+
+void assign_vector4_event_s::run_region(void)
+{
       if (vwid > 0)
 	    vvp_send_vec4_pv(ptr, val, base, val.size(), vwid, 0);
       else
 	    vvp_send_vec4(ptr, val, 0);
 }
 
+void assign_vector4_event_s::profile_enter(void)
+{
+      profile_enter_net(ptr.ptr());
+}
+
 void assign_vector4_event_s::single_step_display(void)
 {
       cerr << "assign_vector4_event: Propagate val=" << val
@@ -208,7 +323,7 @@ static slab_t<sizeof(assign_vector4_event_s),ASSIGN4_CHUNK_COUNT> assign4_heap;
 inline void* assign_vector4_event_s::operator new(size_t size)
 {
       assert(size == sizeof(assign_vector4_event_s));
-      return assign4_heap.alloc_slab();
+      return sched_alloc_slab_(assign4_heap);
 }
 
 void assign_vector4_event_s::operator delete(void*dptr)
@@ -222,7 +337,11 @@ struct assign_vector8_event_s  : public event_s {
       vvp_net_ptr_t ptr;
       vvp_vector8_t val;
       void run_run(void);
+      void profile_enter(void);
       void single_step_display(void);
+      vvp_net_t* region_net(void) { return ptr.ptr(); }
+      void run_region(void);
+      void count_event(void) { count_assign_events += 1; }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -231,9 +350,19 @@ struct assign_vector8_event_s  : public event_s {
 void assign_vector8_event_s::run_run(void)
 {
       count_assign_events += 1;
+      run_region();
+}
+
+void assign_vector8_event_s::run_region(void)
+{
       vvp_send_vec8(ptr, val);
 }
 
+void assign_vector8_event_s::profile_enter(void)
+{
+      profile_enter_net(ptr.ptr());
+}
+
 void assign_vector8_event_s::single_step_display(void)
 {
       cerr << "assign_vector8_event: Propagate val=" << val << endl;
@@ -245,7 +374,7 @@ static slab_t<sizeof(assign_vector8_event_s),ASSIGN8_CHUNK_COUNT> assign8_heap;
 inline void* assign_vector8_event_s::operator new(size_t size)
 {
       assert(size == sizeof(assign_vector8_event_s));
-      return assign8_heap.alloc_slab();
+      return sched_alloc_slab_(assign8_heap);
 }
 
 void assign_vector8_event_s::operator delete(void*dptr)
@@ -259,7 +388,11 @@ struct assign_real_event_s  : public event_s {
       vvp_net_ptr_t ptr;
       double val;
       void run_run(void);
+      void profile_enter(void);
       void single_step_display(void);
+      vvp_net_t* region_net(void) { return ptr.ptr(); }
+      void run_region(void);
+      void count_event(void) { count_assign_events += 1; }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -268,9 +401,19 @@ struct assign_real_event_s  : public event_s {
 void assign_real_event_s::run_run(void)
 {
       count_assign_events += 1;
+      run_region();
+}
+
+void assign_real_event_s::run_region(void)
+{
       vvp_send_real(ptr, val, 0);
 }
 
+void assign_real_event_s::profile_enter(void)
+{
+      profile_enter_net(ptr.ptr());
+}
+
 void assign_real_event_s::single_step_display(void)
 {
       cerr << "assign_real_event: Propagate val=" << val << endl;
@@ -282,7 +425,7 @@ static slab_t<sizeof(assign_real_event_s),ASSIGNR_CHUNK_COUNT> assignr_heap;
 inline void* assign_real_event_s::operator new (size_t size)
 {
       assert(size == sizeof(assign_real_event_s));
-      return assignr_heap.alloc_slab();
+      return sched_alloc_slab_(assignr_heap);
 }
 
 void assign_real_event_s::operator delete(void*dptr)
@@ -298,6 +441,7 @@ struct assign_array_word_s  : public event_s {
       vvp_vector4_t val;
       unsigned off;
       void run_run(void);
+      void profile_enter(void);
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -309,13 +453,18 @@ void assign_array_word_s::run_run(void)
       array_set_word(mem, adr, off, val);
 }
 
+void assign_array_word_s::profile_enter(void)
+{
+      profile_enter_other("array word assign");
+}
+
 static const size_t ARRAY_W_CHUNK_COUNT = 8192 / sizeof(struct assign_array_word_s);
 static slab_t<sizeof(assign_array_word_s),ARRAY_W_CHUNK_COUNT> array_w_heap;
 
 inline void* assign_array_word_s::operator new (size_t size)
 {
       assert(size == sizeof(assign_array_word_s));
-      return array_w_heap.alloc_slab();
+      return sched_alloc_slab_(array_w_heap);
 }
 
 void assign_array_word_s::operator delete(void*ptr)
@@ -346,7 +495,9 @@ struct propagate_vector4_event_s : public event_s {
       vvp_vector4_t val;
 	/* Action */
       void run_run(void);
+      void profile_enter(void);
       void single_step_display(void);
+      vvp_net_t* region_net(void) { return net; }
 };
 
 void propagate_vector4_event_s::run_run(void)
@@ -354,6 +505,11 @@ void propagate_vector4_event_s::run_run(void)
       net->send_vec4(val, 0);
 }
 
+void propagate_vector4_event_s::profile_enter(void)
+{
+      profile_enter_net(net);
+}
+
 void propagate_vector4_event_s::single_step_display(void)
 {
       cerr << "propagate_vector4_event: Propagate val=" << val << endl;
@@ -370,7 +526,9 @@ struct propagate_real_event_s : public event_s {
       double val;
 	/* Action */
       void run_run(void);
+      void profile_enter(void);
       void single_step_display(void);
+      vvp_net_t* region_net(void) { return net; }
 };
 
 void propagate_real_event_s::run_run(void)
@@ -378,6 +536,11 @@ void propagate_real_event_s::run_run(void)
       net->send_real(val, 0);
 }
 
+void propagate_real_event_s::profile_enter(void)
+{
+      profile_enter_net(net);
+}
+
 void propagate_real_event_s::single_step_display(void)
 {
       cerr << "propagate_real_event: Propagate val=" << val << endl;
@@ -388,6 +551,7 @@ struct assign_array_r_word_s  : public event_s {
       unsigned adr;
       double val;
       void run_run(void);
+      void profile_enter(void);
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -398,13 +562,18 @@ void assign_array_r_word_s::run_run(void)
       count_assign_events += 1;
       array_set_word(mem, adr, val);
 }
+
+void assign_array_r_word_s::profile_enter(void)
+{
+      profile_enter_other("array word assign");
+}
 static const size_t ARRAY_R_W_CHUNK_COUNT = 8192 / sizeof(struct assign_array_r_word_s);
 static slab_t<sizeof(assign_array_r_word_s),ARRAY_R_W_CHUNK_COUNT> array_r_w_heap;
 
 inline void* assign_array_r_word_s::operator new(size_t size)
 {
       assert(size == sizeof(assign_array_r_word_s));
-      return array_r_w_heap.alloc_slab();
+      return sched_alloc_slab_(array_r_w_heap);
 }
 
 void assign_array_r_word_s::operator delete(void*ptr)
@@ -418,7 +587,11 @@ struct generic_event_s : public event_s {
       vvp_gen_event_t obj;
       bool delete_obj_when_done;
       void run_run(void);
+      void profile_enter(void);
       void single_step_display(void);
+      vvp_net_t* region_net(void);
+      void run_region(void);
+      void count_event(void) { count_gen_events += 1; }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -434,6 +607,23 @@ void generic_event_s::run_run(void)
       }
 }
 
+vvp_net_t* generic_event_s::region_net(void)
+{
+      if (obj == 0 || delete_obj_when_done)
+	    return 0;
+      return obj->region_net();
+}
+
+void generic_event_s::run_region(void)
+{
+      obj->run_run();
+}
+
+void generic_event_s::profile_enter(void)
+{
+      profile_enter_event(obj);
+}
+
 void generic_event_s::single_step_display(void)
 {
       obj->single_step_display();
@@ -445,7 +635,7 @@ static slab_t<sizeof(generic_event_s),GENERIC_CHUNK_COUNT> generic_event_heap;
 inline void* generic_event_s::operator new(size_t size)
 {
       assert(size == sizeof(generic_event_s));
-      return generic_event_heap.alloc_slab();
+      return sched_alloc_slab_(generic_event_heap);
 }
 
 void generic_event_s::operator delete(void*ptr)
@@ -479,12 +669,322 @@ inline void event_time_s::operator delete(void*ptr, size_t)
 unsigned long count_time_pool(void) { return event_time_heap.pool; }
 
 /*
- * This is the head of the list of pending events. This includes all
- * the events that have not been executed yet, and reaches into the
- * future.
+ * This table lists the event heaps by name, for the statistics and
+ * for tuning the chunk counts at run time.
  */
+static const struct event_heap_s {
+      const char*name;
+      slab_counts_s*heap;
+} event_heaps[] = {
+      { "thread",  &vthread_event_heap },
+      { "assign4", &assign4_heap },
+      { "assign8", &assign8_heap },
+      { "assignr", &assignr_heap },
+      { "aword",   &array_w_heap },
+      { "arword",  &array_r_w_heap },
+      { "generic", &generic_event_heap },
+      { "time",    &event_time_heap },
+      { 0, 0 }
+};
+
+const char* schedule_heap_name(unsigned idx)
+{
+      return event_heaps[idx].name;
+}
+
+const slab_counts_s* schedule_heap_counts(unsigned idx)
+{
+      assert(event_heaps[idx].name);
+      return event_heaps[idx].heap;
+}
+
+bool schedule_heap_chunk_count(const char*name, size_t count)
+{
+      for (unsigned idx = 0 ; event_heaps[idx].name ; idx += 1) {
+	    if (strcmp(event_heaps[idx].name, name) != 0)
+		  continue;
+	    event_heaps[idx].heap->chunk_count = count;
+	    return true;
+      }
+
+      return false;
+}
+
+static vvp_time64_t schedule_time;
+
+/*
+ * The pending time steps are kept in one of two structures, selected
+ * at startup by schedule_use_timing_wheel(). Both hold the time steps
+ * that have not been executed yet, including the current time step,
+ * and reach into the future. There is at most one event_time_s object
+ * for any given time.
+ *
+ * By default, the time steps are kept in a list sorted by time. This
+ * is cheap for the common case where nearly all events are for the
+ * current or the next few time steps, but scheduling an event far
+ * in the future must walk the entire list.
+ *
+ * The timing wheel instead keeps the time steps within WHEEL_SIZE of
+ * the current time in a ring of slots indexed by the low bits of the
+ * time, so finding the time step for an event is a direct index. A
+ * bitmap of occupied slots makes finding the next time step cheap. The
+ * time steps further in the future are kept in a map, and are moved
+ * into the wheel as the current time comes within reach of them.
+ */
+static bool sched_wheel_flag = false;
+
 static struct event_time_s* sched_list = 0;
 
+static const unsigned WHEEL_BITS = 12;
+static const unsigned WHEEL_SIZE = 1U << WHEEL_BITS;
+static const unsigned WHEEL_MASK = WHEEL_SIZE - 1;
+static const unsigned WHEEL_MAP_BITS = 8 * sizeof(unsigned long);
+static const unsigned WHEEL_MAP_WORDS = WHEEL_SIZE / WHEEL_MAP_BITS;
+
+static struct event_time_s* sched_wheel[WHEEL_SIZE];
+static unsigned long sched_wheel_map[WHEEL_MAP_WORDS];
+static unsigned sched_wheel_count = 0;
+  // The wheel holds the time steps in [sched_wheel_base, sched_wheel_base+WHEEL_SIZE).
+static vvp_time64_t sched_wheel_base = 0;
+  // The far map holds all the later time steps.
+static std::map<vvp_time64_t,struct event_time_s*> sched_far;
+
+void schedule_use_timing_wheel(void)
+{
+      assert(sched_list == 0);
+      sched_wheel_flag = true;
+}
+
+static inline unsigned lowest_bit_(unsigned long word)
+{
+      assert(word != 0);
+#if defined(__GNUC__)
+      return __builtin_ctzl(word);
+#else
+      unsigned res = 0;
+      while ((word & 1UL) == 0) {
+	    word >>= 1;
+	    res += 1;
+      }
+      return res;
+#endif
+}
+
+static void sched_wheel_put_(struct event_time_s*ctim)
+{
+      unsigned slot = ctim->time & WHEEL_MASK;
+      assert(sched_wheel[slot] == 0);
+      sched_wheel[slot] = ctim;
+      sched_wheel_map[slot / WHEEL_MAP_BITS] |= 1UL << (slot % WHEEL_MAP_BITS);
+      sched_wheel_count += 1;
+}
+
+static struct event_time_s* sched_wheel_find_(vvp_time64_t time)
+{
+      assert(time >= sched_wheel_base);
+
+      if ((time - sched_wheel_base) < WHEEL_SIZE) {
+	    struct event_time_s*ctim = sched_wheel[time & WHEEL_MASK];
+	    if (ctim) {
+		  assert(ctim->time == time);
+		  return ctim;
+	    }
+
+	    ctim = new struct event_time_s;
+	    ctim->time = time;
+	    sched_wheel_put_(ctim);
+	    return ctim;
+      }
+
+      std::map<vvp_time64_t,struct event_time_s*>::iterator cur
+	    = sched_far.lower_bound(time);
+      if (cur != sched_far.end() && cur->first == time)
+	    return cur->second;
+
+      struct event_time_s*ctim = new struct event_time_s;
+      ctim->time = time;
+      sched_far.insert(cur, std::make_pair(time, ctim));
+      return ctim;
+}
+
+/*
+ * Return the earliest time step. The wheel slots are scanned starting
+ * with the slot for the base time, and wrapping around. The far time
+ * steps are only needed if the wheel is empty.
+ */
+static struct event_time_s* sched_wheel_head_(void)
+{
+      if (sched_wheel_count == 0) {
+	    if (sched_far.empty())
+		  return 0;
+	    return sched_far.begin()->second;
+      }
+
+      unsigned start = sched_wheel_base & WHEEL_MASK;
+      unsigned wdx = start / WHEEL_MAP_BITS;
+      unsigned long word = sched_wheel_map[wdx] & (-1UL << (start % WHEEL_MAP_BITS));
+
+      for (unsigned cnt = 0 ;  cnt <= WHEEL_MAP_WORDS ;  cnt += 1) {
+	    if (word != 0)
+		  return sched_wheel[wdx*WHEEL_MAP_BITS + lowest_bit_(word)];
+
+	    wdx = (wdx + 1) % WHEEL_MAP_WORDS;
+	    word = sched_wheel_map[wdx];
+      }
+
+      assert(0);
+      return 0;
+}
+
+static void sched_wheel_remove_(struct event_time_s*ctim)
+{
+      unsigned slot = ctim->time & WHEEL_MASK;
+      assert(sched_wheel[slot] == ctim);
+      sched_wheel[slot] = 0;
+      sched_wheel_map[slot / WHEEL_MAP_BITS] &= ~(1UL << (slot % WHEEL_MAP_BITS));
+      sched_wheel_count -= 1;
+}
+
+/*
+ * Move the wheel forward to the new current time. Any far time steps
+ * that now fit in the wheel are moved into it.
+ */
+static void sched_wheel_advance_(vvp_time64_t time)
+{
+      assert(time >= sched_wheel_base);
+      sched_wheel_base = time;
+
+      while (! sched_far.empty()) {
+	    std::map<vvp_time64_t,struct event_time_s*>::iterator cur
+		  = sched_far.begin();
+	    if ((cur->first - sched_wheel_base) >= WHEEL_SIZE)
+		  break;
+
+	    sched_wheel_put_(cur->second);
+	    sched_far.erase(cur);
+      }
+}
+
+static struct event_time_s* sched_list_find_(vvp_time64_t time)
+{
+      struct event_time_s*prev = 0;
+      struct event_time_s*ctim = sched_list;
+
+      while (ctim && (ctim->time < time)) {
+	    prev = ctim;
+	    ctim = ctim->next;
+      }
+
+      if (ctim && (ctim->time == time))
+	    return ctim;
+
+      struct event_time_s*tmp = new struct event_time_s;
+      tmp->time = time;
+      tmp->next = ctim;
+      if (prev)
+	    prev->next = tmp;
+      else
+	    sched_list = tmp;
+
+      return tmp;
+}
+
+/*
+ * Get the time step for the given absolute time, creating it if it
+ * does not yet exist.
+ */
+static inline struct event_time_s* sched_find_(vvp_time64_t time)
+{
+      if (sched_wheel_flag)
+	    return sched_wheel_find_(time);
+      else
+	    return sched_list_find_(time);
+}
+
+/*
+ * Get the earliest pending time step, or nil if there are none.
+ */
+static inline struct event_time_s* sched_head_(void)
+{
+      if (sched_wheel_flag)
+	    return sched_wheel_head_();
+      else
+	    return sched_list;
+}
+
+/*
+ * Remove the finished time step, which must be the head.
+ */
+static inline void sched_pop_head_(struct event_time_s*ctim)
+{
+      if (sched_wheel_flag) {
+	    sched_wheel_remove_(ctim);
+      } else {
+	    assert(ctim == sched_list);
+	    sched_list = ctim->next;
+      }
+}
+
+#ifdef CHECK_WITH_VALGRIND
+/*
+ * Delete the events of a circular list, whose head points at the last
+ * event in the list.
+ */
+static void sched_delete_events_(struct event_s*list)
+{
+      if (list == 0)
+	    return;
+
+      struct event_s*cur = list->next;
+      list->next = 0;
+      while (cur) {
+	    struct event_s*tmp = cur->next;
+	    delete cur;
+	    cur = tmp;
+      }
+}
+
+static void sched_delete_time_(struct event_time_s*ctim)
+{
+      sched_delete_events_(ctim->start);
+      sched_delete_events_(ctim->active);
+      sched_delete_events_(ctim->nbassign);
+      sched_delete_events_(ctim->rwsync);
+      sched_delete_events_(ctim->rosync);
+      sched_delete_events_(ctim->del_thr);
+      delete ctim;
+}
+
+/*
+ * Delete the time steps that are still pending when the simulation
+ * ends, from the wheel slots and the far map or from the list.
+ */
+void schedule_delete(void)
+{
+      while (sched_list) {
+	    struct event_time_s*tmp = sched_list->next;
+	    sched_delete_time_(sched_list);
+	    sched_list = tmp;
+      }
+
+      for (unsigned slot = 0 ;  slot < WHEEL_SIZE ;  slot += 1) {
+	    if (sched_wheel[slot] == 0)
+		  continue;
+	    sched_delete_time_(sched_wheel[slot]);
+	    sched_wheel[slot] = 0;
+      }
+      for (unsigned idx = 0 ;  idx < WHEEL_MAP_WORDS ;  idx += 1)
+	    sched_wheel_map[idx] = 0;
+      sched_wheel_count = 0;
+
+      for (std::map<vvp_time64_t,struct event_time_s*>::iterator cur
+		 = sched_far.begin() ; cur != sched_far.end() ; ++ cur ) {
+	    sched_delete_time_(cur->second);
+      }
+      sched_far.clear();
+}
+#endif
+
 /*
  * This is a list of initialization events. The setup puts
  * initializations in this list so that they happen before the
@@ -590,59 +1090,20 @@ typedef enum event_queue_e { SEQ_START, SEQ_ACTIVE, SEQ_NBASSIGN,
 static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 			    event_queue_t select_queue)
 {
+#ifdef SCHED_THREADS
+      if (sched_worker) {
+	    sched_defer_s rec;
+	    rec.batch_pos = sched_worker->batch_pos;
+	    rec.cur = cur;
+	    rec.delay = delay;
+	    rec.select_queue = select_queue;
+	    sched_worker->deferred.push_back(rec);
+	    return;
+      }
+#endif
       cur->next = cur;
 
-      struct event_time_s*ctim = sched_list;
-
-      if (sched_list == 0) {
-	      /* Is the event_time list completely empty? Create the
-		 first event_time object. */
-	    ctim = new struct event_time_s;
-	    ctim->delay = delay;
-	    ctim->next  = 0;
-	    sched_list = ctim;
-
-      } else if (sched_list->delay > delay) {
-
-	      /* Am I looking for an event before the first event_time?
-		 If so, create a new event_time to go in front. */
-	    struct event_time_s*tmp = new struct event_time_s;
-	    tmp->delay = delay;
-	    tmp->next = ctim;
-	    ctim->delay -= delay;
-	    ctim = tmp;
-	    sched_list = ctim;
-
-      } else {
-	    struct event_time_s*prev = 0;
-
-	    while (ctim->next && (ctim->delay < delay)) {
-		  delay -= ctim->delay;
-		  prev = ctim;
-		  ctim = ctim->next;
-	    }
-
-	    if (ctim->delay > delay) {
-		  struct event_time_s*tmp = new struct event_time_s;
-		  tmp->delay = delay;
-		  tmp->next  = prev->next;
-		  prev->next = tmp;
-
-		  tmp->next->delay -= delay;
-		  ctim = tmp;
-
-	    } else if (ctim->delay == delay) {
-
-	    } else {
-		  assert(ctim->next == 0);
-		  struct event_time_s*tmp = new struct event_time_s;
-		  tmp->delay = delay - ctim->delay;
-		  tmp->next = 0;
-		  ctim->next = tmp;
-
-		  ctim = tmp;
-	    }
-      }
+      struct event_time_s*ctim = sched_find_(schedule_time + delay);
 
 	/* By this point, ctim is the event_time structure that is to
 	   receive the event at hand. Put the event in to the
@@ -724,12 +1185,10 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 
 static void schedule_event_push_(struct event_s*cur)
 {
-      if ((sched_list == 0) || (sched_list->delay > 0)) {
-	    schedule_event_(cur, 0, SEQ_ACTIVE);
-	    return;
-      }
-
-      struct event_time_s*ctim = sched_list;
+#ifdef SCHED_THREADS
+      assert(sched_worker == 0);
+#endif
+      struct event_time_s*ctim = sched_find_(schedule_time);
 
       if (ctim->active == 0) {
 	    cur->next = cur;
@@ -944,7 +1403,6 @@ void schedule_at_start_of_simtime(vvp_gen_event_t obj, vvp_time64_t delay)
       schedule_event_(cur, delay, SEQ_START);
 }
 
-static vvp_time64_t schedule_time;
 vvp_time64_t schedule_simtime(void)
 { return schedule_time; }
 
@@ -995,6 +1453,344 @@ static void run_rosync(struct event_time_s*ctim)
       }
 }
 
+/*
+ * Parallel evaluation of net regions (-j).
+ *
+ * The compiler partitions the nets into regions that do not pass
+ * values to each other (see compile_net_regions). When the active
+ * list of the current time step starts with events that are each
+ * confined to a region that is not serial, schedule_run_batch_ takes
+ * that prefix of the list as a batch. The events of the batch are
+ * grouped by region, and the groups are run by the main thread and
+ * the workers, each group in list order. Nothing that the events of
+ * one group touch is touched by another group, except the scheduler
+ * itself, so while a batch runs schedule_event_ only records the
+ * events that are scheduled. When the batch is done, the main thread
+ * puts the recorded events into the queues in the order of the batch
+ * events that scheduled them. That is the order in which the serial
+ * scheduler would have put them there, so the simulation results do
+ * not depend on the number of threads.
+ *
+ * A batch that is too small, or that has only one region, is not
+ * worth waking the workers for, so it is run in order by the main
+ * thread.
+ */
+static unsigned sched_thread_count = 1;
+
+#ifdef SCHED_THREADS
+static const size_t SCHED_BATCH_MIN = 32;
+
+  // The regions, by the region number stored in the nets, as a
+  // union-find forest so that links made at run time can join them,
+  // and the serial flags of the region roots.
+static std::vector<unsigned> sched_region_root;
+static std::vector<bool> sched_region_serial;
+
+  // The current batch, and the group of each event. The events of the
+  // group g are at the batch positions listed in the sched_group_list
+  // from sched_group_base[g] up to sched_group_base[g+1].
+static std::vector<struct event_s*> sched_batch;
+static std::vector<unsigned> sched_batch_group;
+static std::vector<size_t> sched_group_base;
+static std::vector<size_t> sched_group_fill;
+static std::vector<size_t> sched_group_list;
+static size_t sched_group_count = 0;
+static size_t sched_group_next = 0;
+
+  // The group of each region root in the current batch. The group
+  // is valid only if the stamp of the root is the current stamp.
+static std::vector<unsigned> sched_region_group;
+static std::vector<unsigned> sched_region_stamp;
+static unsigned sched_stamp = 0;
+
+static std::vector<sched_defer_s> sched_merge;
+
+  // The workers, including the main thread as worker 0.
+static sched_worker_s*sched_workers = 0;
+static pthread_mutex_t sched_run_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sched_run_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sched_done_cond = PTHREAD_COND_INITIALIZER;
+static unsigned long sched_run_generation = 0;
+static unsigned sched_run_busy = 0;
+
+static unsigned sched_region_find_(unsigned idx)
+{
+      while (sched_region_root[idx] != idx) {
+	    sched_region_root[idx] = sched_region_root[sched_region_root[idx]];
+	    idx = sched_region_root[idx];
+      }
+      return idx;
+}
+
+/*
+ * Get the region root of the event, or return false if the event
+ * must be run alone.
+ */
+static bool sched_event_region_(struct event_s*cur, unsigned&root)
+{
+      vvp_net_t*net = cur->region_net();
+      if (net == 0)
+	    return false;
+
+      unsigned id = net->region();
+      if (id >= sched_region_root.size())
+	    return false;
+
+      root = sched_region_find_(id);
+      return ! sched_region_serial[root];
+}
+
+static void sched_run_groups_(sched_worker_s*worker)
+{
+      sched_worker = worker;
+      for (;;) {
+	    size_t grp = __sync_fetch_and_add(&sched_group_next, 1);
+	    if (grp >= sched_group_count)
+		  break;
+
+	    for (size_t idx = sched_group_base[grp]
+		       ; idx < sched_group_base[grp+1] ; idx += 1) {
+		  size_t pos = sched_group_list[idx];
+		  worker->batch_pos = pos;
+		  sched_batch[pos]->run_region();
+	    }
+      }
+      sched_worker = 0;
+}
+
+static void* sched_worker_main_(void*arg)
+{
+      sched_worker_s*worker = (sched_worker_s*)arg;
+      unsigned long generation = 0;
+
+      pthread_mutex_lock(&sched_run_mutex);
+      for (;;) {
+	    while (sched_run_generation == generation)
+		  pthread_cond_wait(&sched_run_cond, &sched_run_mutex);
+	    generation = sched_run_generation;
+	    pthread_mutex_unlock(&sched_run_mutex);
+
+	    sched_run_groups_(worker);
+
+	    pthread_mutex_lock(&sched_run_mutex);
+	    sched_run_busy -= 1;
+	    if (sched_run_busy == 0)
+		  pthread_cond_signal(&sched_done_cond);
+      }
+      return 0;
+}
+
+static bool sched_defer_less_(const sched_defer_s&a, const sched_defer_s&b)
+{
+      return a.batch_pos < b.batch_pos;
+}
+
+/*
+ * Run a batch from the front of the active list of the current time
+ * step, or return false if the first event must be run alone.
+ */
+static bool schedule_run_batch_(struct event_time_s*ctim)
+{
+      if (sched_stamp == UINT_MAX) {
+	    std::fill(sched_region_stamp.begin(), sched_region_stamp.end(), 0);
+	    sched_stamp = 0;
+      }
+      sched_stamp += 1;
+
+	/* Take events from the front of the active list for as long
+	   as they have parallel regions, and number their regions. */
+      sched_batch.clear();
+      sched_batch_group.clear();
+      sched_group_count = 0;
+
+      struct event_s*tail = ctim->active;
+      struct event_s*cur = tail->next;
+      for (;;) {
+	    unsigned root;
+	    if (! sched_event_region_(cur, root))
+		  break;
+
+	    if (sched_region_stamp[root] != sched_stamp) {
+		  sched_region_stamp[root] = sched_stamp;
+		  sched_region_group[root] = sched_group_count;
+		  sched_group_count += 1;
+	    }
+	    sched_batch.push_back(cur);
+	    sched_batch_group.push_back(sched_region_group[root]);
+
+	    if (cur == tail)
+		  break;
+	    cur = cur->next;
+      }
+
+      if (sched_batch.empty())
+	    return false;
+
+      struct event_s*last = sched_batch.back();
+      if (last == tail)
+	    ctim->active = 0;
+      else
+	    tail->next = last->next;
+
+      size_t count = sched_batch.size();
+
+      if (count < SCHED_BATCH_MIN || sched_group_count < 2) {
+	    for (size_t pos = 0 ; pos < count ; pos += 1) {
+		  sched_batch[pos]->run_run();
+		  delete sched_batch[pos];
+	    }
+	    return true;
+      }
+
+	/* Sort the batch positions by group, keeping the list order
+	   within each group. */
+      sched_group_base.assign(sched_group_count+1, 0);
+      for (size_t pos = 0 ; pos < count ; pos += 1)
+	    sched_group_base[sched_batch_group[pos]+1] += 1;
+      for (size_t grp = 0 ; grp < sched_group_count ; grp += 1)
+	    sched_group_base[grp+1] += sched_group_base[grp];
+
+      sched_group_fill.assign(sched_group_base.begin(),
+			      sched_group_base.end()-1);
+      sched_group_list.resize(count);
+      for (size_t pos = 0 ; pos < count ; pos += 1) {
+	    unsigned grp = sched_batch_group[pos];
+	    sched_group_list[sched_group_fill[grp]] = pos;
+	    sched_group_fill[grp] += 1;
+      }
+
+      for (size_t pos = 0 ; pos < count ; pos += 1)
+	    sched_batch[pos]->count_event();
+      count_batches += 1;
+      count_batch_events += count;
+
+	/* Start the workers, run groups along with them, and wait
+	   for them to finish. */
+      pthread_mutex_lock(&sched_run_mutex);
+      sched_group_next = 0;
+      sched_run_generation += 1;
+      sched_run_busy = sched_thread_count - 1;
+      pthread_cond_broadcast(&sched_run_cond);
+      pthread_mutex_unlock(&sched_run_mutex);
+
+      sched_run_groups_(sched_workers+0);
+
+      pthread_mutex_lock(&sched_run_mutex);
+      while (sched_run_busy > 0)
+	    pthread_cond_wait(&sched_done_cond, &sched_run_mutex);
+      pthread_mutex_unlock(&sched_run_mutex);
+
+	/* Put the recorded events into the queues in batch order. The
+	   events recorded for one batch event are all recorded by one
+	   worker, in the order they were scheduled, and the sort
+	   keeps that order. */
+      sched_merge.clear();
+      for (unsigned idx = 0 ; idx < sched_thread_count ; idx += 1) {
+	    std::vector<sched_defer_s>&deferred = sched_workers[idx].deferred;
+	    sched_merge.insert(sched_merge.end(), deferred.begin(), deferred.end());
+	    deferred.clear();
+      }
+      std::stable_sort(sched_merge.begin(), sched_merge.end(), sched_defer_less_);
+      for (size_t idx = 0 ; idx < sched_merge.size() ; idx += 1) {
+	    sched_defer_s&rec = sched_merge[idx];
+	    schedule_event_(rec.cur, rec.delay, (event_queue_t)rec.select_queue);
+      }
+
+      for (size_t pos = 0 ; pos < count ; pos += 1)
+	    delete sched_batch[pos];
+
+      return true;
+}
+#endif
+
+bool schedule_use_threads(unsigned count)
+{
+#ifdef SCHED_THREADS
+      sched_thread_count = count > 0 ? count : 1;
+      return true;
+#else
+      (void)count;
+      return false;
+#endif
+}
+
+unsigned schedule_thread_count(void)
+{
+      return sched_thread_count;
+}
+
+void schedule_use_regions(std::vector<bool>&serial)
+{
+#ifdef SCHED_THREADS
+      assert(sched_workers == 0);
+      sched_region_root.resize(serial.size());
+      for (unsigned idx = 0 ; idx < serial.size() ; idx += 1)
+	    sched_region_root[idx] = idx;
+      sched_region_serial.swap(serial);
+      sched_region_group.resize(sched_region_root.size());
+      sched_region_stamp.assign(sched_region_root.size(), 0);
+
+      sched_workers = new sched_worker_s[sched_thread_count];
+      for (unsigned idx = 1 ; idx < sched_thread_count ; idx += 1) {
+	    pthread_t thread;
+	    int rc = pthread_create(&thread, 0, &sched_worker_main_,
+				    sched_workers+idx);
+	    if (rc != 0) {
+		  fprintf(stderr, "Warning: Unable to start scheduler "
+			  "thread %u: %s\n", idx, strerror(rc));
+		  sched_thread_count = idx;
+		  break;
+	    }
+	    pthread_detach(thread);
+      }
+#else
+      (void)serial;
+#endif
+}
+
+void schedule_link_regions(vvp_net_t*src, vvp_net_t*dst)
+{
+#ifdef SCHED_THREADS
+      if (sched_region_root.empty())
+	    return;
+
+	/* The events of a net that was created at run time are all
+	   run alone anyhow. */
+      unsigned src_id = src->region();
+      if (src_id >= sched_region_root.size())
+	    return;
+
+      unsigned src_root = sched_region_find_(src_id);
+      unsigned dst_id = dst->region();
+      if (dst_id >= sched_region_root.size()) {
+	    sched_region_serial[src_root] = true;
+	    return;
+      }
+
+      unsigned dst_root = sched_region_find_(dst_id);
+      if (dst_root == src_root)
+	    return;
+
+      sched_region_root[dst_root] = src_root;
+      if (sched_region_serial[dst_root])
+	    sched_region_serial[src_root] = true;
+#else
+      (void)src;
+      (void)dst;
+#endif
+}
+
+void schedule_region_serial(vvp_net_t*net)
+{
+#ifdef SCHED_THREADS
+      unsigned id = net->region();
+      if (id < sched_region_root.size())
+	    sched_region_serial[sched_region_find_(id)] = true;
+#else
+      (void)net;
+#endif
+}
+
 void schedule_simulate(void)
 {
       bool run_finals;
@@ -1044,7 +1840,7 @@ void schedule_simulate(void)
       // process events and when done run the final blocks.
       run_finals = schedule_runnable;
 
-      if (schedule_runnable) while (sched_list) {
+      if (schedule_runnable) while (struct event_time_s*ctim = sched_head_()) {
 
 	    if (schedule_stopped_flag) {
 		  schedule_stopped_flag = false;
@@ -1054,22 +1850,21 @@ void schedule_simulate(void)
 		  continue;
 	    }
 
-	      /* ctim is the current time step. */
-	    struct event_time_s* ctim = sched_list;
-
-	      /* If the time is advancing, then first run the
-		 postponed sync events. Run them all. */
-	    if (ctim->delay > 0) {
+	      /* ctim is the current time step. If the time is
+		 advancing, then first run the postponed sync
+		 events. Run them all. */
+	    if (ctim->time > schedule_time) {
 
 		  if (!schedule_runnable) break;
-		  schedule_time += ctim->delay;
+		  schedule_time = ctim->time;
+		  if (sched_wheel_flag)
+			sched_wheel_advance_(schedule_time);
 		    /* When the design is being traced (we are emitting
 		     * file/line information) also print any time changes. */
 		  if (show_file_line) {
 			cerr << "Advancing to simulation time: "
 			     << schedule_time << endl;
 		  }
-		  ctim->delay = 0;
 
 		  vpiNextSimTime();
 		    // Process the cbAtStartOfSimTime callbacks.
@@ -1102,13 +1897,21 @@ void schedule_simulate(void)
 			     deletes threads as needed. */
 			if (ctim->active == 0) {
 			      run_rosync(ctim);
-			      sched_list = ctim->next;
+			      sched_pop_head_(ctim);
 			      delete ctim;
 			      continue;
 			}
 		  }
 	    }
 
+#ifdef SCHED_THREADS
+	    if (sched_workers && !profile_flag && !schedule_single_step_flag
+		&& schedule_run_batch_(ctim)) {
+		  if (vvp_fanout_retired) vvp_fanout_release();
+		  continue;
+	    }
+#endif
+
 	      /* Pull the first item off the list. If this is the last
 		 cell in the list, then clear the list. Execute that
 		 event type, and delete it. */
@@ -1125,9 +1928,19 @@ void schedule_simulate(void)
 		  schedule_single_step_flag = false;
 	    }
 
-	    cur->run_run();
+	    if (profile_flag) {
+		  cur->profile_enter();
+		  cur->run_run();
+		  profile_leave();
+	    } else {
+		  cur->run_run();
+	    }
 
 	    delete (cur);
+
+	      /* No value is being sent now, so the fan-out arrays
+		 that were replaced while this event ran can go. */
+	    if (vvp_fanout_retired) vvp_fanout_release();
       }
 
 	// Execute final events.
@@ -22,6 +22,7 @@
 # include  "vthread.h"
 # include  "vvp_net.h"
 # include  "array.h"
+# include  <vector>
 
 /*
  * This causes a thread to be scheduled for execution. The schedule
@@ -144,6 +145,9 @@ struct vvp_gen_event_s
       virtual ~vvp_gen_event_s() =0;
       virtual void run_run() =0;
       virtual void single_step_display(void);
+	// The net whose region the run_run method is confined to, or
+	// nil (the default) if it must be run alone.
+      virtual vvp_net_t* region_net(void);
 };
 
 /*
@@ -153,9 +157,46 @@ struct vvp_gen_event_s
 extern void schedule_simulate(void);
 
 /*
- * Get the current absolute simulation time. This is not used
- * internally by the scheduler (which uses time differences instead)
- * but is used for printouts and stuff.
+ * Keep the pending time steps in a timing wheel instead of a sorted
+ * list. This makes scheduling events far in the future cheaper when
+ * there are many distinct pending times. This must be called before
+ * any events are scheduled.
+ */
+extern void schedule_use_timing_wheel(void);
+
+/*
+ * Run the active events of independent net regions on count threads:
+ * the main thread and count-1 workers. When this is set, the compiler
+ * partitions the nets into regions (see compile_net_regions) and
+ * passes them in with schedule_use_regions. This returns false, and
+ * changes nothing, if this build has no thread support. It must be
+ * called before compiling.
+ */
+extern bool schedule_use_threads(unsigned count);
+extern unsigned schedule_thread_count(void);
+
+/*
+ * The compiler stores the region number of each net in the net, and
+ * the serial vector, indexed by region number, marks the regions
+ * whose events must be run alone. The scheduler takes over the
+ * contents of the vector.
+ */
+extern void schedule_use_regions(std::vector<bool>&serial);
+
+/*
+ * These keep the regions correct as the netlist changes at run time.
+ * A link joins the regions of the two nets, or makes the region of
+ * the source serial if the destination was created at run time.
+ * schedule_region_serial makes the region of the net serial. This is
+ * used for nets that get value change callbacks, which call into VPI
+ * code that is not confined to any region.
+ */
+extern void schedule_link_regions(vvp_net_t*src, vvp_net_t*dst);
+extern void schedule_region_serial(vvp_net_t*net);
+
+/*
+ * Get the current absolute simulation time. This is used for
+ * printouts and stuff.
  */
 extern vvp_time64_t schedule_simtime(void);
 
@@ -180,6 +221,17 @@ extern bool schedule_stopped(void);
  */
 extern void stop_handler(int rc);
 
+/*
+ * The scheduler allocates its events from slab heaps. These functions
+ * give access to the heaps by index, for the statistics. The name of
+ * the heap past the last is nil. The chunk count of a heap can be
+ * set by name. If the name is not known, false is returned.
+ */
+struct slab_counts_s;
+extern const char* schedule_heap_name(unsigned idx);
+extern const slab_counts_s* schedule_heap_counts(unsigned idx);
+extern bool schedule_heap_chunk_count(const char*name, size_t count);
+
 /*
  * These are event counters for the sake of performance measurements.
  */
@@ -21,7 +21,27 @@
  */
 
 
-template <size_t SLAB_SIZE, size_t CHUNK_COUNT> class slab_t {
+# include  <cstddef>
+
+/*
+ * These are the usage counters of a slab heap. They are kept in a
+ * base class so that heaps of different item sizes can be listed and
+ * tuned together.
+ *
+ * The chunk_count is the number of items in each chunk that is added
+ * when the heap runs out. It starts as the CHUNK_COUNT of the heap,
+ * but can be changed at run time, for example to the peak of an
+ * earlier run so that the heap only needs to grow once.
+ */
+struct slab_counts_s {
+      unsigned long pool;   // Items allocated to the heap
+      unsigned long live;   // Items currently in use
+      unsigned long peak;   // Most items in use at once
+      unsigned long allocs; // Total number of alloc_slab calls
+      size_t chunk_count;
+};
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT> class slab_t : public slab_counts_s {
 
       union item_cell_u {
 	    item_cell_u*next;
@@ -34,8 +54,6 @@ template <size_t SLAB_SIZE, size_t CHUNK_COUNT> class slab_t {
       void* alloc_slab();
       void  free_slab(void*);
 
-      unsigned long pool;
-
     private:
       item_cell_u*heap_;
       item_cell_u initial_chunk_[CHUNK_COUNT];
@@ -45,6 +63,10 @@ template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
 slab_t<SLAB_SIZE,CHUNK_COUNT>::slab_t()
 {
       pool = CHUNK_COUNT;
+      live = 0;
+      peak = 0;
+      allocs = 0;
+      chunk_count = CHUNK_COUNT;
       heap_ = initial_chunk_;
       for (unsigned idx = 0 ; idx < CHUNK_COUNT-1 ; idx += 1)
 	    initial_chunk_[idx].next = initial_chunk_+idx+1;
@@ -56,14 +78,18 @@ template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
 inline void* slab_t<SLAB_SIZE,CHUNK_COUNT>::alloc_slab()
 {
       if (heap_ == 0) {
-	    item_cell_u*chunk = new item_cell_u[CHUNK_COUNT];
-	    for (unsigned idx = 0 ; idx < CHUNK_COUNT ; idx += 1) {
+	    item_cell_u*chunk = new item_cell_u[chunk_count];
+	    for (unsigned idx = 0 ; idx < chunk_count ; idx += 1) {
 		  chunk[idx].next = heap_;
 		  heap_ = chunk+idx;
 	    }
-	    pool += CHUNK_COUNT;
+	    pool += chunk_count;
       }
 
+      allocs += 1;
+      live += 1;
+      if (live > peak) peak = live;
+
       item_cell_u*cur = heap_;
       heap_ = heap_->next;
       return cur;
@@ -75,6 +101,7 @@ inline void slab_t<SLAB_SIZE,CHUNK_COUNT>::free_slab(void*ptr)
       item_cell_u*cur = reinterpret_cast<item_cell_u*> (ptr);
       cur->next = heap_;
       heap_ = cur;
+      live -= 1;
 }
 
 #endif
@@ -34,6 +34,7 @@ extern unsigned long count_functors_resolv;
 extern unsigned long count_functors_sig;
 extern unsigned long count_filters;
 extern unsigned long count_vvp_nets;
+extern unsigned long count_flat_fanouts;
 extern unsigned long count_vpi_nets;
 extern unsigned long count_vpi_scopes;
 
@@ -55,9 +56,16 @@ extern unsigned long count_assign_real_pool(void);
 extern unsigned long count_assign_aword_pool(void);
 extern unsigned long count_assign_arword_pool(void);
 
+extern unsigned long count_symbol_lookups;
+extern unsigned long count_symbol_probes;
+extern double time_symbol_lookups;
+
 extern unsigned long count_gen_events;
 extern unsigned long count_gen_pool(void);
 
+extern unsigned long count_batches;
+extern unsigned long count_batch_events;
+
 extern size_t size_opcodes;
 extern size_t size_vvp_nets;
 extern size_t size_vvp_net_funs;
@@ -70,13 +70,15 @@ class symbol_table_s {
 
     private:
       symbol_table_s(const symbol_table_s&) { assert(0); };
-      struct tree_node_*root;
+      struct symbol_slot_*table;
+      unsigned long table_size;
+      unsigned long table_used;
       struct key_strings*str_chunk;
       unsigned str_used;
 
-      symbol_value_t find_value_(struct tree_node_*cur,
-				 const char*key, symbol_value_t val,
+      symbol_value_t find_value_(const char*key, symbol_value_t val,
 				 bool force_flag);
+      void grow_(void);
       char*key_strdup_(const char*str);
 };
 
@@ -125,12 +125,72 @@ vvp_udp_comb_s::vvp_udp_comb_s(char*label, char*name__, unsigned ports)
       levels1_ = 0;
       nlevels0_ = 0;
       nlevels1_ = 0;
+      lut_ = 0;
 }
 
 vvp_udp_comb_s::~vvp_udp_comb_s()
 {
       delete[] levels0_;
       delete[] levels1_;
+      delete[] lut_;
+}
+
+/*
+ * The truth tables are limited to this many positions. That is a
+ * 64K table for a combinational device with 8 inputs, and for a
+ * sequential device with 5 inputs (plus the current output) a 4K
+ * levels table and a 60K edges table.
+ */
+static const unsigned UDP_LUT_MAX_BITS = 8;
+static const unsigned UDP_LUT_MAX_SEQ_BITS = 6;
+
+/*
+ * Make the truth table index for the levels in the cur table. This
+ * spreads the low 8 bits of mask1 and maskx out to every other bit,
+ * so each position gets the code 0, 1 or 2.
+ */
+static inline unsigned long spread_lut_bits(unsigned long bits)
+{
+      bits &= 0xff;
+      bits = (bits | (bits << 4)) & 0x0f0f;
+      bits = (bits | (bits << 2)) & 0x3333;
+      bits = (bits | (bits << 1)) & 0x5555;
+      return bits;
+}
+
+static inline unsigned long lut_index(const udp_levels_table&cur)
+{
+      return spread_lut_bits(cur.mask1) | (spread_lut_bits(cur.maskx) << 1);
+}
+
+/*
+ * This is the reverse of lut_index. It returns false if the index
+ * has an unused code (3) in any position, since those entries are
+ * never looked up.
+ */
+static bool lut_levels(unsigned long index, unsigned nbits,
+		       udp_levels_table&cur)
+{
+      cur.mask0 = 0;
+      cur.mask1 = 0;
+      cur.maskx = 0;
+      for (unsigned pp = 0 ;  pp < nbits ;  pp += 1) {
+	    unsigned long mask_bit = 1UL << pp;
+	    switch ((index >> (2*pp)) & 3) {
+		case 0:
+		  cur.mask0 |= mask_bit;
+		  break;
+		case 1:
+		  cur.mask1 |= mask_bit;
+		  break;
+		case 2:
+		  cur.maskx |= mask_bit;
+		  break;
+		default:
+		  return false;
+	    }
+      }
+      return true;
 }
 
 /*
@@ -188,6 +248,9 @@ vvp_bit4_t vvp_udp_comb_s::calculate_output(const udp_levels_table&cur,
 					    const udp_levels_table&,
 					    vvp_bit4_t)
 {
+      if (lut_)
+	    return (vvp_bit4_t) lut_[lut_index(cur)];
+
       return test_levels(cur);
 }
 
@@ -294,6 +357,20 @@ void vvp_udp_comb_s::compile_table(char**tab)
 
       assert(nrows0 == nlevels0_);
       assert(nrows1 == nlevels1_);
+
+	/* Compile the rows into a truth table if the device is small
+	   enough. The rows are kept for the sake of test_levels. */
+      if (port_count() <= UDP_LUT_MAX_BITS) {
+	    unsigned long size = 1UL << (2*port_count());
+	    lut_ = new unsigned char[size];
+	    for (unsigned long idx = 0 ;  idx < size ;  idx += 1) {
+		  udp_levels_table cur;
+		  if (lut_levels(idx, port_count(), cur))
+			lut_[idx] = test_levels(cur);
+		  else
+			lut_[idx] = BIT4_X;
+	    }
+      }
 }
 
 vvp_udp_seq_s::vvp_udp_seq_s(char*label, char*name__,
@@ -317,6 +394,9 @@ vvp_udp_seq_s::vvp_udp_seq_s(char*label, char*name__,
       nedges0_ = 0;
       nedges1_ = 0;
       nedgesL_ = 0;
+
+      levels_lut_ = 0;
+      edges_lut_ = 0;
 }
 
 vvp_udp_seq_s::~vvp_udp_seq_s()
@@ -328,6 +408,8 @@ vvp_udp_seq_s::~vvp_udp_seq_s()
       delete[] edges0_;
       delete[] edges1_;
       delete[] edgesL_;
+      delete[] levels_lut_;
+      delete[] edges_lut_;
 }
 
 void edge_based_on_char(struct udp_edges_table&cur, char chr, unsigned pos)
@@ -674,6 +756,54 @@ void vvp_udp_seq_s::compile_table(char**tab)
       assert(idx_edg1 == nedges1_);
       assert(idx_edgL == nedgesL_);
 
+      if (port_count()+1 <= UDP_LUT_MAX_SEQ_BITS)
+	    compile_luts_();
+}
+
+/*
+ * Fill the truth tables from the rows. The levels table has an entry
+ * for every input/output level combination. The edges table has,
+ * for each input position and each initial level of that input, an
+ * entry for every final level combination. Only the entries where the
+ * final level of the edge position differs from the initial level
+ * can be looked up, since the others are not edges.
+ */
+void vvp_udp_seq_s::compile_luts_()
+{
+      unsigned nbits = port_count() + 1;
+      unsigned long size = 1UL << (2*nbits);
+
+      levels_lut_ = new unsigned char[size];
+      edges_lut_ = new unsigned char[port_count() * 3 * size];
+
+      for (unsigned long idx = 0 ;  idx < size ;  idx += 1) {
+	    udp_levels_table cur;
+	    if (! lut_levels(idx, nbits, cur)) {
+		  levels_lut_[idx] = BIT4_X;
+		  for (unsigned edge = 0 ;  edge < port_count()*3 ;  edge += 1)
+			edges_lut_[edge*size + idx] = BIT4_X;
+		  continue;
+	    }
+
+	    levels_lut_[idx] = test_levels_(cur);
+
+	    for (unsigned pp = 0 ;  pp < port_count() ;  pp += 1) {
+		  for (unsigned code = 0 ;  code < 3 ;  code += 1) {
+			unsigned long edge = pp*3 + code;
+			unsigned long from = (idx & ~(3UL << (2*pp)))
+			                   | ((unsigned long)code << (2*pp));
+			if (from == idx) {
+			      edges_lut_[edge*size + idx] = BIT4_X;
+			      continue;
+			}
+
+			  /* The prev table does not have the output. */
+			udp_levels_table prev;
+			lut_levels(from, port_count(), prev);
+			edges_lut_[edge*size + idx] = test_edges_(cur, prev);
+		  }
+	    }
+      }
 }
 
 bool operator == (const udp_levels_table&a, const udp_levels_table&b)
@@ -709,6 +839,9 @@ vvp_bit4_t vvp_udp_seq_s::calculate_output(const udp_levels_table&cur,
 	    break;
       }
 
+      if (levels_lut_)
+	    return lookup_luts_(cur_tmp, prev);
+
       vvp_bit4_t lev = test_levels_(cur_tmp);
       if (lev == BIT4_Z) {
 	    lev = test_edges_(cur_tmp, prev);
@@ -717,6 +850,39 @@ vvp_bit4_t vvp_udp_seq_s::calculate_output(const udp_levels_table&cur,
       return lev;
 }
 
+vvp_bit4_t vvp_udp_seq_s::lookup_luts_(const udp_levels_table&cur,
+				       const udp_levels_table&prev)
+{
+      unsigned long idx = lut_index(cur);
+      vvp_bit4_t lev = (vvp_bit4_t) levels_lut_[idx];
+      if (lev != BIT4_Z)
+	    return lev;
+
+	/* Find the input that changed. The inputs change one at a
+	   time, but if there is more than one edge leave it to the
+	   rows to complain. */
+      unsigned long edge_mask = (cur.mask0 ^ prev.mask0)
+	                      | (cur.maskx ^ prev.maskx)
+	                      | (cur.mask1 ^ prev.mask1);
+      edge_mask &= ~ (-1UL << port_count());
+      if (edge_mask == 0)
+	    return BIT4_X;
+      if (edge_mask & (edge_mask - 1))
+	    return test_edges_(cur, prev);
+
+      unsigned edge_position = 0;
+      while ((edge_mask&1) == 0) {
+	    edge_mask >>= 1;
+	    edge_position += 1;
+      }
+
+      unsigned long code = (prev.mask1 >> edge_position) & 1;
+      code |= ((prev.maskx >> edge_position) & 1) << 1;
+
+      unsigned long size = 1UL << (2*(port_count()+1));
+      return (vvp_bit4_t) edges_lut_[(edge_position*3 + code)*size + idx];
+}
+
 /*
  * This function tests the levels of the input with the additional
  * check match for the current output. It uses this to calculate a
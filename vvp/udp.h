@@ -111,6 +111,16 @@ struct udp_levels_table {
 };
 extern ostream& operator<< (ostream&o, const struct udp_levels_table&t);
 
+/*
+ * Devices with few enough ports also have their rows compiled into a
+ * truth table, so that evaluating an instance is a single lookup
+ * instead of a scan of the rows. The table is indexed by the input
+ * levels, two bits per position (0, 1 or 2 for x) with the first port
+ * in the least significant bits, and holds the vvp_bit4_t result that
+ * the row scan would return for those levels. The table size grows as
+ * 4**ports, so larger devices keep using the rows.
+ */
+
 class vvp_udp_comb_s : public vvp_udp_s {
 
     public:
@@ -131,6 +141,9 @@ class vvp_udp_comb_s : public vvp_udp_s {
       struct udp_levels_table*levels0_;
       struct udp_levels_table*levels1_;
       unsigned nlevels0_, nlevels1_;
+
+	// Truth table compiled from the rows, or nil.
+      unsigned char*lut_;
 };
 
 /*
@@ -208,6 +221,16 @@ class vvp_udp_seq_s : public vvp_udp_s {
       struct udp_edges_table*edgesL_;
       unsigned nedges0_, nedges1_, nedgesL_;
 
+	// Truth tables compiled from the rows, or nil. The levels
+	// table includes the current output as the last position and
+	// holds Z where no level row matches. The edges table has a
+	// levels sized section for each edge position and each
+	// initial level of that position.
+      void compile_luts_();
+      vvp_bit4_t lookup_luts_(const udp_levels_table&cur,
+			      const udp_levels_table&prev);
+      unsigned char*levels_lut_;
+      unsigned char*edges_lut_;
 };
 
 /*
@@ -232,6 +255,7 @@ class vvp_udp_fun_core  : public vvp_wide_fun_core, private vvp_gen_event_s {
 
     private:
       void run_run();
+      vvp_net_t* region_net(void) { return net(); }
 
       vvp_udp_s*def_;
       vvp_bit4_t cur_out_;
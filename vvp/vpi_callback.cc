@@ -110,6 +110,7 @@ static void vpip_real_value_change(value_callback*cbh, vpiHandle ref)
       assert(obj);
 
       obj->add_vpi_callback(cbh);
+      schedule_region_serial(rfp->net);
 }
 
 class value_part_callback : public value_callback {
@@ -135,6 +136,7 @@ inline value_part_callback::value_part_callback(p_cb_data data)
       assert(sig_fil);
 
       sig_fil->add_vpi_callback(this);
+      schedule_region_serial(pobj->net);
 	// Get a reference value that can be used to compare with an
 	// updated value. Use the filter get_value to get the value,
 	// and get it in BinStr form so that compares are easy. Note
@@ -242,6 +244,7 @@ static value_callback* make_value_change(p_cb_data data)
 
 	      /* Attach the __vpiCallback object to the signal. */
 	    sig_fil->add_vpi_callback(obj);
+	    schedule_region_serial(sig->node);
 	    break;
 
 	  case vpiRealVar:
@@ -850,6 +853,11 @@ void vvp_wire_vec4::get_value(struct t_vpi_value*val)
       get_signal_value(val);
 }
 
+void vvp_wire_vec4_word::get_value(struct t_vpi_value*val)
+{
+      get_signal_value(val);
+}
+
 void vvp_wire_vec8::get_value(struct t_vpi_value*val)
 {
       get_signal_value(val);
@@ -1223,51 +1223,64 @@ vpiHandle vpi_handle_by_index(vpiHandle ref, PLI_INT32 idx)
       return ref->vpi_index(idx);
 }
 
+/*
+ * The words of arrays are not items of the scope, but they are named
+ * by the array name and the word index, i.e. "mem[3]". So if the name
+ * has that form, look up the array and get the word from it.
+ */
+static vpiHandle find_array_word(const char *name, struct __vpiScope*ref)
+{
+      size_t len = strlen(name);
+      const char*lb = strrchr(name, '[');
+      if (lb == 0 || lb == name || name[len-1] != ']')
+	    return 0;
+
+      char*ep;
+      long index = strtol(lb+1, &ep, 10);
+      if (ep != name+len-1)
+	    return 0;
+
+	/* The index must be written the way the word names it. */
+      char sidx[64];
+      snprintf(sidx, sizeof sidx, "[%d]", (int)index);
+      if (strcmp(sidx, lb) != 0)
+	    return 0;
+
+      vector<char> base (name, lb);
+      base.push_back(0);
+      vpiHandle arr = vpip_scope_find_name(ref, &base[0]);
+      if (arr == 0 || arr->get_type_code() != vpiMemory)
+	    return 0;
+
+      return arr->vpi_index(index);
+}
+
 static vpiHandle find_name(const char *name, vpiHandle handle)
 {
-      vpiHandle rtn = 0;
       struct __vpiScope*ref = dynamic_cast<__vpiScope*>(handle);
+      if (ref == 0)
+	    return 0;
+
+	/* Look up the name in the index of the items of the scope. */
+      vpiHandle rtn = vpip_scope_find_name(ref, name);
+      if (rtn == 0)
+	    rtn = find_array_word(name, ref);
 
       /* check module names */
-      if (!strcmp(name, vpi_get_str(vpiName, handle)))
+      if (rtn == 0 && !strcmp(name, vpi_get_str(vpiName, handle)))
 	    rtn = handle;
 
-      /* brute force search for the name in all objects in this scope */
-      for (unsigned i = 0 ;  i < ref->nintern ;  i += 1) {
-	      /* The standard says that since a port does not have a full
-	       * name it cannot be found by name. Because of this we need
-	       * to skip ports here so the correct handle can be located. */
-	    if (vpi_get(vpiType, ref->intern[i]) == vpiPort) continue;
-	    char *nm = vpi_get_str(vpiName, ref->intern[i]);
-	    if (!strcmp(name, nm)) {
-		  rtn = ref->intern[i];
-		  break;
-	    } else if (vpi_get(vpiType, ref->intern[i]) == vpiMemory ||
-	               vpi_get(vpiType, ref->intern[i]) == vpiNetArray) {
-		  /* We need to iterate on the words */
-		  vpiHandle word_i, word_h;
-		  word_i = vpi_iterate(vpiMemoryWord, ref->intern[i]);
-		  while (word_i && (word_h = vpi_scan(word_i))) {
-			nm = vpi_get_str(vpiName, word_h);
-			if (!strcmp(name, nm)) {
-			      rtn = word_h;
-			      break;
-			}
-		  }
-	    }
-	    /* found it yet? */
-	    if (rtn) break;
-      }
-
       return rtn;
 }
 
 static vpiHandle find_scope(const char *name, vpiHandle handle, int depth)
 {
-
-      vpiHandle iter = handle==0
-	    ? vpi_iterate(vpiModule, NULL)
-	    : vpi_iterate(vpiInternalScope, handle);
+      struct __vpiScope*ref = 0;
+      if (handle) {
+	    ref = dynamic_cast<__vpiScope*>(handle);
+	    if (ref == 0)
+		  return 0;
+      }
 
       vector<char> name_buf (strlen(name)+1);
       strcpy(&name_buf[0], name);
@@ -1277,26 +1290,27 @@ static vpiHandle find_scope(const char *name, vpiHandle handle, int depth)
 	    *nm_rest++ = 0;
       }
 
-      vpiHandle rtn = 0;
-      vpiHandle hand;
-      while (iter && (hand = vpi_scan(iter))) {
-	    char *nm = vpi_get_str(vpiName, hand);
-
-	    if (strcmp(nm_first,nm)==0) {
-		  if (nm_rest)
-			rtn=find_scope(nm_rest, hand, depth+1);
-		  else
-			rtn = hand;
-	    }
+      vpiHandle hand = vpip_scope_find_name(ref, nm_first);
+      if (hand == 0)
+	    return 0;
 
-	    /* found it yet ? */
-	    if (rtn) {
-		  vpi_free_object(iter);
-		  break;
-	    }
+	/* Below the root, only the internal scopes are scopes. */
+      if (ref) switch (hand->get_type_code()) {
+	  case vpiModule:
+	  case vpiGenScope:
+	  case vpiFunction:
+	  case vpiTask:
+	  case vpiNamedBegin:
+	  case vpiNamedFork:
+	    break;
+	  default:
+	    return 0;
       }
 
-      return rtn;
+      if (nm_rest)
+	    return find_scope(nm_rest, hand, depth+1);
+
+      return hand;
 }
 
 vpiHandle vpi_handle_by_name(const char *name, vpiHandle scope)
@@ -239,6 +239,8 @@ struct __vpiScope : public __vpiHandle {
 	/* Keep an array of internal scope items. */
       class __vpiHandle**intern;
       unsigned nintern;
+	/* Index of the items by name, made when first needed. */
+      class scope_name_index*name_index;
 	/* Set of types */
       std::map<std::string,class_type*> classes;
         /* Keep an array of items to be automatically allocated */
@@ -260,6 +262,12 @@ struct __vpiScope : public __vpiHandle {
 extern struct __vpiScope* vpip_peek_current_scope(void);
 extern void vpip_attach_to_scope(struct __vpiScope*scope, vpiHandle obj);
 extern void vpip_attach_to_current_scope(vpiHandle obj);
+/*
+ * Find the item of the scope with the given name, or with a nil scope
+ * the root scope with that name. Ports are never found.
+ */
+extern vpiHandle vpip_scope_find_name(struct __vpiScope*scope,
+				      const char*name);
 extern struct __vpiScope* vpip_peek_context_scope(void);
 extern unsigned vpip_add_item_to_context(automatic_hooks_s*item,
                                          struct __vpiScope*scope);
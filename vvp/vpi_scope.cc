@@ -18,6 +18,7 @@
  */
 
 # include  "compile.h"
+# include  "codes.h"
 # include  "vpi_priv.h"
 # include  "symbols.h"
 # include  "statistics.h"
@@ -28,11 +29,126 @@
 # include  <cstring>
 # include  <cstdlib>
 # include  <cassert>
+# include  <vector>
 # include  "ivl_alloc.h"
 
 
 static vpiHandle *vpip_root_table_ptr = 0;
 static unsigned   vpip_root_table_cnt = 0;
+static class scope_name_index*vpip_root_index = 0;
+
+/*
+ * Looking up an item of a scope by name (i.e. vpi_handle_by_name)
+ * would otherwise compare the name of every item in the scope. So
+ * the first lookup in a scope makes a hash index of the names of the
+ * items, and later lookups use that. The index is dropped if an item
+ * is added to the scope, and made again by the next lookup. Ports
+ * are not entered, because a port has no full name and so cannot be
+ * found by name. If more than one item has the same name, the first
+ * one is the one that is found.
+ */
+class scope_name_index {
+
+    public:
+      explicit scope_name_index(vpiHandle*items, unsigned nitems);
+
+      vpiHandle find(const char*name) const;
+
+    private:
+      static unsigned long hash_(const char*name);
+
+      struct slot_s {
+	    unsigned long hash;
+	    const char*name;
+	    vpiHandle obj;
+      };
+	// All the names, separated by nulls.
+      std::vector<char> names_;
+	// Open addressed, with linear probing. An empty slot has a
+	// nil obj.
+      std::vector<slot_s> slots_;
+      unsigned long mask_;
+};
+
+unsigned long scope_name_index::hash_(const char*name)
+{
+      unsigned long hash = 2166136261UL;
+      for (const unsigned char*cp = (const unsigned char*)name ; *cp ; cp += 1) {
+	    hash ^= *cp;
+	    hash *= 16777619UL;
+      }
+      return hash;
+}
+
+scope_name_index::scope_name_index(vpiHandle*items, unsigned nitems)
+{
+	// The names from vpi_get_str are in a temporary buffer, so
+	// first gather copies of them, then enter them.
+      std::vector<long> offsets (nitems, -1);
+      for (unsigned idx = 0 ; idx < nitems ; idx += 1) {
+	    if (items[idx]->get_type_code() == vpiPort)
+		  continue;
+	    const char*nm = vpi_get_str(vpiName, items[idx]);
+	    if (nm == 0)
+		  continue;
+	    offsets[idx] = names_.size();
+	    names_.insert(names_.end(), nm, nm+strlen(nm)+1);
+      }
+
+      unsigned long size = 8;
+      while (size < 2*(unsigned long)nitems)
+	    size *= 2;
+      mask_ = size - 1;
+      slot_s empty = { 0, 0, 0 };
+      slots_.assign(size, empty);
+
+      for (unsigned idx = 0 ; idx < nitems ; idx += 1) {
+	    if (offsets[idx] < 0)
+		  continue;
+
+	    const char*nm = &names_[offsets[idx]];
+	    unsigned long hash = hash_(nm);
+	    unsigned long pos = hash & mask_;
+	    while (slots_[pos].obj) {
+		  if (slots_[pos].hash == hash && strcmp(slots_[pos].name, nm) == 0)
+			break;
+		  pos = (pos + 1) & mask_;
+	    }
+	    if (slots_[pos].obj)
+		  continue;
+
+	    slots_[pos].hash = hash;
+	    slots_[pos].name = nm;
+	    slots_[pos].obj = items[idx];
+      }
+}
+
+vpiHandle scope_name_index::find(const char*name) const
+{
+      unsigned long hash = hash_(name);
+      unsigned long pos = hash & mask_;
+      while (slots_[pos].obj) {
+	    if (slots_[pos].hash == hash && strcmp(slots_[pos].name, name) == 0)
+		  return slots_[pos].obj;
+	    pos = (pos + 1) & mask_;
+      }
+      return 0;
+}
+
+vpiHandle vpip_scope_find_name(struct __vpiScope*scope, const char*name)
+{
+      if (scope == 0) {
+	    if (vpip_root_index == 0)
+		  vpip_root_index = new scope_name_index(vpip_root_table_ptr,
+							 vpip_root_table_cnt);
+	    return vpip_root_index->find(name);
+      }
+
+      if (scope->name_index == 0)
+	    scope->name_index = new scope_name_index(scope->intern,
+						     scope->nintern);
+      return scope->name_index->find(name);
+}
 
 vpiHandle vpip_make_root_iterator(void)
 {
@@ -118,6 +234,7 @@ static void delete_sub_scopes(struct __vpiScope *scope)
 	    }
       }
       free(scope->intern);
+      delete scope->name_index;
 
 	/* Clean up any class definitions. */
       map<std::string, class_type*>::iterator citer;
@@ -139,6 +256,8 @@ void root_table_delete(void)
       free(vpip_root_table_ptr);
       vpip_root_table_ptr = 0;
       vpip_root_table_cnt = 0;
+      delete vpip_root_index;
+      vpip_root_index = 0;
 }
 #endif
 
@@ -407,6 +526,9 @@ void vpip_attach_to_scope(struct __vpiScope*scope, vpiHandle obj)
 		  realloc(scope->intern, sizeof(vpiHandle)*scope->nintern);
 
       scope->intern[idx] = obj;
+
+      delete scope->name_index;
+      scope->name_index = 0;
 }
 
 /*
@@ -464,6 +586,7 @@ compile_scope_decl(char*label, char*type, char*name, char*tname,
       scope->is_automatic = is_automatic;
       scope->intern = 0;
       scope->nintern = 0;
+      scope->name_index = 0;
       scope->item = 0;
       scope->nitem = 0;
       scope->live_contexts = 0;
@@ -502,6 +625,9 @@ compile_scope_decl(char*label, char*type, char*name, char*tname,
 	    vpip_root_table_ptr[vpip_root_table_cnt] = scope;
 	    vpip_root_table_cnt = cnt;
 
+	    delete vpip_root_index;
+	    vpip_root_index = 0;
+
 	      /* Root scopes inherit time_units and precision from the
 	         system precision. */
 	    scope->time_units = vpip_get_time_precision();
@@ -516,6 +642,9 @@ void compile_scope_recall(char*symbol)
 	   type punned pointer warning from some gcc compilers. */
       compile_vpi_lookup((vpiHandle*)(void*)&current_scope, symbol);
       assert(current_scope);
+
+	/* Code that follows is for a new thread or scope. */
+      codespace_set_file_line(0);
 }
 
 /*
@@ -28,6 +28,7 @@
 # include  "vvp_cobject.h"
 # include  "vvp_darray.h"
 # include  "class_type.h"
+# include  "profile.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
@@ -233,7 +234,6 @@ struct vthread_s {
 
       inline void cleanup()
       {
-	    bits4 = vvp_vector4_t();
 	    assert(stack_real_.empty());
 	    assert(stack_str_.empty());
 	    assert(stack_obj_size_ == 0);
@@ -259,10 +259,18 @@ struct vthread_s*running_thread = 0;
 // vvp_bit4_t bit values.
 static vvp_bit4_t thr_index_to_bit4[4] = { BIT4_0, BIT4_1, BIT4_X, BIT4_Z };
 
+/*
+ * The thread bit space grows by at least doubling, so that a thread
+ * that uses many bits does not reallocate them for each new vector.
+ */
 static inline void thr_check_addr(struct vthread_s*thr, unsigned addr)
 {
-      if (thr->bits4.size() <= addr)
-	    thr->bits4.resize(addr+1);
+      if (thr->bits4.size() <= addr) {
+	    unsigned size = 2 * thr->bits4.size();
+	    if (size <= addr)
+		  size = addr + 1;
+	    thr->bits4.resize(size);
+      }
 }
 
 static inline vvp_bit4_t thr_get_bit(struct vthread_s*thr, unsigned addr)
@@ -337,19 +345,59 @@ template <class T> T coerce_to_width(const T&that, unsigned width)
 template vvp_vector4_t coerce_to_width(const vvp_vector4_t&that,
                                        unsigned width);
 
+/*
+ * The wide arithmetic instructions work on the 2-state value of their
+ * operands as arrays of unsigned long. Allocating those arrays from
+ * the heap for every instruction is expensive, so instead they are
+ * taken from this scratch space. Each instruction uses a few numbered
+ * slots, and each slot grows as needed but is never released. The
+ * arrays are only valid until the next instruction is executed, and
+ * there is only ever one instruction executing at a time.
+ */
+enum { SCRATCH_SLOTS = 4 };
+static unsigned long*scratch_words_ptr[SCRATCH_SLOTS];
+static unsigned scratch_words_cnt[SCRATCH_SLOTS];
+
+static inline unsigned long* scratch_words(unsigned slot, unsigned words)
+{
+      assert(slot < SCRATCH_SLOTS);
+      if (scratch_words_cnt[slot] < words) {
+	    delete[]scratch_words_ptr[slot];
+	    scratch_words_ptr[slot] = new unsigned long[words];
+	    scratch_words_cnt[slot] = words;
+      }
+      return scratch_words_ptr[slot];
+}
+
+#ifdef CHECK_WITH_VALGRIND
+void vthread_scratch_delete()
+{
+      for (unsigned slot = 0 ;  slot < SCRATCH_SLOTS ;  slot += 1) {
+	    delete[]scratch_words_ptr[slot];
+	    scratch_words_ptr[slot] = 0;
+	    scratch_words_cnt[slot] = 0;
+      }
+}
+#endif
+
+/*
+ * Get the 2-state value of the addressed thread bits into the scratch
+ * array for the given slot. Return a nil pointer if there are X or Z
+ * bits in the value.
+ */
 static unsigned long* vector_to_array(struct vthread_s*thr,
-				      unsigned addr, unsigned wid)
+				      unsigned addr, unsigned wid,
+				      unsigned slot)
 {
+      unsigned awid = (wid + CPU_WORD_BITS - 1) / (CPU_WORD_BITS);
+      unsigned long*val = scratch_words(slot, awid);
+
       if (addr == 0) {
-	    unsigned awid = (wid + CPU_WORD_BITS - 1) / (CPU_WORD_BITS);
-	    unsigned long*val = new unsigned long[awid];
 	    for (unsigned idx = 0 ;  idx < awid ;  idx += 1)
 		  val[idx] = 0;
 	    return val;
       }
       if (addr == 1) {
-	    unsigned awid = (wid + CPU_WORD_BITS - 1) / (CPU_WORD_BITS);
-	    unsigned long*val = new unsigned long[awid];
 	    for (unsigned idx = 0 ;  idx < awid ;  idx += 1)
 		  val[idx] = -1UL;
 
@@ -363,7 +411,10 @@ static unsigned long* vector_to_array(struct vthread_s*thr,
       if (addr < 4)
 	    return 0;
 
-      return thr->bits4.subarray(addr, wid);
+      if (! thr->bits4.subarray(val, addr, wid))
+	    return 0;
+
+      return val;
 }
 
 /*
@@ -533,14 +584,37 @@ void contexts_delete(struct __vpiScope*scope)
 }
 #endif
 
+/*
+ * Threads that are done are kept in a pool, linked by the wait_next
+ * member, and reused for new threads. A reused thread keeps its bit
+ * space and the space of its stacks, so forking many short threads
+ * from the same code does not allocate them again. The bit space is
+ * set to X as if it were new. A bit space larger than
+ * thread_pool_bits is dropped when the thread goes into the pool, so
+ * one wide thread does not make every later fork clear its bits.
+ */
+static vthread_t thread_pool = 0;
+static unsigned thread_pool_count = 0;
+static const unsigned thread_pool_max = 1024;
+static const unsigned thread_pool_bits = 256;
+
 /*
  * Create a new thread with the given start address.
  */
 vthread_t vthread_new(vvp_code_t pc, struct __vpiScope*scope)
 {
-      vthread_t thr = new struct vthread_s;
+      vthread_t thr;
+      if (thread_pool) {
+	    thr = thread_pool;
+	    thread_pool = thr->wait_next;
+	    thread_pool_count -= 1;
+	    thr->bits4.set_to_x();
+      } else {
+	    thr = new struct vthread_s;
+	    thr->bits4 = vvp_vector4_t(32);
+      }
+
       thr->pc     = pc;
-      thr->bits4  = vvp_vector4_t(32);
       thr->parent = 0;
       thr->parent_scope = scope;
       thr->wait_next = 0;
@@ -664,6 +738,21 @@ static void vthread_reap(vthread_t thr)
 void vthread_delete(vthread_t thr)
 {
       thr->cleanup();
+
+#ifndef CHECK_WITH_VALGRIND
+      if (thread_pool_count < thread_pool_max) {
+	    thr->children.clear();
+	    thr->detached_children.clear();
+	    thr->task_func_children.clear();
+	    if (thr->bits4.size() > thread_pool_bits)
+		  thr->bits4 = vvp_vector4_t(32);
+	    thr->wait_next = thread_pool;
+	    thread_pool = thr;
+	    thread_pool_count += 1;
+	    return;
+      }
+#endif
+
       delete thr;
 }
 
@@ -682,10 +771,40 @@ void vthread_delay_delete()
 	    running_thread->delay_delete = 1;
 }
 
+/*
+ * This is the opcode loop of vthread_run when profiling. It counts
+ * the opcodes, and charges them and the time to the scope of the
+ * thread. The scope is taken first, since the thread may be gone
+ * when it pauses.
+ */
+static void vthread_run_profiled(vthread_t thr)
+{
+      unsigned long count = 0;
+      profile_enter_thread(thr->parent_scope);
+
+      for (;;) {
+	    vvp_code_t cp = thr->pc;
+	    thr->pc += 1;
+	    count += 1;
+	    profile_count_code(cp, thr->parent_scope);
+
+	    bool rc = (cp->opcode)(thr, cp);
+	    if (rc == false)
+		  break;
+      }
+
+      profile_leave(count);
+}
+
 /*
  * This function runs each thread by fetching an instruction,
  * incrementing the PC, and executing the instruction. The thread may
  * be the head of a list, so each thread is run so far as possible.
+ *
+ * The code is direct threaded already: each instruction holds the
+ * address of the function that implements it, so the dispatch is a
+ * single indirect call. That costs a few nanoseconds, which is small
+ * next to the vector work of most opcodes.
  */
 void vthread_run(vthread_t thr)
 {
@@ -698,6 +817,12 @@ void vthread_run(vthread_t thr)
 
             running_thread = thr;
 
+	    if (profile_flag) {
+		  vthread_run_profiled(thr);
+		  thr = tmp;
+		  continue;
+	    }
+
 	    for (;;) {
 		  vvp_code_t cp = thr->pc;
 		  thr->pc += 1;
@@ -857,8 +982,8 @@ bool of_ADD(vthread_t thr, vvp_code_t cp)
 {
       assert(cp->bit_idx[0] >= 4);
 
-      unsigned long*lva = vector_to_array(thr, cp->bit_idx[0], cp->number);
-      unsigned long*lvb = vector_to_array(thr, cp->bit_idx[1], cp->number);
+      unsigned long*lva = vector_to_array(thr, cp->bit_idx[0], cp->number, 0);
+      unsigned long*lvb = vector_to_array(thr, cp->bit_idx[1], cp->number, 1);
       if (lva == 0 || lvb == 0)
 	    goto x_out;
 
@@ -872,15 +997,9 @@ bool of_ADD(vthread_t thr, vvp_code_t cp)
 
       thr->bits4.setarray(cp->bit_idx[0], cp->number, lva);
 
-      delete[]lva;
-      delete[]lvb;
-
       return true;
 
  x_out:
-      delete[]lva;
-      delete[]lvb;
-
       vvp_vector4_t tmp(cp->number, BIT4_X);
       thr->bits4.set_vec(cp->bit_idx[0], tmp);
 
@@ -912,7 +1031,7 @@ bool of_ADDI(vthread_t thr, vvp_code_t cp)
 
       unsigned word_count = (bit_width+CPU_WORD_BITS-1)/CPU_WORD_BITS;
 
-      unsigned long*lva = vector_to_array(thr, bit_addr, bit_width);
+      unsigned long*lva = vector_to_array(thr, bit_addr, bit_width, 0);
       if (lva == 0)
 	    goto x_out;
 
@@ -929,13 +1048,9 @@ bool of_ADDI(vthread_t thr, vvp_code_t cp)
 
       thr->bits4.setarray(bit_addr, bit_width, lva);
 
-      delete[]lva;
-
       return true;
 
  x_out:
-      delete[]lva;
-
       vvp_vector4_t tmp (bit_width, BIT4_X);
       thr->bits4.set_vec(bit_addr, tmp);
 
@@ -1786,7 +1901,7 @@ bool of_CMPIU(vthread_t thr, vvp_code_t cp)
       unsigned long imm  = cp->bit_idx[1];
       unsigned wid  = cp->number;
 
-      unsigned long*array = vector_to_array(thr, addr, wid);
+      unsigned long*array = vector_to_array(thr, addr, wid, 0);
 	// If there are xz bits in the right hand expression, then we
 	// have to do the compare the hard way. That is because even
 	// though we know that eeq must be false (the immediate value
@@ -1806,8 +1921,6 @@ bool of_CMPIU(vthread_t thr, vvp_code_t cp)
 	    lt = (array[idx] < imm) ? BIT4_1 : BIT4_0;
       }
 
-      delete[]array;
-
       thr_put_bit(thr, 4, eq);
       thr_put_bit(thr, 5, lt);
       thr_put_bit(thr, 6, eq);
@@ -1860,14 +1973,11 @@ bool of_CMPU(vthread_t thr, vvp_code_t cp)
       unsigned idx2 = cp->bit_idx[1];
       unsigned wid  = cp->number;
 
-      unsigned long*larray = vector_to_array(thr, idx1, wid);
+      unsigned long*larray = vector_to_array(thr, idx1, wid, 0);
       if (larray == 0) return of_CMPU_the_hard_way(thr, cp);
 
-      unsigned long*rarray = vector_to_array(thr, idx2, wid);
-      if (rarray == 0) {
-	    delete[]larray;
-	    return of_CMPU_the_hard_way(thr, cp);
-      }
+      unsigned long*rarray = vector_to_array(thr, idx2, wid, 1);
+      if (rarray == 0) return of_CMPU_the_hard_way(thr, cp);
 
       unsigned words = (wid+CPU_WORD_BITS-1) / CPU_WORD_BITS;
 
@@ -1882,9 +1992,6 @@ bool of_CMPU(vthread_t thr, vvp_code_t cp)
 		  lt = BIT4_0;
       }
 
-      delete[]larray;
-      delete[]rarray;
-
       thr_put_bit(thr, 4, eq);
       thr_put_bit(thr, 5, lt);
       thr_put_bit(thr, 6, eq);
@@ -2343,6 +2450,11 @@ static unsigned long divide2words(unsigned long a, unsigned long b,
       return result + a/b;
 }
 
+/*
+ * Divide the ap array by the bp array. The result is returned in
+ * scratch slot 2, and the remainder is left in ap. Scratch slot 3 is
+ * used for intermediate values. If b is zero, return nil instead.
+ */
 static unsigned long* divide_bits(unsigned long*ap, unsigned long*bp, unsigned wid)
 {
 	// Do all our work a cpu-word at a time. The "words" variable
@@ -2359,8 +2471,8 @@ static unsigned long* divide_bits(unsigned long*ap, unsigned long*bp, unsigned w
 
 	// The result array will eventually accumulate the result. The
 	// diff array is a difference that we use in the intermediate.
-      unsigned long*diff  = new unsigned long[words];
-      unsigned long*result= new unsigned long[words];
+      unsigned long*diff  = scratch_words(3, words);
+      unsigned long*result= scratch_words(2, words);
       for (unsigned idx = 0 ; idx < words ; idx += 1)
 	    result[idx] = 0;
 
@@ -2419,7 +2531,6 @@ static unsigned long* divide_bits(unsigned long*ap, unsigned long*bp, unsigned w
 	// desired result. We should find that:
 	//  input-a = bp * result + ap;
 
-      delete[]diff;
       return result;
 }
 
@@ -2431,16 +2542,15 @@ bool of_DIV(vthread_t thr, vvp_code_t cp)
 
       assert(adra >= 4);
 
-      unsigned long*ap = vector_to_array(thr, adra, wid);
+      unsigned long*ap = vector_to_array(thr, adra, wid, 0);
       if (ap == 0) {
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(adra, tmp);
 	    return true;
       }
 
-      unsigned long*bp = vector_to_array(thr, adrb, wid);
+      unsigned long*bp = vector_to_array(thr, adrb, wid, 1);
       if (bp == 0) {
-	    delete[]ap;
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(adra, tmp);
 	    return true;
@@ -2455,15 +2565,11 @@ bool of_DIV(vthread_t thr, vvp_code_t cp)
 		  ap[0] /= bp[0];
 		  thr->bits4.setarray(adra, wid, ap);
 	    }
-	    delete[]ap;
-	    delete[]bp;
 	    return true;
       }
 
       unsigned long*result = divide_bits(ap, bp, wid);
       if (result == 0) {
-	    delete[]ap;
-	    delete[]bp;
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(adra, tmp);
 	    return true;
@@ -2474,9 +2580,6 @@ bool of_DIV(vthread_t thr, vvp_code_t cp)
 	//  input-a = bp * result + ap;
 
       thr->bits4.setarray(adra, wid, result);
-      delete[]ap;
-      delete[]bp;
-      delete[]result;
       return true;
 }
 
@@ -2500,16 +2603,15 @@ bool of_DIV_S(vthread_t thr, vvp_code_t cp)
 	// Get the values, left in right, in binary form. If there is
 	// a problem with either (caused by an X or Z bit) then we
 	// know right away that the entire result is X.
-      unsigned long*ap = vector_to_array(thr, adra, wid);
+      unsigned long*ap = vector_to_array(thr, adra, wid, 0);
       if (ap == 0) {
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(adra, tmp);
 	    return true;
       }
 
-      unsigned long*bp = vector_to_array(thr, adrb, wid);
+      unsigned long*bp = vector_to_array(thr, adrb, wid, 1);
       if (bp == 0) {
-	    delete[]ap;
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(adra, tmp);
 	    return true;
@@ -2537,8 +2639,6 @@ bool of_DIV_S(vthread_t thr, vvp_code_t cp)
 		  ap[0] = ((unsigned long)res) & ~sign_mask;
 		  thr->bits4.setarray(adra, wid, ap);
 	    }
-	    delete[]ap;
-	    delete[]bp;
 	    return true;
       }
 
@@ -2556,8 +2656,6 @@ bool of_DIV_S(vthread_t thr, vvp_code_t cp)
 
       unsigned long*result = divide_bits(ap, bp, wid);
       if (result == 0) {
-	    delete[]ap;
-	    delete[]bp;
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(adra, tmp);
 	    return true;
@@ -2570,9 +2668,6 @@ bool of_DIV_S(vthread_t thr, vvp_code_t cp)
       result[words-1] &= ~sign_mask;
 
       thr->bits4.setarray(adra, wid, result);
-      delete[]ap;
-      delete[]bp;
-      delete[]result;
       return true;
 }
 
@@ -3394,14 +3489,14 @@ static void load_vp0_common(vthread_t thr, vvp_code_t cp, const vvp_vector4_t&si
 	/* Check the address once, before we scan the vector. */
       thr_check_addr(thr, bit+wid-1);
 
-      unsigned long*val = sig_value.subarray(0, wid);
-      if (val == 0) {
+      unsigned words = (wid + CPU_WORD_BITS - 1) / CPU_WORD_BITS;
+      unsigned long*val = scratch_words(0, words);
+      if (! sig_value.subarray(val, 0, wid)) {
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(bit, tmp);
 	    return;
       }
 
-      unsigned words = (wid + CPU_WORD_BITS - 1) / CPU_WORD_BITS;
       unsigned long carry = 0;
       unsigned long imm = addend;
       for (unsigned idx = 0 ; idx < words ; idx += 1) {
@@ -3413,7 +3508,6 @@ static void load_vp0_common(vthread_t thr, vvp_code_t cp, const vvp_vector4_t&si
 	/* Copy the vector bits into the bits4 vector. Do the copy
 	   directly to skip the excess calls to thr_check_addr. */
       thr->bits4.setarray(bit, wid, val);
-      delete[]val;
 }
 
 /*
@@ -4092,16 +4186,15 @@ bool of_MUL(vthread_t thr, vvp_code_t cp)
 
       assert(adra >= 4);
 
-      unsigned long*ap = vector_to_array(thr, adra, wid);
+      unsigned long*ap = vector_to_array(thr, adra, wid, 0);
       if (ap == 0) {
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(adra, tmp);
 	    return true;
       }
 
-      unsigned long*bp = vector_to_array(thr, adrb, wid);
+      unsigned long*bp = vector_to_array(thr, adrb, wid, 1);
       if (bp == 0) {
-	    delete[]ap;
 	    vvp_vector4_t tmp(wid, BIT4_X);
 	    thr->bits4.set_vec(adra, tmp);
 	    return true;
@@ -4111,13 +4204,11 @@ bool of_MUL(vthread_t thr, vvp_code_t cp)
       if (wid <= CPU_WORD_BITS) {
 	    ap[0] *= bp[0];
 	    thr->bits4.setarray(adra, wid, ap);
-	    delete[]ap;
-	    delete[]bp;
 	    return true;
       }
 
       unsigned words = (wid+CPU_WORD_BITS-1) / CPU_WORD_BITS;
-      unsigned long*res = new unsigned long[words];
+      unsigned long*res = scratch_words(2, words);
       for (unsigned idx = 0 ; idx < words ; idx += 1)
 	    res[idx] = 0;
 
@@ -4136,9 +4227,6 @@ bool of_MUL(vthread_t thr, vvp_code_t cp)
       }
 
       thr->bits4.setarray(adra, wid, res);
-      delete[]ap;
-      delete[]bp;
-      delete[]res;
       return true;
 }
 
@@ -4159,7 +4247,7 @@ bool of_MULI(vthread_t thr, vvp_code_t cp)
 
       assert(adr >= 4);
 
-      unsigned long*val = vector_to_array(thr, adr, wid);
+      unsigned long*val = vector_to_array(thr, adr, wid, 0);
 	// If there are X bits in the value, then return X.
       if (val == 0) {
 	    vvp_vector4_t tmp(cp->number, BIT4_X);
@@ -4171,18 +4259,15 @@ bool of_MULI(vthread_t thr, vvp_code_t cp)
       if (wid <= CPU_WORD_BITS) {
 	    val[0] *= imm;
 	    thr->bits4.setarray(adr, wid, val);
-	    delete[]val;
 	    return true;
       }
 
       unsigned words = (wid+CPU_WORD_BITS-1) / CPU_WORD_BITS;
-      unsigned long*res = new unsigned long[words];
+      unsigned long*res = scratch_words(1, words);
 
       multiply_array_imm(res, val, words, imm);
 
       thr->bits4.setarray(adr, wid, res);
-      delete[]val;
-      delete[]res;
       return true;
 }
 
@@ -4813,10 +4898,9 @@ bool of_PUTC_STR_V(vthread_t thr, vvp_code_t cp)
 
 	/* Extract the character from the vector space. If that byte
 	   is null (8'h00) then the standard says it is to be skipped. */
-      unsigned long*tmp = vector_to_array(thr, base, 8);
+      unsigned long*tmp = vector_to_array(thr, base, 8, 0);
       assert(tmp);
       char tmp_val = tmp[0] & 0xff;
-      delete [] tmp;
       if (tmp_val == 0)
 	    return true;
 
@@ -5433,8 +5517,8 @@ bool of_SUB(vthread_t thr, vvp_code_t cp)
 {
       assert(cp->bit_idx[0] >= 4);
 
-      unsigned long*lva = vector_to_array(thr, cp->bit_idx[0], cp->number);
-      unsigned long*lvb = vector_to_array(thr, cp->bit_idx[1], cp->number);
+      unsigned long*lva = vector_to_array(thr, cp->bit_idx[0], cp->number, 0);
+      unsigned long*lvb = vector_to_array(thr, cp->bit_idx[1], cp->number, 1);
       if (lva == 0 || lvb == 0)
 	    goto x_out;
 
@@ -5449,15 +5533,10 @@ bool of_SUB(vthread_t thr, vvp_code_t cp)
 	   in the thr->bitr4 vector, so just do the set bit. */
 
       thr->bits4.setarray(cp->bit_idx[0], cp->number, lva);
-      delete[]lva;
-      delete[]lvb;
 
       return true;
 
  x_out:
-      delete[]lva;
-      delete[]lvb;
-
       vvp_vector4_t tmp(cp->number, BIT4_X);
       thr->bits4.set_vec(cp->bit_idx[0], tmp);
 
@@ -5478,7 +5557,7 @@ bool of_SUBI(vthread_t thr, vvp_code_t cp)
 
       unsigned word_count = (cp->number+CPU_WORD_BITS-1)/CPU_WORD_BITS;
       unsigned long imm = cp->bit_idx[1];
-      unsigned long*lva = vector_to_array(thr, cp->bit_idx[0], cp->number);
+      unsigned long*lva = vector_to_array(thr, cp->bit_idx[0], cp->number, 0);
       if (lva == 0)
 	    goto x_out;
 
@@ -5495,13 +5574,9 @@ bool of_SUBI(vthread_t thr, vvp_code_t cp)
 
       thr->bits4.setarray(cp->bit_idx[0], cp->number, lva);
 
-      delete[]lva;
-
       return true;
 
  x_out:
-      delete[]lva;
-
       vvp_vector4_t tmp(cp->number, BIT4_X);
       thr->bits4.set_vec(cp->bit_idx[0], tmp);
 
@@ -5795,3 +5870,91 @@ bool of_REAP_UFUNC(vthread_t thr, vvp_code_t cp)
 
       return true;
 }
+
+/*
+ * The fused instructions run the instructions of their sequence with
+ * direct calls. The compiler lays out each of them in its own code
+ * word after the first, so the thread PC is moved past the last one
+ * before that is run, in case it jumps.
+ */
+template <vvp_code_fun A, vvp_code_fun B>
+static inline bool of_fused2_(vthread_t thr, vvp_code_t cp)
+{
+      A(thr, cp);
+      thr->pc = cp + 2;
+      return B(thr, cp + 1);
+}
+
+template <vvp_code_fun A, vvp_code_fun B, vvp_code_fun C>
+static inline bool of_fused3_(vthread_t thr, vvp_code_t cp)
+{
+      A(thr, cp);
+      B(thr, cp + 1);
+      thr->pc = cp + 3;
+      return C(thr, cp + 2);
+}
+
+bool of_CMPS_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_CMPS, of_JMP0XZ>(thr, cp);
+}
+
+bool of_CMPU_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_CMPU, of_JMP0XZ>(thr, cp);
+}
+
+bool of_CMPIS_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_CMPIS, of_JMP0XZ>(thr, cp);
+}
+
+bool of_CMPIU_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_CMPIU, of_JMP0XZ>(thr, cp);
+}
+
+bool of_IX_GET_LOAD_AV(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_IX_GET, of_LOAD_AV>(thr, cp);
+}
+
+bool of_IX_GET_S_LOAD_AV(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_IX_GET_S, of_LOAD_AV>(thr, cp);
+}
+
+bool of_IX_GETV_LOAD_AV(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_IX_GETV, of_LOAD_AV>(thr, cp);
+}
+
+bool of_IX_GETV_S_LOAD_AV(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_IX_GETV_S, of_LOAD_AV>(thr, cp);
+}
+
+bool of_LOAD_ADDI_SET_VEC(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused3_<of_LOAD_VEC, of_ADDI, of_SET_VEC>(thr, cp);
+}
+
+bool of_LOAD_CMPIS_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused3_<of_LOAD_VEC, of_CMPIS, of_JMP0XZ>(thr, cp);
+}
+
+bool of_LOAD_CMPIU_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused3_<of_LOAD_VEC, of_CMPIU, of_JMP0XZ>(thr, cp);
+}
+
+bool of_LOAD_VP0_SET_VEC(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_LOAD_VP0, of_SET_VEC>(thr, cp);
+}
+
+bool of_LOAD_VP0_S_SET_VEC(vthread_t thr, vvp_code_t cp)
+{
+      return of_fused2_<of_LOAD_VP0_S, of_SET_VEC>(thr, cp);
+}
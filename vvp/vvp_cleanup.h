@@ -33,6 +33,7 @@ extern void vpi_mcd_delete(void);
 extern void load_module_delete(void);
 extern void modpath_delete(void);
 extern void root_table_delete(void);
+extern void schedule_delete(void);
 extern void signal_pool_delete(void);
 extern void simulator_cb_delete(void);
 extern void udp_defns_delete(void);
@@ -40,6 +41,7 @@ extern void vpi_handle_delete(void);
 extern void vpi_stack_delete(void);
 extern void vvp_net_pool_delete(void);
 extern void ufunc_pool_delete(void);
+extern void vthread_scratch_delete(void);
 
 extern void A_delete(class __vpiHandle *item);
 extern void APV_delete(class __vpiHandle *item);
@@ -52,6 +52,9 @@ static vvp_net_t **vvp_net_pool = NULL;
 static unsigned vvp_net_pool_count = 0;
 #endif
 static size_t vvp_net_alloc_remaining = 0;
+  // The chunks are listed so that all the nets can be visited.
+static vvp_net_t**vvp_net_chunk_table = NULL;
+static unsigned vvp_net_chunk_count = 0;
 // For statistics, count the vvp_nets allocated and the bytes of alloc
 // chunks allocated.
 unsigned long count_vvp_nets = 0;
@@ -64,6 +67,10 @@ void* vvp_net_t::operator new (size_t size)
 	    vvp_net_alloc_table = ::new vvp_net_t[VVP_NET_CHUNK];
 	    vvp_net_alloc_remaining = VVP_NET_CHUNK;
 	    size_vvp_nets += size*VVP_NET_CHUNK;
+	    vvp_net_chunk_count += 1;
+	    vvp_net_chunk_table = (vvp_net_t**) realloc(vvp_net_chunk_table,
+				  vvp_net_chunk_count*sizeof(vvp_net_t*));
+	    vvp_net_chunk_table[vvp_net_chunk_count-1] = vvp_net_alloc_table;
 #ifdef CHECK_WITH_VALGRIND
 	    VALGRIND_MAKE_MEM_NOACCESS(vvp_net_alloc_table, size*VVP_NET_CHUNK);
 	    VALGRIND_CREATE_MEMPOOL(vvp_net_alloc_table, 0, 0);
@@ -86,6 +93,17 @@ void* vvp_net_t::operator new (size_t size)
       return return_this;
 }
 
+size_t vvp_net_t::net_count(void)
+{
+      return vvp_net_chunk_count*VVP_NET_CHUNK - vvp_net_alloc_remaining;
+}
+
+vvp_net_t* vvp_net_t::net_at(size_t idx)
+{
+      assert(idx < net_count());
+      return vvp_net_chunk_table[idx/VVP_NET_CHUNK] + idx%VVP_NET_CHUNK;
+}
+
 #ifdef CHECK_WITH_VALGRIND
 static map<vvp_net_t*, bool> vvp_net_map;
 static map<sfunc_core*, bool> sfunc_map;
@@ -128,6 +146,8 @@ void vvp_net_pool_delete()
 {
       unsigned long vvp_nets_del = 0;
 
+      vvp_net_t::delete_fanouts();
+
       for (unsigned idx = 0; idx < local_net_pool_count; idx += 1) {
 	    vvp_net_delete(local_net_pool[idx]);
       }
@@ -174,6 +194,9 @@ void vvp_net_pool_delete()
       free(vvp_net_pool);
       vvp_net_pool = NULL;
       vvp_net_pool_count = 0;
+      free(vvp_net_chunk_table);
+      vvp_net_chunk_table = NULL;
+      vvp_net_chunk_count = 0;
 }
 #endif
 
@@ -185,8 +208,10 @@ void vvp_net_t::operator delete(void*)
 vvp_net_t::vvp_net_t()
 {
       out_ = vvp_net_ptr_t(0,0);
+      fanout_ = 0;
       fun = 0;
       fil = 0;
+      region_ = NO_REGION;
 }
 
 void vvp_net_t::link(vvp_net_ptr_t port_to_link)
@@ -194,6 +219,8 @@ void vvp_net_t::link(vvp_net_ptr_t port_to_link)
       vvp_net_t*net = port_to_link.ptr();
       net->port[port_to_link.port()] = out_;
       out_ = port_to_link;
+      if (fanout_) flatten_fanout_();
+      schedule_link_regions(this, net);
 }
 
 /*
@@ -228,7 +255,97 @@ void vvp_net_t::unlink(vvp_net_ptr_t dst_ptr)
       }
 
       net->port[net_port] = vvp_net_ptr_t(0,0);
+      if (fanout_) flatten_fanout_();
+}
+
+/*
+ * Nets with fewer receivers than this keep using the fan-out chain;
+ * the array would not make them any faster.
+ */
+static const unsigned VVP_FANOUT_FLATTEN_MIN = 4;
+
+vvp_fanout_s*vvp_fanout_retired = 0;
+unsigned long count_flat_fanouts = 0;
+
+void vvp_fanout_release(void)
+{
+      while (vvp_fanout_retired) {
+	    vvp_fanout_s*tmp = vvp_fanout_retired->retired;
+	    free(vvp_fanout_retired);
+	    vvp_fanout_retired = tmp;
+      }
+}
+
+/*
+ * (Re)make the fan-out array of this net from the fan-out chain. The
+ * chain is the master copy, so this is also how the array is brought
+ * up to date after a link or unlink.
+ */
+void vvp_net_t::flatten_fanout_(void)
+{
+      unsigned count = 0;
+      for (vvp_net_ptr_t cur = out_ ; ! cur.nil()
+		 ; cur = cur.ptr()->port[cur.port()]) {
+	    if (cur.ptr()->fun)
+		  count += 1;
+      }
+
+      if (fanout_) {
+	    fanout_->retired = vvp_fanout_retired;
+	    vvp_fanout_retired = fanout_;
+	    fanout_ = 0;
+	    count_flat_fanouts -= 1;
+      }
+
+      if (count >= VVP_FANOUT_FLATTEN_MIN) {
+	    vvp_fanout_s*fo = (vvp_fanout_s*)
+		  malloc(sizeof(vvp_fanout_s) + (count-1)*sizeof fo->item[0]);
+	    fo->retired = 0;
+	    fo->count = 0;
+	    for (vvp_net_ptr_t cur = out_ ; ! cur.nil()
+		       ; cur = cur.ptr()->port[cur.port()]) {
+		  if (cur.ptr()->fun == 0)
+			continue;
+		  fo->item[fo->count].fun = cur.ptr()->fun;
+		  fo->item[fo->count].port = cur;
+		  fo->count += 1;
+	    }
+	    fanout_ = fo;
+	    count_flat_fanouts += 1;
+      }
+}
+
+void vvp_net_t::flatten_fanouts(void)
+{
+      for (unsigned idx = 0 ; idx < vvp_net_chunk_count ; idx += 1) {
+	    vvp_net_t*chunk = vvp_net_chunk_table[idx];
+	    size_t used = VVP_NET_CHUNK;
+	    if (idx+1 == vvp_net_chunk_count)
+		  used -= vvp_net_alloc_remaining;
+
+	    for (size_t cnt = 0 ; cnt < used ; cnt += 1)
+		  chunk[cnt].flatten_fanout_();
+      }
+      vvp_fanout_release();
+}
+
+#ifdef CHECK_WITH_VALGRIND
+void vvp_net_t::delete_fanouts(void)
+{
+      for (unsigned idx = 0 ; idx < vvp_net_chunk_count ; idx += 1) {
+	    vvp_net_t*chunk = vvp_net_chunk_table[idx];
+	    size_t used = VVP_NET_CHUNK;
+	    if (idx+1 == vvp_net_chunk_count)
+		  used -= vvp_net_alloc_remaining;
+
+	    for (size_t cnt = 0 ; cnt < used ; cnt += 1) {
+		  free(chunk[cnt].fanout_);
+		  chunk[cnt].fanout_ = 0;
+	    }
+      }
+      vvp_fanout_release();
 }
+#endif
 
 void vvp_net_t::count_drivers(unsigned idx, unsigned counts[4])
 {
@@ -563,6 +680,12 @@ const vvp_vector4_t vvp_vector4_t::nil;
 
 void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
 {
+	/* If this vector is larger then that, some of my own bits
+	   survive the copy, so I stay 2-state only if both are. */
+      if (size_ <= that.size_)
+	    two_state_ = that.two_state_;
+      else
+	    two_state_ = two_state_ && that.two_state_;
 
       if (size_ == that.size_) {
 	    if (size_ > BITS_PER_WORD) {
@@ -646,6 +769,7 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
 void vvp_vector4_t::copy_from_(const vvp_vector4_t&that)
 {
       size_ = that.size_;
+      two_state_ = that.two_state_;
       if (size_ > BITS_PER_WORD) {
 	    unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
 	    abits_ptr_ = new unsigned long[2*words];
@@ -670,6 +794,7 @@ void vvp_vector4_t::copy_from_(const vvp_vector4_t&that)
 void vvp_vector4_t::copy_inverted_from_(const vvp_vector4_t&that)
 {
       size_ = that.size_;
+      two_state_ = that.two_state_;
       if (size_ > BITS_PER_WORD) {
 	    unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
 	    abits_ptr_ = new unsigned long[2*words];
@@ -700,6 +825,7 @@ void vvp_vector4_t::copy_inverted_from_(const vvp_vector4_t&that)
 /* Make sure to set size_ before calling this routine. */
 void vvp_vector4_t::allocate_words_(unsigned long inita, unsigned long initb)
 {
+      two_state_ = initb == 0;
       if (size_ > BITS_PER_WORD) {
 	    unsigned cnt = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
 	    abits_ptr_ = new unsigned long[2*cnt];
@@ -883,6 +1009,7 @@ vvp_vector4_t::vvp_vector4_t(const vvp_vector4_t&that,
 	    bbits_val_ = (that.bbits_val_ & mask) >> adr;
       }
 
+      two_state_ = that.two_state_;
 }
 
 /*
@@ -894,6 +1021,10 @@ void vvp_vector4_t::resize(unsigned newsize)
       if (size_ == newsize)
 	    return;
 
+	/* The new bits are not initialized to 0 or 1. */
+      if (newsize > size_)
+	    two_state_ = false;
+
       unsigned cnt = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
 
       if (newsize > BITS_PER_WORD) {
@@ -953,6 +1084,18 @@ unsigned long* vvp_vector4_t::subarray(unsigned adr, unsigned wid) const
       unsigned awid = (wid + BIT2_PER_WORD - 1) / (BIT2_PER_WORD);
       unsigned long*val = new unsigned long[awid];
 
+      if (subarray(val, adr, wid))
+	    return val;
+
+      delete[]val;
+      return 0;
+}
+
+bool vvp_vector4_t::subarray(unsigned long*val, unsigned adr, unsigned wid) const
+{
+      const unsigned BIT2_PER_WORD = 8*sizeof(unsigned long);
+      unsigned awid = (wid + BIT2_PER_WORD - 1) / (BIT2_PER_WORD);
+
       for (unsigned idx = 0 ;  idx < awid ;  idx += 1)
 	    val[idx] = 0;
 
@@ -968,7 +1111,7 @@ unsigned long* vvp_vector4_t::subarray(unsigned adr, unsigned wid) const
 		  atmp &= (1UL << wid) - 1;
 		  btmp &= (1UL << wid) - 1;
 	    }
-	    if (btmp) goto x_out;
+	    if (btmp) return false;
 
 	    val[0] = atmp;
 
@@ -995,7 +1138,7 @@ unsigned long* vvp_vector4_t::subarray(unsigned adr, unsigned wid) const
 			atmp &= (1UL << trans) - 1;
 			btmp &= (1UL << trans) - 1;
 		  }
-		  if (btmp) goto x_out;
+		  if (btmp) return false;
 
 		  val[val_ptr] |= atmp << val_off;
 		  adr += trans;
@@ -1008,17 +1151,18 @@ unsigned long* vvp_vector4_t::subarray(unsigned adr, unsigned wid) const
 	    }
       }
 
-      return val;
-
- x_out:
-      delete[]val;
-      return 0;
+      return true;
 }
 
 void vvp_vector4_t::setarray(unsigned adr, unsigned wid, const unsigned long*val)
 {
       assert(adr+wid <= size_);
 
+	/* The written bits are all 2-state, so if they replace the
+	   entire vector then the vector is now 2-state. */
+      if (adr == 0 && wid == size_)
+	    two_state_ = true;
+
       const unsigned BIT2_PER_WORD = 8*sizeof(unsigned long);
 
       if (size_ <= BITS_PER_WORD) {
@@ -1091,6 +1235,16 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
       assert(adr+that.size_  <= size_);
       bool diff_flag = false;
 
+	/* If both vectors are known to be 2-state, then all the
+	   bbits involved are 0 and there is no need to look at
+	   them. Otherwise, this vector becomes 2-state only if that
+	   vector is 2-state and replaces all of my bits. */
+      const bool skip_bbits = two_state_ && that.two_state_;
+      if (adr == 0 && that.size_ == size_)
+	    two_state_ = that.two_state_;
+      else if (! that.two_state_)
+	    two_state_ = false;
+
       if (size_ <= BITS_PER_WORD) {
 
 	      /* The destination vector (me!) is within a bits_val_
@@ -1115,10 +1269,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 		  diff_flag = true;
 		  abits_val_ = (abits_val_ & ~mask) | tmp;
 	    }
-	    tmp = (that.bbits_val_<<adr) & mask;
-	    if ((bbits_val_&mask) != tmp) {
-		  diff_flag = true;
-		  bbits_val_ = (bbits_val_ & ~mask) | tmp;
+	    if (! skip_bbits) {
+		  tmp = (that.bbits_val_<<adr) & mask;
+		  if ((bbits_val_&mask) != tmp) {
+			diff_flag = true;
+			bbits_val_ = (bbits_val_ & ~mask) | tmp;
+		  }
 	    }
 
       } else if (that.size_ <= BITS_PER_WORD) {
@@ -1146,10 +1302,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 		  diff_flag = true;
 		  abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 	    }
-	    tmp = (that.bbits_val_ << doff) & mask;
-	    if ((bbits_ptr_[dptr] & mask) != tmp) {
-		  diff_flag = true;
-		  bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+	    if (! skip_bbits) {
+		  tmp = (that.bbits_val_ << doff) & mask;
+		  if ((bbits_ptr_[dptr] & mask) != tmp) {
+			diff_flag = true;
+			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+		  }
 	    }
 
 	    if ((doff + that.size_) > BITS_PER_WORD) {
@@ -1162,10 +1320,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 			diff_flag = true;
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 		  }
-		  tmp = (that.bbits_val_ >> (that.size_-tail)) & mask;
-		  if ((bbits_ptr_[dptr] & mask) != tmp) {
-			diff_flag = true;
-			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+		  if (! skip_bbits) {
+			tmp = (that.bbits_val_ >> (that.size_-tail)) & mask;
+			if ((bbits_ptr_[dptr] & mask) != tmp) {
+			      diff_flag = true;
+			      bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+			}
 		  }
 	    }
 
@@ -1183,7 +1343,7 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 			diff_flag = true;
 			abits_ptr_[dptr] = that.abits_ptr_[sptr];
 		  }
-		  if (bbits_ptr_[dptr] != that.bbits_ptr_[sptr]) {
+		  if (! skip_bbits && bbits_ptr_[dptr] != that.bbits_ptr_[sptr]) {
 			diff_flag = true;
 			bbits_ptr_[dptr] = that.bbits_ptr_[sptr];
 		  }
@@ -1201,10 +1361,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 			diff_flag = true;
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 		  }
-		  tmp = that.bbits_ptr_[sptr] & mask;
-		  if ((bbits_ptr_[dptr] & mask) != tmp) {
-			diff_flag = true;
-			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+		  if (! skip_bbits) {
+			tmp = that.bbits_ptr_[sptr] & mask;
+			if ((bbits_ptr_[dptr] & mask) != tmp) {
+			      diff_flag = true;
+			      bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+			}
 		  }
 	    }
 
@@ -1227,10 +1389,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 			diff_flag = true;
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & lmask) | tmp;
 		  }
-		  tmp = (that.bbits_ptr_[sptr] << doff) & ~lmask;
-		  if ((bbits_ptr_[dptr] & ~lmask) != tmp) {
-			diff_flag = true;
-			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & lmask) | tmp;
+		  if (! skip_bbits) {
+			tmp = (that.bbits_ptr_[sptr] << doff) & ~lmask;
+			if ((bbits_ptr_[dptr] & ~lmask) != tmp) {
+			      diff_flag = true;
+			      bbits_ptr_[dptr] = (bbits_ptr_[dptr] & lmask) | tmp;
+			}
 		  }
 		  dptr += 1;
 
@@ -1239,10 +1403,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 			diff_flag = true;
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & ~lmask) | tmp;
 		  }
-		  tmp = (that.bbits_ptr_[sptr] >> ndoff) & lmask;
-		  if ((bbits_ptr_[dptr] & lmask) != tmp) {
-			diff_flag = true;
-			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~lmask) | tmp;
+		  if (! skip_bbits) {
+			tmp = (that.bbits_ptr_[sptr] >> ndoff) & lmask;
+			if ((bbits_ptr_[dptr] & lmask) != tmp) {
+			      diff_flag = true;
+			      bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~lmask) | tmp;
+			}
 		  }
 
 		  remain -= BITS_PER_WORD;
@@ -1265,10 +1431,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 			diff_flag = true;
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 		  }
-		  tmp = (that.bbits_ptr_[sptr] << doff) & mask;
-		  if ((bbits_ptr_[dptr] & mask) != tmp) {
-			diff_flag = true;
-			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+		  if (! skip_bbits) {
+			tmp = (that.bbits_ptr_[sptr] << doff) & mask;
+			if ((bbits_ptr_[dptr] & mask) != tmp) {
+			      diff_flag = true;
+			      bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+			}
 		  }
 
 		  if ((doff + remain) > BITS_PER_WORD) {
@@ -1285,10 +1453,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 			      diff_flag = true;
 			      abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 			}
-			tmp = (that.bbits_ptr_[sptr] >> (remain-tail))&mask;
-			if ((bbits_ptr_[dptr] & mask) != tmp) {
-			      diff_flag = true;
-			      bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+			if (! skip_bbits) {
+			      tmp = (that.bbits_ptr_[sptr] >> (remain-tail))&mask;
+			      if ((bbits_ptr_[dptr] & mask) != tmp) {
+				    diff_flag = true;
+				    bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
+			      }
 			}
 		  }
 	    }
@@ -1375,6 +1545,9 @@ bool vvp_vector4_t::eeq(const vvp_vector4_t&that) const
       if (size_ != that.size_)
 	    return false;
 
+      if (two_state_ && that.two_state_)
+	    return eeq_abits_(that);
+
       if (size_ < BITS_PER_WORD) {
 	    unsigned long mask = (1UL << size_) - 1;
 	    return (abits_val_&mask) == (that.abits_val_&mask)
@@ -1409,6 +1582,9 @@ bool vvp_vector4_t::eq_xz(const vvp_vector4_t&that) const
       if (size_ != that.size_)
 	    return false;
 
+      if (two_state_ && that.two_state_)
+	    return eeq_abits_(that);
+
       if (size_ < BITS_PER_WORD) {
 	    unsigned long mask = (1UL << size_) - 1;
 	    return ((abits_val_|bbits_val_)&mask) == ((that.abits_val_|that.bbits_val_)&mask)
@@ -1438,8 +1614,42 @@ bool vvp_vector4_t::eq_xz(const vvp_vector4_t&that) const
       return true;
 }
 
+/*
+ * Compare only the abits of two vectors of the same size. This is
+ * the same as eeq if both vectors are known to be 2-state.
+ */
+bool vvp_vector4_t::eeq_abits_(const vvp_vector4_t&that) const
+{
+      assert(size_ == that.size_);
+
+      if (size_ < BITS_PER_WORD) {
+	    unsigned long mask = (1UL << size_) - 1;
+	    return (abits_val_&mask) == (that.abits_val_&mask);
+      }
+
+      if (size_ == BITS_PER_WORD)
+	    return abits_val_ == that.abits_val_;
+
+      unsigned words = size_ / BITS_PER_WORD;
+      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
+	    if (abits_ptr_[idx] != that.abits_ptr_[idx])
+		  return false;
+      }
+
+      unsigned long mask = size_%BITS_PER_WORD;
+      if (mask > 0) {
+	    mask = (1UL << mask) - 1;
+	    return (abits_ptr_[words]&mask) == (that.abits_ptr_[words]&mask);
+      }
+
+      return true;
+}
+
 bool vvp_vector4_t::has_xz() const
 {
+      if (two_state_)
+	    return false;
+
       if (size_ < BITS_PER_WORD) {
 	    unsigned long mask = -1UL >> (BITS_PER_WORD - size_);
 	    return bbits_val_&mask;
@@ -1483,6 +1693,7 @@ void vvp_vector4_t::change_z2x()
 
 void vvp_vector4_t::set_to_x()
 {
+      two_state_ = false;
       if (size_ <= BITS_PER_WORD) {
 	    abits_val_ = vvp_vector4_t::WORD_X_ABITS;
             bbits_val_ = vvp_vector4_t::WORD_X_BBITS;
@@ -1556,6 +1767,20 @@ vvp_vector4_t& vvp_vector4_t::operator &= (const vvp_vector4_t&that)
 	//  01 00 01 11 11
 	//  11 00 11 11 11
 	//  10 00 11 11 11
+	// If both vectors are 2-state, then this is a simple AND of
+	// the abits.
+      if (two_state_ && that.two_state_) {
+	    if (size_ <= BITS_PER_WORD) {
+		  abits_val_ &= that.abits_val_;
+	    } else {
+		  unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+		  for (unsigned idx = 0; idx < words ; idx += 1)
+			abits_ptr_[idx] &= that.abits_ptr_[idx];
+	    }
+	    return *this;
+      }
+
+      two_state_ = false;
       if (size_ <= BITS_PER_WORD) {
 	    unsigned long tmp1 = abits_val_ | bbits_val_;
 	    unsigned long tmp2 = that.abits_val_ | that.bbits_val_;
@@ -1584,6 +1809,20 @@ vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
 	//  01 01 01 01 01
 	//  11 11 01 11 11
 	//  10 11 01 11 11
+	// If both vectors are 2-state, then this is a simple OR of
+	// the abits.
+      if (two_state_ && that.two_state_) {
+	    if (size_ <= BITS_PER_WORD) {
+		  abits_val_ |= that.abits_val_;
+	    } else {
+		  unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+		  for (unsigned idx = 0; idx < words ; idx += 1)
+			abits_ptr_[idx] |= that.abits_ptr_[idx];
+	    }
+	    return *this;
+      }
+
+      two_state_ = false;
       if (size_ <= BITS_PER_WORD) {
 	    unsigned long tmp = abits_val_ | bbits_val_ |
 	                        that.abits_val_ | that.bbits_val_;
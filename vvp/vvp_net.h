@@ -27,6 +27,7 @@
 # include  <cstddef>
 # include  <cstdlib>
 # include  <cstring>
+# include  <climits>
 # include  <new>
 # include  <cassert>
 
@@ -251,6 +252,11 @@ class vvp_vector4_t {
 	// array of longs, or a nil pointer if an XZ bit was detected
 	// in the array.
       unsigned long*subarray(unsigned idx, unsigned size) const;
+	// Same as above, but write the bits into the caller supplied
+	// array, which must have room for (size+BITS_PER_WORD-1)/
+	// BITS_PER_WORD words. Return false if an XZ bit was detected,
+	// in which case the contents of the array are undefined.
+      bool subarray(unsigned long*val, unsigned idx, unsigned size) const;
       void setarray(unsigned idx, unsigned size, const unsigned long*val);
 
 	// Set a 4-value bit or subvector into the vector. Return true
@@ -317,6 +323,9 @@ class vvp_vector4_t {
 
       void allocate_words_(unsigned long inita, unsigned long initb);
 
+	// Compare only the abits of the vectors.
+      bool eeq_abits_(const vvp_vector4_t&that) const;
+
 	// Values in the vvp_vector4_t are stored split across two
 	// arrays. For each bit in the vector, there is an abit and a
 	// bbit. the encoding of a vvp_vector4_t is:
@@ -329,6 +338,12 @@ class vvp_vector4_t {
 	// BIT4_Z    0    1
 
       unsigned size_;
+	// If this flag is true, the vector is known to contain no X
+	// or Z bits, so all the bbits within the vector are 0 and
+	// operations can skip the bbits entirely. If false, the
+	// vector may or may not contain X or Z bits. Operations that
+	// may introduce X or Z bits must clear this flag.
+      bool two_state_;
       union {
 	    unsigned long abits_val_;
 	    unsigned long*abits_ptr_;
@@ -437,6 +452,9 @@ inline void vvp_vector4_t::set_bit(unsigned idx, vvp_bit4_t val)
       unsigned long off = idx % BITS_PER_WORD;
       unsigned long mask = 1UL << off;
 
+      if (val == BIT4_X || val == BIT4_Z)
+	    two_state_ = false;
+
       if (size_ > BITS_PER_WORD) {
 	    unsigned wdx = idx / BITS_PER_WORD;
 	    switch (val) {
@@ -1062,7 +1080,25 @@ template <class T> ostream& operator << (ostream&out, vvp_sub_pointer_t<T> val)
  * all the fan-out chain, delivering the specified value. The send_*()
  * methods of the vvp_net_t class are similar, but they follow the
  * output, possibly filtered, from the vvp_net_t.
+ *
+ * Following the chain means touching every receiving vvp_net_t to
+ * find the next, which is slow for nets (i.e. clocks and resets) with
+ * thousands of receivers. So when compilation is done, the fan-out of
+ * each net with more than a few receivers is also copied into a
+ * vvp_fanout_s array of the receiving functors and ports, and the
+ * send_vec4 methods use that array instead. The array keeps the order
+ * of the chain, so values are delivered in the same order either
+ * way. Linking or unlinking a port remakes the array.
  */
+struct vvp_fanout_s {
+      struct vvp_fanout_s*retired;
+      unsigned count;
+      struct {
+	    class vvp_net_fun_t*fun;
+	    vvp_net_ptr_t port;
+      } item[1];
+};
+
 class vvp_net_t {
     public:
       vvp_net_t();
@@ -1108,8 +1144,38 @@ class vvp_net_t {
     public: // Method to support $countdrivers
       void count_drivers(unsigned idx, unsigned counts[4]);
 
+    public: // Head of the fan-out list, for graph analysis at compile time.
+      vvp_net_ptr_t fanout() const { return out_; }
+
+	// The nets are allocated in chunks, so they can be visited
+	// in allocation order as net_at(0) to net_at(net_count()-1).
+      static size_t net_count(void);
+      static vvp_net_t* net_at(size_t idx);
+
+	// The net region that the events of this net are confined
+	// to, as set by compile_net_regions. Nets that were created
+	// after that are in no region (NO_REGION).
+      static const unsigned NO_REGION = UINT_MAX;
+      unsigned region() const { return region_; }
+      void region(unsigned id) { region_ = id; }
+
+	// Make the fan-out arrays of all the nets that have enough
+	// receivers to benefit. This is done when compilation is done.
+      static void flatten_fanouts(void);
+#ifdef CHECK_WITH_VALGRIND
+      static void delete_fanouts(void);
+#endif
+
     private:
       vvp_net_ptr_t out_;
+      vvp_fanout_s*fanout_;
+      unsigned region_;
+
+      void flatten_fanout_(void);
+      void send_vec4_fanout_(const vvp_vector4_t&val, vvp_context_t context);
+      void send_vec4_pv_fanout_(const vvp_vector4_t&val,
+				unsigned base, unsigned wid, unsigned vwid,
+				vvp_context_t context);
 
     public: // Need a better new for these objects.
       static void* operator new(std::size_t size);
@@ -1477,6 +1543,9 @@ class vvp_wide_fun_core : public vvp_net_fun_t {
     public:
       vvp_wide_fun_core(vvp_net_t*net, unsigned nports);
       virtual ~vvp_wide_fun_core();
+
+	// The net whose output this core drives.
+      vvp_net_t* net() const { return ptr_; }
 	// These objects are not perm allocated.
       void* operator new(std::size_t size) { return ::new char[size]; }
       void operator delete(void* ptr) { ::delete[]((char*)ptr); }
@@ -1525,6 +1594,9 @@ class vvp_wide_fun_t : public vvp_net_fun_t {
       void recv_real(vvp_net_ptr_t port, double bit,
                      vvp_context_t context);
 
+	// The core that this input functor feeds.
+      vvp_wide_fun_core* core() const { return core_; }
+
     private:
       vvp_wide_fun_core*core_;
       unsigned port_base_;
@@ -1620,10 +1692,47 @@ inline void vvp_send_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&val,
       }
 }
 
+/*
+ * A fan-out array that is replaced while a value may be being sent
+ * through it is retired instead of deleted. The scheduler deletes the
+ * retired arrays between events, when no send is in progress.
+ */
+extern vvp_fanout_s*vvp_fanout_retired;
+extern void vvp_fanout_release(void);
+
+inline void vvp_net_t::send_vec4_fanout_(const vvp_vector4_t&val,
+					 vvp_context_t context)
+{
+      if (fanout_ == 0) {
+	    vvp_send_vec4(out_, val, context);
+	    return;
+      }
+
+      const vvp_fanout_s*fo = fanout_;
+      for (unsigned idx = 0 ; idx < fo->count ; idx += 1)
+	    fo->item[idx].fun->recv_vec4(fo->item[idx].port, val, context);
+}
+
+inline void vvp_net_t::send_vec4_pv_fanout_(const vvp_vector4_t&val,
+					    unsigned base, unsigned wid,
+					    unsigned vwid,
+					    vvp_context_t context)
+{
+      if (fanout_ == 0) {
+	    vvp_send_vec4_pv(out_, val, base, wid, vwid, context);
+	    return;
+      }
+
+      const vvp_fanout_s*fo = fanout_;
+      for (unsigned idx = 0 ; idx < fo->count ; idx += 1)
+	    fo->item[idx].fun->recv_vec4_pv(fo->item[idx].port, val,
+					    base, wid, vwid, context);
+}
+
 inline void vvp_net_t::send_vec4(const vvp_vector4_t&val, vvp_context_t context)
 {
       if (fil == 0) {
-	    vvp_send_vec4(out_, val, context);
+	    send_vec4_fanout_(val, context);
 	    return;
       }
 
@@ -1632,10 +1741,10 @@ inline void vvp_net_t::send_vec4(const vvp_vector4_t&val, vvp_context_t context)
 	  case vvp_net_fil_t::STOP:
 	    break;
 	  case vvp_net_fil_t::PROP:
-	    vvp_send_vec4(out_, val, context);
+	    send_vec4_fanout_(val, context);
 	    break;
 	  case vvp_net_fil_t::REPL:
-	    vvp_send_vec4(out_, rep, context);
+	    send_vec4_fanout_(rep, context);
 	    break;
       }
 }
@@ -1645,7 +1754,7 @@ inline void vvp_net_t::send_vec4_pv(const vvp_vector4_t&val,
 				    vvp_context_t context)
 {
       if (fil == 0) {
-	    vvp_send_vec4_pv(out_, val, base, wid, vwid, context);
+	    send_vec4_pv_fanout_(val, base, wid, vwid, context);
 	    return;
       }
 
@@ -1655,10 +1764,10 @@ inline void vvp_net_t::send_vec4_pv(const vvp_vector4_t&val,
 	  case vvp_net_fil_t::STOP:
 	    break;
 	  case vvp_net_fil_t::PROP:
-	    vvp_send_vec4_pv(out_, val, base, wid, vwid, context);
+	    send_vec4_pv_fanout_(val, base, wid, vwid, context);
 	    break;
 	  case vvp_net_fil_t::REPL:
-	    vvp_send_vec4_pv(out_, rep, base, wid, vwid, context);
+	    send_vec4_pv_fanout_(rep, base, wid, vwid, context);
 	    break;
       }
 }
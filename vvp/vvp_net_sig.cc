@@ -1054,6 +1054,193 @@ bool vvp_wire_vec4::is_forced(unsigned idx) const
       return test_force_mask(idx);
 }
 
+vvp_wire_vec4_word::vvp_wire_vec4_word(vvp_vector4array_t*store, unsigned word)
+: store_(store), word_(word)
+{
+      assert(word_ < store_->words());
+      store_->set_word(word_, vvp_vector4_t(store_->width(), BIT4_Z));
+      needs_init_ = true;
+      force4_ptr_ = 0;
+}
+
+const vvp_vector4_t& vvp_wire_vec4_word::force_value_() const
+{
+      return force4_ptr_? *force4_ptr_ : vvp_vector4_t::nil;
+}
+
+vvp_net_fil_t::prop_t vvp_wire_vec4_word::filter_vec4(const vvp_vector4_t&bit,
+						      vvp_vector4_t&rep,
+						      unsigned base, unsigned vwid)
+{
+      vvp_vector4_t bits4 = store_->get_word(word_);
+
+	// Special case! See vvp_wire_vec4::filter_vec4.
+      if (base==0 && vwid==0) {
+	    vvp_vector4_t tmp (bits4.size(), BIT4_X);
+	    if (bits4 .eeq(tmp) && !needs_init_) return STOP;
+	    store_->set_word(word_, tmp);
+	    needs_init_ = false;
+	    return filter_mask_(tmp, force_value_(), rep, 0);
+      }
+
+      assert(bits4.size() == vwid);
+
+	// Keep track of the value being driven from this net, even if
+	// it is not ultimately what survives the force filter.
+      if (base==0 && bit.size()==vwid) {
+	    if (bits4 .eeq( bit ) && !needs_init_) return STOP;
+	    store_->set_word(word_, bit);
+      } else {
+	    bool rc = bits4.set_vec(base, bit);
+	    if (rc == false && !needs_init_) return STOP;
+	    store_->set_word(word_, bits4);
+      }
+
+      needs_init_ = false;
+      return filter_mask_(bit, force_value_(), rep, base);
+}
+
+vvp_net_fil_t::prop_t vvp_wire_vec4_word::filter_vec8(const vvp_vector8_t&bit,
+						      vvp_vector8_t&rep,
+						      unsigned base,
+						      unsigned vwid)
+{
+      vvp_vector4_t bits4 = store_->get_word(word_);
+      assert(bits4.size() == vwid);
+
+	// Keep track of the value being driven from this net, even if
+	// it is not ultimately what survives the force filter.
+      vvp_vector4_t bit4 (reduce4(bit));
+      if (base==0 && bit4.size()==vwid) {
+	    if (bits4 .eeq( bit4 ) && !needs_init_) return STOP;
+	    store_->set_word(word_, bit4);
+      } else {
+	    bool rc = bits4.set_vec(base, bit4);
+	    if (rc == false && !needs_init_) return STOP;
+	    store_->set_word(word_, bits4);
+      }
+
+      needs_init_ = false;
+      return filter_mask_(bit, vvp_vector8_t(force_value_(),6,6), rep, base);
+}
+
+unsigned vvp_wire_vec4_word::filter_size() const
+{
+      return store_->width();
+}
+
+void vvp_wire_vec4_word::force_fil_vec4(const vvp_vector4_t&val, vvp_vector2_t mask)
+{
+      force_mask(mask);
+
+      if (force4_ptr_ == 0) {
+	    force4_ptr_ = new vvp_vector4_t(val);
+      } else {
+	    for (unsigned idx = 0; idx < mask.size() ; idx += 1) {
+		  if (mask.value(idx) == 0)
+			continue;
+
+		  force4_ptr_->set_bit(idx, val.value(idx));
+	    }
+      }
+      run_vpi_callbacks();
+}
+
+void vvp_wire_vec4_word::force_fil_vec8(const vvp_vector8_t&, vvp_vector2_t)
+{
+      assert(0);
+}
+
+void vvp_wire_vec4_word::force_fil_real(double, vvp_vector2_t)
+{
+      assert(0);
+}
+
+void vvp_wire_vec4_word::release(vvp_net_ptr_t ptr, bool net_flag)
+{
+      vvp_vector4_t bits4 = store_->get_word(word_);
+      vvp_vector2_t mask (vvp_vector2_t::FILL1, bits4.size());
+      if (net_flag) {
+	      // Wires revert to their unforced value after release.
+            release_mask(mask);
+	    needs_init_ = ! force_value_() .eeq(bits4);
+	    ptr.ptr()->send_vec4(bits4, 0);
+	    run_vpi_callbacks();
+      } else {
+	      // Variables keep the current value.
+	    vvp_vector4_t res (bits4.size());
+	    for (unsigned idx=0; idx<bits4.size(); idx += 1)
+		  res.set_bit(idx,value(idx));
+            release_mask(mask);
+	    ptr.ptr()->fun->recv_vec4(ptr, res, 0);
+      }
+}
+
+void vvp_wire_vec4_word::release_pv(vvp_net_ptr_t ptr, unsigned base, unsigned wid, bool net_flag)
+{
+      vvp_vector4_t bits4 = store_->get_word(word_);
+      assert(bits4.size() >= base + wid);
+
+      vvp_vector2_t mask (vvp_vector2_t::FILL0, bits4.size());
+      for (unsigned idx = 0 ; idx < wid ; idx += 1)
+	    mask.set_bit(base+idx, 1);
+
+      if (net_flag) {
+	      // Wires revert to their unforced value after release.
+	    release_mask(mask);
+	    needs_init_ = ! force_value_().subvalue(base,wid) .eeq(bits4.subvalue(base,wid));
+	    ptr.ptr()->send_vec4_pv(bits4.subvalue(base,wid),
+				    base, wid, bits4.size(), 0);
+	    run_vpi_callbacks();
+      } else {
+	      // Variables keep the current value.
+	    vvp_vector4_t res (wid);
+	    for (unsigned idx=0; idx<wid; idx += 1)
+		  res.set_bit(idx,value(base+idx));
+	    release_mask(mask);
+	    ptr.ptr()->fun->recv_vec4_pv(ptr, res, base, wid, bits4.size(), 0);
+      }
+}
+
+unsigned vvp_wire_vec4_word::value_size() const
+{
+      return store_->width();
+}
+
+vvp_bit4_t vvp_wire_vec4_word::value(unsigned idx) const
+{
+      if (test_force_mask(idx))
+	    return force4_ptr_->value(idx);
+      else
+	    return store_->get_word(word_).value(idx);
+}
+
+vvp_scalar_t vvp_wire_vec4_word::scalar_value(unsigned idx) const
+{
+      return vvp_scalar_t(value(idx),6,6);
+}
+
+void vvp_wire_vec4_word::vec4_value(vvp_vector4_t&val) const
+{
+      val = store_->get_word(word_);
+      if (test_force_mask_is_zero())
+	    return;
+
+      for (unsigned idx = 0 ; idx < val.size() ; idx += 1)
+	    if (test_force_mask(idx))
+		  val.set_bit(idx, force4_ptr_->value(idx));
+}
+
+vvp_bit4_t vvp_wire_vec4_word::driven_value(unsigned idx) const
+{
+      return store_->get_word(word_).value(idx);
+}
+
+bool vvp_wire_vec4_word::is_forced(unsigned idx) const
+{
+      return test_force_mask(idx);
+}
+
 vvp_wire_vec8::vvp_wire_vec8(unsigned wid)
 : bits8_(wid)
 {
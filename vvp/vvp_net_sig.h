@@ -460,6 +460,52 @@ class vvp_wire_vec4 : public vvp_wire_base {
       vvp_vector4_t force4_; // the value being forced
 };
 
+/*
+ * This is a vvp_wire_vec4 for a word of a net array. The words keep
+ * their driven values packed together in a vvp_vector4array_t of the
+ * array instead of a vector each, and the force value is only made
+ * if the word is forced, since few words ever are.
+ */
+class vvp_wire_vec4_word : public vvp_wire_base {
+
+    public:
+      vvp_wire_vec4_word(vvp_vector4array_t*store, unsigned word);
+
+      prop_t filter_vec4(const vvp_vector4_t&bit, vvp_vector4_t&rep,
+			 unsigned base, unsigned vwid);
+      prop_t filter_vec8(const vvp_vector8_t&val, vvp_vector8_t&rep,
+			 unsigned base, unsigned vwid);
+
+	// Abstract methods from vvp_vpi_callback
+      void get_value(struct t_vpi_value*value);
+	// Abstract methods from vvp_net_fit_t
+      unsigned filter_size() const;
+      void force_fil_vec4(const vvp_vector4_t&val, vvp_vector2_t mask);
+      void force_fil_vec8(const vvp_vector8_t&val, vvp_vector2_t mask);
+      void force_fil_real(double val, vvp_vector2_t mask);
+      void release(vvp_net_ptr_t ptr, bool net_flag);
+      void release_pv(vvp_net_ptr_t ptr, unsigned base, unsigned wid, bool net_flag);
+
+	// Implementation of vvp_signal_value methods
+      unsigned value_size() const;
+      vvp_bit4_t value(unsigned idx) const;
+      vvp_scalar_t scalar_value(unsigned idx) const;
+      void vec4_value(vvp_vector4_t&) const;
+
+	// Support for $countdrivers
+      vvp_bit4_t driven_value(unsigned idx) const;
+      bool is_forced(unsigned idx) const;
+
+    private:
+      const vvp_vector4_t&force_value_() const;
+
+    private:
+      vvp_vector4array_t*store_; // The tracked driven values
+      unsigned word_;
+      bool needs_init_;
+      vvp_vector4_t*force4_ptr_; // the value being forced, if any
+};
+
 class vvp_wire_vec8 : public vvp_wire_base {
 
     public:
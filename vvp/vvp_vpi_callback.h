@@ -39,6 +39,10 @@ class vvp_vpi_callback {
       virtual ~vvp_vpi_callback();
 
       void attach_as_word(struct __vpiArray* arr, unsigned long addr);
+	// Get the array (and the address in it) that this is a word
+	// of, or nil if it is not an array word.
+      struct __vpiArray* get_array_word(unsigned long&addr) const
+      { addr = array_word_; return array_; }
 
       void add_vpi_callback(value_callback*);
 #ifdef CHECK_WITH_VALGRIND
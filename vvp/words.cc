@@ -314,7 +314,10 @@ static void do_compile_net(vvp_net_t*node, vvp_array_t array,
 		  vsig = new vvp_wire_vec4(wid,BIT4_0);
 		  break;
 		case vpiLogicVar:
-		  vsig = new vvp_wire_vec4(wid,BIT4_Z);
+		  if (array)
+			vsig = array_net_word_filter(array, array_addr, wid);
+		  if (vsig == 0)
+			vsig = new vvp_wire_vec4(wid,BIT4_Z);
 		  break;
 		case -vpiLogicVar:
 		  vsig = new vvp_wire_vec8(wid);
@@ -325,14 +328,14 @@ static void do_compile_net(vvp_net_t*node, vvp_array_t array,
       }
 
       vpiHandle obj = 0;
-      if (! local_flag) {
+      if (! local_flag && ! array) {
 	      /* Make the vpiHandle for the reg. */
 	    obj = vpip_make_net4(name, msb, lsb, signed_flag, node);
 	      /* This attaches the label to the vpiHandle */
 	    compile_vpi_symbol(my_label, obj);
       }
 #ifdef CHECK_WITH_VALGRIND
-      else pool_local_net(node);
+      else if (local_flag) pool_local_net(node);
 #endif
 
 	// REMOVE ME! Giving the net a label is a legacy of the times
@@ -341,8 +344,11 @@ static void do_compile_net(vvp_net_t*node, vvp_array_t array,
 	// .net, then we will remove that label.
       define_functor_symbol(my_label, node);
 
+	/* The handle of a net array word is made by the array when
+	   (and if) it is asked for. */
       if (array)
-	    array_attach_word(array, array_addr, obj);
+	    array_attach_net_word(array, array_addr, node,
+				  msb, lsb, signed_flag);
       else if (obj)
 	    vpip_attach_to_scope(scope,obj);
 
@@ -457,12 +463,12 @@ static void __compile_real_net2(vvp_net_t*node, vvp_array_t array,
       }
 
       vpiHandle obj = 0;
-      if (!local_flag) {
+      if (!local_flag && !array) {
 	    obj = vpip_make_real_var(name, node);
 	    compile_vpi_symbol(my_label, obj);
       }
 #ifdef CHECK_WITH_VALGRIND
-      else pool_local_net(node);
+      else if (local_flag) pool_local_net(node);
 #endif
 
 	// REMOVE ME! Giving the net a label is a legacy of the times
@@ -472,7 +478,7 @@ static void __compile_real_net2(vvp_net_t*node, vvp_array_t array,
       define_functor_symbol(my_label, node);
 
      if (array)
-	    array_attach_word(array, array_addr, obj);
+	    array_attach_real_net_word(array, array_addr, node);
       else if (obj)
 	    vpip_attach_to_scope(scope, obj);
 